@@ -0,0 +1,398 @@
+#ifndef BVH_H
+#define BVH_H
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <numeric>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "Bounds.h"
+#include "Simd.h"
+
+// ======================================================
+// Bounding volume hierarchy over a set of boxes (binned SAH build)
+// Primitives are indices into the box array given to build(); in the
+// renderer that is EntityStore::bounds, so a primitive is an entity.
+// - build(boxes, n)      : full rebuild (scene load)
+// - refit(boxes)         : same tree, new boxes (objects moved)
+// - queryFrusta(...)     : several frusta in one traversal
+// - intersect4 / raycast : nearest hit, four rays per SSE packet
+// - trace4               : same, with the exact shape tested inside each box
+// ======================================================
+struct BvhNode {
+    Aabb bounds;
+    int first = 0;      // first entry in Bvh::prims covered by this subtree
+    int count = 0;      // entries covered (subtrees are contiguous)
+    int left = -1;      // left child, right is left + 1; -1 for leaves
+
+    bool isLeaf() const { return left < 0; }
+};
+
+struct RayHit {
+    int prim = -1;      // -1: no hit
+    float t = FLT_MAX;
+};
+
+// Four independent rays; directions need not be normalized (t is in units of dir)
+struct RayPacket4 {
+    glm::vec3 origin[4];
+    glm::vec3 dir[4];
+    float tMax[4] = { FLT_MAX, FLT_MAX, FLT_MAX, FLT_MAX };
+};
+
+class Bvh {
+public:
+    static const int kBins = 12;
+    static const int kMaxLeaf = 4;
+    static const int kMaxFrusta = 8;
+
+    std::vector<BvhNode> nodes;         // nodes[0] is the root; children come after parents
+    std::vector<int> prims;             // primitive ids in leaf order
+    std::vector<Aabb> primBounds;       // boxes in leaf order (copied so leaves stream linearly)
+
+    bool empty() const { return nodes.empty(); }
+
+    void clear() {
+        nodes.clear();
+        prims.clear();
+        primBounds.clear();
+    }
+
+    void build(const Aabb* boxes, int count) {
+        clear();
+        if (count <= 0) return;
+
+        prims.resize(count);
+        std::iota(prims.begin(), prims.end(), 0);
+        std::vector<glm::vec3> centroids(count);
+        for (int i = 0; i < count; ++i) centroids[i] = boxes[i].center();
+
+        nodes.reserve(2 * (size_t)count);
+        nodes.emplace_back();
+        nodes[0].first = 0;
+        nodes[0].count = count;
+
+        std::vector<int> stack{ 0 };
+        while (!stack.empty()) {
+            int ni = stack.back();
+            stack.pop_back();
+            int first = nodes[ni].first, n = nodes[ni].count;
+            nodes[ni].bounds = unionOf(boxes, first, n);
+            if (n <= 1) continue;
+
+            int mid = split(boxes, centroids, first, n, nodes[ni].bounds);
+            if (mid < 0) continue;  // cheaper as a leaf
+
+            int l = (int)nodes.size();
+            nodes.emplace_back();
+            nodes.emplace_back();
+            nodes[l].first = first;
+            nodes[l].count = mid - first;
+            nodes[l + 1].first = mid;
+            nodes[l + 1].count = first + n - mid;
+            nodes[ni].left = l;
+            stack.push_back(l + 1);
+            stack.push_back(l);
+        }
+
+        primBounds.resize(count);
+        for (int i = 0; i < count; ++i) primBounds[i] = boxes[prims[i]];
+    }
+
+    // Keeps the topology and recomputes bounds bottom-up. Cheap, but the tree
+    // degrades if things move far; rebuild when the layout changes.
+    void refit(const Aabb* boxes) {
+        for (size_t i = 0; i < prims.size(); ++i) primBounds[i] = boxes[prims[i]];
+        for (int ni = (int)nodes.size() - 1; ni >= 0; --ni) {
+            BvhNode& node = nodes[ni];
+            if (node.isLeaf()) {
+                node.bounds = primBounds[node.first];
+                for (int i = 1; i < node.count; ++i) node.bounds.expand(primBounds[node.first + i]);
+            }
+            else {
+                node.bounds = nodes[node.left].bounds;
+                node.bounds.expand(nodes[node.left + 1].bounds);
+            }
+        }
+    }
+
+    size_t memoryBytes() const {
+        return nodes.capacity() * sizeof(BvhNode) + prims.capacity() * sizeof(int) + primBounds.capacity() * sizeof(Aabb);
+    }
+
+    // visit(frustumIndex, prim) for every primitive whose box touches that
+    // frustum. Subtrees fully inside a frustum are emitted without further
+    // tests; planes already passed by a parent are not tested again.
+    template <class Visit>
+    void queryFrusta(const Frustum* frusta, int frustumCount, Visit&& visit) const {
+        if (nodes.empty()) return;
+        frustumCount = std::min(frustumCount, kMaxFrusta);
+
+        struct Entry {
+            int node;
+            unsigned int active;                // frusta still testing this subtree
+            unsigned int planeMask[kMaxFrusta];
+        };
+        std::vector<Entry> stack;
+        stack.reserve(64);
+        Entry root = { 0, (1u << frustumCount) - 1u, {} };
+        stack.push_back(root);
+
+        while (!stack.empty()) {
+            Entry e = stack.back();
+            stack.pop_back();
+            const BvhNode& node = nodes[e.node];
+
+            unsigned int active = 0;
+            for (int f = 0; f < frustumCount; ++f) {
+                if (!(e.active & (1u << f))) continue;
+                Frustum::Result r = frusta[f].classify(node.bounds, e.planeMask[f]);
+                if (r == Frustum::INSIDE) {
+                    for (int i = node.first; i < node.first + node.count; ++i) visit(f, prims[i]);
+                }
+                else if (r == Frustum::INTERSECTS) active |= 1u << f;
+            }
+            if (!active) continue;
+
+            if (!node.isLeaf()) {
+                e.active = active;
+                e.node = node.left + 1;
+                stack.push_back(e);
+                e.node = node.left;
+                stack.push_back(e);
+                continue;
+            }
+
+            for (int i = node.first; i < node.first + node.count; ++i) {
+                for (int f = 0; f < frustumCount; ++f) {
+                    if (!(active & (1u << f))) continue;
+                    unsigned int mask = e.planeMask[f];
+                    if (frusta[f].classify(primBounds[i], mask) != Frustum::OUTSIDE) visit(f, prims[i]);
+                }
+            }
+        }
+    }
+
+    template <class Visit>
+    void queryFrustum(const Frustum& frustum, Visit&& visit) const {
+        queryFrusta(&frustum, 1, [&](int, int prim) { visit(prim); });
+    }
+
+    // Nearest box hit per ray. accept(prim) filters candidates (e.g. only
+    // table parts); rejected boxes do not block the ray.
+    template <class Accept>
+    void intersect4(const RayPacket4& rays, RayHit hits[4], Accept&& accept) const {
+        trace4(rays, hits, [&](int prim, int, float tBox) { return accept(prim) ? tBox : FLT_MAX; });
+    }
+
+    // Nearest hit per ray where the box only bounds the real shape:
+    // hit(prim, lane, tBox) is asked for each ray entering the box before
+    // its current nearest hit, and returns the distance to the shape
+    // (FLT_MAX: missed).
+    template <class Hit>
+    void trace4(const RayPacket4& rays, RayHit hits[4], Hit&& hit) const {
+        for (int k = 0; k < 4; ++k) hits[k] = RayHit();
+        if (nodes.empty()) return;
+
+        Packet p;
+        for (int k = 0; k < 4; ++k) {
+            for (int a = 0; a < 3; ++a) {
+                p.o[a][k] = rays.origin[k][a];
+                float d = rays.dir[k][a];
+                p.inv[a][k] = 1.0f / (std::fabs(d) > 1e-12f ? d : (d < 0.0f ? -1e-12f : 1e-12f));
+            }
+            p.tFar[k] = rays.tMax[k];
+        }
+
+        thread_local std::vector<int> stack;     // reused: bakes trace millions of packets
+        stack.clear();
+        stack.push_back(0);
+        float tNear[4];
+
+        while (!stack.empty()) {
+            const BvhNode& node = nodes[stack.back()];
+            stack.pop_back();
+            // re-test: tFar may have shrunk since this node was pushed
+            if (!slab4(node.bounds, p, tNear)) continue;
+
+            if (node.isLeaf()) {
+                for (int i = node.first; i < node.first + node.count; ++i) {
+                    int mask = slab4(primBounds[i], p, tNear);
+                    for (int k = 0; k < 4; ++k) {
+                        if (!(mask & (1 << k))) continue;
+                        float t = hit(prims[i], k, tNear[k]);
+                        if (t == FLT_MAX || t > p.tFar[k]) continue;
+                        hits[k].prim = prims[i];
+                        hits[k].t = t;
+                        p.tFar[k] = t;
+                    }
+                }
+                continue;
+            }
+
+            // Nearer child (first active lane) is visited first
+            float tl[4], tr[4];
+            int ml = slab4(nodes[node.left].bounds, p, tl);
+            int mr = slab4(nodes[node.left + 1].bounds, p, tr);
+            if (ml && mr) {
+                int k = 0;
+                while (!((ml & mr) & (1 << k)) && k < 3) ++k;
+                bool leftFirst = tl[k] <= tr[k];
+                stack.push_back(leftFirst ? node.left + 1 : node.left);
+                stack.push_back(leftFirst ? node.left : node.left + 1);
+            }
+            else if (ml) stack.push_back(node.left);
+            else if (mr) stack.push_back(node.left + 1);
+        }
+    }
+
+    template <class Accept>
+    RayHit raycast(const glm::vec3& origin, const glm::vec3& dir, float tMax, Accept&& accept) const {
+        RayPacket4 rays;
+        for (int k = 0; k < 4; ++k) {
+            rays.origin[k] = origin;
+            rays.dir[k] = dir;
+            rays.tMax[k] = tMax;
+        }
+        RayHit hits[4];
+        intersect4(rays, hits, accept);
+        return hits[0];
+    }
+
+private:
+    // Rays in SoA form: one row per axis, one column per lane
+    struct alignas(16) Packet {
+        float o[3][4];
+        float inv[3][4];
+        float tFar[4];
+    };
+
+    static float area(const Aabb& b) {
+        glm::vec3 d = b.max - b.min;
+        return d.x * d.y + d.y * d.z + d.z * d.x;
+    }
+
+    Aabb unionOf(const Aabb* boxes, int first, int n) const {
+        Aabb b = boxes[prims[first]];
+        for (int i = 1; i < n; ++i) b.expand(boxes[prims[first + i]]);
+        return b;
+    }
+
+    // Partitions prims[first, first + n) and returns the split point, or -1
+    // when a leaf is cheaper (only allowed up to kMaxLeaf primitives).
+    int split(const Aabb* boxes, const std::vector<glm::vec3>& centroids, int first, int n, const Aabb& nodeBounds) {
+        glm::vec3 cmin(FLT_MAX), cmax(-FLT_MAX);
+        for (int i = first; i < first + n; ++i) {
+            cmin = glm::min(cmin, centroids[prims[i]]);
+            cmax = glm::max(cmax, centroids[prims[i]]);
+        }
+
+        // Costs relative to one box test: traversal 1, each primitive 1
+        float bestCost = FLT_MAX;
+        int bestAxis = -1, bestBin = 0;
+        for (int a = 0; a < 3; ++a) {
+            float extent = cmax[a] - cmin[a];
+            if (extent <= 0.0f) continue;
+            float scale = kBins / extent;
+
+            Aabb binBounds[kBins];
+            int binCount[kBins] = {};
+            for (int i = first; i < first + n; ++i) {
+                int b = std::min(kBins - 1, (int)((centroids[prims[i]][a] - cmin[a]) * scale));
+                const Aabb& box = boxes[prims[i]];
+                if (binCount[b]++ == 0) binBounds[b] = box;
+                else binBounds[b].expand(box);
+            }
+
+            // Sweep: areas / counts left of each plane, then right
+            float leftArea[kBins - 1];
+            int leftCount[kBins - 1];
+            Aabb acc;
+            int cnt = 0;
+            for (int b = 0; b < kBins - 1; ++b) {
+                if (binCount[b]) {
+                    if (cnt == 0) acc = binBounds[b];
+                    else acc.expand(binBounds[b]);
+                    cnt += binCount[b];
+                }
+                leftArea[b] = cnt ? area(acc) : 0.0f;
+                leftCount[b] = cnt;
+            }
+            cnt = 0;
+            for (int b = kBins - 1; b > 0; --b) {
+                if (binCount[b]) {
+                    if (cnt == 0) acc = binBounds[b];
+                    else acc.expand(binBounds[b]);
+                    cnt += binCount[b];
+                }
+                int lc = leftCount[b - 1];
+                if (lc == 0 || cnt == 0) continue;
+                float cost = leftArea[b - 1] * lc + area(acc) * cnt;
+                if (cost < bestCost) {
+                    bestCost = cost;
+                    bestAxis = a;
+                    bestBin = b;
+                }
+            }
+        }
+
+        float parentArea = area(nodeBounds);
+        float splitCost = 1.0f + (parentArea > 0.0f ? bestCost / parentArea : (float)n);
+        if (bestAxis >= 0 && (splitCost < (float)n || n > kMaxLeaf)) {
+            float scale = kBins / (cmax[bestAxis] - cmin[bestAxis]);
+            int* mid = std::partition(prims.data() + first, prims.data() + first + n, [&](int p) {
+                int b = std::min(kBins - 1, (int)((centroids[p][bestAxis] - cmin[bestAxis]) * scale));
+                return b < bestBin;
+            });
+            int m = (int)(mid - prims.data());
+            if (m > first && m < first + n) return m;
+        }
+        if (n <= kMaxLeaf) return -1;
+
+        // All centroids in one spot (or one bin): split the range in half
+        int axis = 0;
+        glm::vec3 ext = cmax - cmin;
+        if (ext.y > ext[axis]) axis = 1;
+        if (ext.z > ext[axis]) axis = 2;
+        int m = first + n / 2;
+        std::nth_element(prims.begin() + first, prims.begin() + m, prims.begin() + first + n,
+            [&](int x, int y) { return centroids[x][axis] < centroids[y][axis]; });
+        return m;
+    }
+
+    // Slab test for four rays against one box. Returns the lane mask of rays
+    // entering before their tFar; tNear receives the entry distances.
+    static int slab4(const Aabb& b, const Packet& p, float tNear[4]) {
+#if CAFE_SSE
+        __m128 lo = _mm_setzero_ps();
+        __m128 hi = _mm_loadu_ps(p.tFar);
+        for (int a = 0; a < 3; ++a) {
+            __m128 o = _mm_load_ps(p.o[a]);
+            __m128 inv = _mm_load_ps(p.inv[a]);
+            __m128 t1 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(b.min[a]), o), inv);
+            __m128 t2 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(b.max[a]), o), inv);
+            lo = _mm_max_ps(lo, _mm_min_ps(t1, t2));
+            hi = _mm_min_ps(hi, _mm_max_ps(t1, t2));
+        }
+        _mm_storeu_ps(tNear, lo);
+        return _mm_movemask_ps(_mm_cmple_ps(lo, hi));
+#else
+        int mask = 0;
+        for (int k = 0; k < 4; ++k) {
+            float lo = 0.0f, hi = p.tFar[k];
+            for (int a = 0; a < 3; ++a) {
+                float t1 = (b.min[a] - p.o[a][k]) * p.inv[a][k];
+                float t2 = (b.max[a] - p.o[a][k]) * p.inv[a][k];
+                lo = std::max(lo, std::min(t1, t2));
+                hi = std::min(hi, std::max(t1, t2));
+            }
+            tNear[k] = lo;
+            if (lo <= hi) mask |= 1 << k;
+        }
+        return mask;
+#endif
+    }
+};
+#endif
@@ -0,0 +1,110 @@
+#ifndef BOUNDS_H
+#define BOUNDS_H
+
+#include <cmath>
+#include <glm/glm.hpp>
+
+// ======================================================
+// Axis-aligned boxes and view frustum tests
+// ======================================================
+struct Aabb {
+    glm::vec3 min = glm::vec3(0.0f);
+    glm::vec3 max = glm::vec3(0.0f);
+
+    glm::vec3 center() const { return (min + max) * 0.5f; }
+    glm::vec3 extent() const { return (max - min) * 0.5f; }
+
+    bool contains(const glm::vec3& p, float pad = 0.0f) const {
+        return p.x >= min.x - pad && p.y >= min.y - pad && p.z >= min.z - pad
+            && p.x <= max.x + pad && p.y <= max.y + pad && p.z <= max.z + pad;
+    }
+
+    void expand(const Aabb& o) {
+        min = glm::min(min, o.min);
+        max = glm::max(max, o.max);
+    }
+};
+
+// World box of a transformed local box (center / extent form, no corner loop)
+inline Aabb transformAabb(const Aabb& local, const glm::mat4& m) {
+    glm::vec3 c = glm::vec3(m * glm::vec4(local.center(), 1.0f));
+    glm::vec3 e = local.extent();
+    glm::vec3 r;
+    for (int i = 0; i < 3; ++i)
+        r[i] = std::fabs(m[0][i]) * e.x + std::fabs(m[1][i]) * e.y + std::fabs(m[2][i]) * e.z;
+    Aabb out;
+    out.min = c - r;
+    out.max = c + r;
+    return out;
+}
+
+// Six planes (xyz = inward normal, w = distance) taken from a view-projection matrix
+struct Frustum {
+    glm::vec4 planes[6];
+
+    static Frustum fromMatrix(const glm::mat4& vp) {
+        glm::vec4 row0 = glm::vec4(vp[0][0], vp[1][0], vp[2][0], vp[3][0]);
+        glm::vec4 row1 = glm::vec4(vp[0][1], vp[1][1], vp[2][1], vp[3][1]);
+        glm::vec4 row2 = glm::vec4(vp[0][2], vp[1][2], vp[2][2], vp[3][2]);
+        glm::vec4 row3 = glm::vec4(vp[0][3], vp[1][3], vp[2][3], vp[3][3]);
+
+        Frustum f;
+        f.planes[0] = row3 + row0;  // left
+        f.planes[1] = row3 - row0;  // right
+        f.planes[2] = row3 + row1;  // bottom
+        f.planes[3] = row3 - row1;  // top
+        f.planes[4] = row3 + row2;  // near
+        f.planes[5] = row3 - row2;  // far
+        for (glm::vec4& p : f.planes)
+            p /= glm::length(glm::vec3(p));
+        return f;
+    }
+
+    // Sub-frustum seen through an NDC rectangle (x0, y0, x1, y1), e.g. a
+    // portal's screen bounds; the full rectangle gives fromMatrix(vp)
+    static Frustum fromMatrixRect(const glm::mat4& vp, const glm::vec4& rect) {
+        glm::vec4 row0 = glm::vec4(vp[0][0], vp[1][0], vp[2][0], vp[3][0]);
+        glm::vec4 row1 = glm::vec4(vp[0][1], vp[1][1], vp[2][1], vp[3][1]);
+        glm::vec4 row3 = glm::vec4(vp[0][3], vp[1][3], vp[2][3], vp[3][3]);
+
+        Frustum f = fromMatrix(vp);
+        f.planes[0] = row0 - row3 * rect.x;     // x / w >= x0
+        f.planes[1] = row3 * rect.z - row0;     // x / w <= x1
+        f.planes[2] = row1 - row3 * rect.y;
+        f.planes[3] = row3 * rect.w - row1;
+        for (int i = 0; i < 4; ++i)
+            f.planes[i] /= glm::length(glm::vec3(f.planes[i]));
+        return f;
+    }
+
+    // Conservative: false only when the box is fully outside one plane
+    bool intersects(const Aabb& b) const {
+        glm::vec3 c = b.center();
+        glm::vec3 e = b.extent();
+        for (const glm::vec4& p : planes) {
+            float r = e.x * std::fabs(p.x) + e.y * std::fabs(p.y) + e.z * std::fabs(p.z);
+            if (glm::dot(glm::vec3(p), c) + p.w < -r) return false;
+        }
+        return true;
+    }
+
+    // Hierarchical test: bit i of planeMask set = box already known to be
+    // inside plane i (skipped). Planes the box is fully inside get their bit
+    // set, so children only test what is left.
+    enum Result { OUTSIDE, INTERSECTS, INSIDE };
+
+    Result classify(const Aabb& b, unsigned int& planeMask) const {
+        glm::vec3 c = b.center();
+        glm::vec3 e = b.extent();
+        for (int i = 0; i < 6; ++i) {
+            if (planeMask & (1u << i)) continue;
+            const glm::vec4& p = planes[i];
+            float r = e.x * std::fabs(p.x) + e.y * std::fabs(p.y) + e.z * std::fabs(p.z);
+            float d = glm::dot(glm::vec3(p), c) + p.w;
+            if (d < -r) return OUTSIDE;
+            if (d > r) planeMask |= 1u << i;
+        }
+        return planeMask == 0x3Fu ? INSIDE : INTERSECTS;
+    }
+};
+#endif
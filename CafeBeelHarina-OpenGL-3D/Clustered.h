@@ -0,0 +1,214 @@
+#ifndef CLUSTERED_H
+#define CLUSTERED_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "JobSystem.h"
+#include "Shader.h"
+#include "Simd.h"
+
+// ======================================================
+// Clustered forward lighting
+// The view frustum is cut into kTilesX x kTilesY screen tiles (in NDC, so
+// any viewport size) times kSlices depth slices, spaced exponentially from
+// kFirstSlice to the far plane. Every frame the point lights are tested
+// against each cluster's view-space box on the CPU (one job per slice,
+// four lights per SSE test) and three buffer textures go up:
+//   grid    (RG32UI)  : per cluster, first index and count
+//   indices (R32UI)   : light indices, cluster after cluster
+//   lights  (RGBA32F) : per light, world position + radius, colour + intensity
+// fragment_shader.fs finds its cluster and loops over that list only.
+// ======================================================
+struct PointLight {
+    glm::vec3 position;     // world
+    float radius;           // no light beyond
+    glm::vec3 color;
+    float intensity;
+};
+
+class ClusteredLights {
+public:
+    static constexpr int kTilesX = 16;
+    static constexpr int kTilesY = 9;
+    static constexpr int kSlices = 24;
+    static constexpr int kClusters = kTilesX * kTilesY * kSlices;
+    static constexpr float kFirstSlice = 1.0f;      // metres; everything nearer is slice 0
+
+    std::vector<PointLight> lights;
+    int lightRefs = 0;          // indices in the list, last build
+    int maxPerCluster = 0;
+    double buildMs = 0.0;
+
+    void initGL() {
+        glGenBuffers(3, buffers);
+        glGenTextures(3, textures);
+        const GLenum formats[3] = { GL_RG32UI, GL_R32UI, GL_RGBA32F };
+        for (int i = 0; i < 3; ++i) {
+            glBindBuffer(GL_TEXTURE_BUFFER, buffers[i]);
+            glBufferData(GL_TEXTURE_BUFFER, 16, nullptr, GL_STREAM_DRAW);
+            glBindTexture(GL_TEXTURE_BUFFER, textures[i]);
+            glTexBuffer(GL_TEXTURE_BUFFER, formats[i], buffers[i]);
+        }
+        glBindBuffer(GL_TEXTURE_BUFFER, 0);
+        glBindTexture(GL_TEXTURE_BUFFER, 0);
+    }
+
+    // Assigns `lights` to clusters for this camera and uploads the result
+    void build(const glm::mat4& view, const glm::mat4& projection) {
+        auto start = std::chrono::high_resolution_clock::now();
+        nearPlane = projection[3][2] / (projection[2][2] - 1.0f);
+        farPlane = projection[3][2] / (projection[2][2] + 1.0f);
+        firstSlice = std::min(std::max(kFirstSlice, nearPlane), farPlane * 0.5f);
+
+        // View-space spheres, structure of arrays padded to a multiple of 4
+        int count = (int)lights.size();
+        int padded = (count + 3) & ~3;
+        for (std::vector<float>* v : { &lx, &ly, &lz, &lr }) v->assign(padded, 0.0f);
+        for (int i = 0; i < count; ++i) {
+            glm::vec3 p = glm::vec3(view * glm::vec4(lights[i].position, 1.0f));
+            lx[i] = p.x;
+            ly[i] = p.y;
+            lz[i] = p.z;
+            lr[i] = lights[i].radius;
+        }
+        for (int i = count; i < padded; ++i) lz[i] = 1.0e9f;     // never inside a cluster
+
+        float sx = 1.0f / projection[0][0], sy = 1.0f / projection[1][1];
+        for (std::vector<uint32_t>& s : sliceIndices) s.clear();
+        JobSystem::instance().parallelFor(kSlices, 1, [&](int k0, int k1) {
+            for (int k = k0; k < k1; ++k) buildSlice(k, sx, sy, padded);
+        });
+
+        // Slices were filled independently; shift their offsets into one list
+        indices.clear();
+        maxPerCluster = 0;
+        for (int k = 0; k < kSlices; ++k) {
+            uint32_t base = (uint32_t)indices.size();
+            for (int c = k * kTilesX * kTilesY; c < (k + 1) * kTilesX * kTilesY; ++c) {
+                grid[2 * c] += base;
+                maxPerCluster = std::max(maxPerCluster, (int)grid[2 * c + 1]);
+            }
+            indices.insert(indices.end(), sliceIndices[k].begin(), sliceIndices[k].end());
+        }
+        lightRefs = (int)indices.size();
+        if (indices.empty()) indices.push_back(0);
+
+        packed.resize((size_t)std::max(count, 1) * 8);
+        for (int i = 0; i < count; ++i) {
+            const PointLight& l = lights[i];
+            float* o = &packed[(size_t)i * 8];
+            o[0] = l.position.x; o[1] = l.position.y; o[2] = l.position.z; o[3] = l.radius;
+            o[4] = l.color.r;    o[5] = l.color.g;    o[6] = l.color.b;    o[7] = l.intensity;
+        }
+
+        upload(0, grid.data(), grid.size() * sizeof(uint32_t));
+        upload(1, indices.data(), indices.size() * sizeof(uint32_t));
+        upload(2, packed.data(), packed.size() * sizeof(float));
+        buildMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+    }
+
+    // Points the buffer samplers at their units. Needed once per program even
+    // when unlit: left on unit 0 they would clash with the 2D texture there.
+    static void useUnits(const Shader& shader, int firstUnit) {
+        shader.setInt("uClusterGrid", firstUnit);
+        shader.setInt("uLightIndices", firstUnit + 1);
+        shader.setInt("uLightData", firstUnit + 2);
+    }
+
+    // Buffer textures on units firstUnit .. firstUnit + 2
+    void bind(const Shader& shader, int firstUnit) const {
+        for (int i = 0; i < 3; ++i) {
+            glActiveTexture(GL_TEXTURE0 + firstUnit + i);
+            glBindTexture(GL_TEXTURE_BUFFER, textures[i]);
+        }
+        glActiveTexture(GL_TEXTURE0);
+        useUnits(shader, firstUnit);
+        float logRange = std::log(farPlane / firstSlice);
+        glUniform3i(glGetUniformLocation(shader.ID, "uClusterDims"), kTilesX, kTilesY, kSlices);
+        shader.setV2("uClusterDepth", glm::vec2(kSlices / logRange, -std::log(firstSlice) * kSlices / logRange));
+    }
+
+    void release() {
+        if (buffers[0]) glDeleteBuffers(3, buffers);
+        if (textures[0]) glDeleteTextures(3, textures);
+        for (int i = 0; i < 3; ++i) buffers[i] = textures[i] = 0;
+    }
+
+private:
+    unsigned int buffers[3] = {};
+    unsigned int textures[3] = {};
+    float nearPlane = 0.1f, farPlane = 100.0f, firstSlice = kFirstSlice;
+
+    std::vector<float> lx, ly, lz, lr;
+    std::vector<uint32_t> grid = std::vector<uint32_t>(2 * kClusters);
+    std::vector<uint32_t> sliceIndices[kSlices];
+    std::vector<uint32_t> indices;
+    std::vector<float> packed;
+
+    float sliceDepth(int k) const {
+        if (k == 0) return nearPlane;
+        return firstSlice * std::pow(farPlane / firstSlice, (float)k / kSlices);
+    }
+
+    // Clusters of slice k; grid offsets relative to the slice's own list
+    void buildSlice(int k, float sx, float sy, int padded) {
+        std::vector<uint32_t>& out = sliceIndices[k];
+        float d0 = sliceDepth(k), d1 = sliceDepth(k + 1);
+        for (int ty = 0; ty < kTilesY; ++ty)
+            for (int tx = 0; tx < kTilesX; ++tx) {
+                // View-space box of the tile between the two depths (camera looks down -z)
+                float x0 = (-1.0f + 2.0f * tx / kTilesX) * sx, x1 = (-1.0f + 2.0f * (tx + 1) / kTilesX) * sx;
+                float y0 = (-1.0f + 2.0f * ty / kTilesY) * sy, y1 = (-1.0f + 2.0f * (ty + 1) / kTilesY) * sy;
+                glm::vec3 mn(std::min(x0 * d0, x0 * d1), std::min(y0 * d0, y0 * d1), -d1);
+                glm::vec3 mx(std::max(x1 * d0, x1 * d1), std::max(y1 * d0, y1 * d1), -d0);
+
+                int cluster = (k * kTilesY + ty) * kTilesX + tx;
+                uint32_t first = (uint32_t)out.size();
+                for (int i = 0; i < padded; i += 4) {
+                    int hits = touching4(i, mn, mx);
+                    for (int j = 0; j < 4; ++j)
+                        if (hits & (1 << j)) out.push_back((uint32_t)(i + j));
+                }
+                grid[2 * cluster] = first;
+                grid[2 * cluster + 1] = (uint32_t)out.size() - first;
+            }
+    }
+
+    // Bit j set: sphere i + j reaches the box
+    int touching4(int i, const glm::vec3& mn, const glm::vec3& mx) const {
+#if CAFE_SSE
+        __m128 zero = _mm_setzero_ps();
+        __m128 d2 = zero;
+        const float* c[3] = { &lx[i], &ly[i], &lz[i] };
+        for (int a = 0; a < 3; ++a) {
+            __m128 p = _mm_loadu_ps(c[a]);
+            __m128 d = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_set1_ps(mn[a]), p), _mm_sub_ps(p, _mm_set1_ps(mx[a]))), zero);
+            d2 = _mm_add_ps(d2, _mm_mul_ps(d, d));
+        }
+        __m128 r = _mm_loadu_ps(&lr[i]);
+        return _mm_movemask_ps(_mm_cmple_ps(d2, _mm_mul_ps(r, r)));
+#else
+        int hits = 0;
+        for (int j = 0; j < 4; ++j) {
+            glm::vec3 p(lx[i + j], ly[i + j], lz[i + j]);
+            glm::vec3 d = glm::max(glm::max(mn - p, p - mx), glm::vec3(0.0f));
+            if (glm::dot(d, d) <= lr[i + j] * lr[i + j]) hits |= 1 << j;
+        }
+        return hits;
+#endif
+    }
+
+    void upload(int i, const void* data, size_t bytes) {
+        glBindBuffer(GL_TEXTURE_BUFFER, buffers[i]);
+        glBufferData(GL_TEXTURE_BUFFER, (GLsizeiptr)bytes, data, GL_STREAM_DRAW);
+        glBindBuffer(GL_TEXTURE_BUFFER, 0);
+    }
+};
+#endif
@@ -0,0 +1,212 @@
+#ifndef CONST_MESH_H
+#define CONST_MESH_H
+
+#include <array>
+#include <cstddef>
+
+// ======================================================
+// Compile-time primitive meshes
+// Same interleaved layout as Sphere / Cylinder / SimpleCone:
+//   pos(3) normal(3) uv(2)
+// The data is baked into the binary, so startup does no mesh math.
+// ======================================================
+constexpr int kVertexStride = 8;
+constexpr int kVertexStrideBytes = kVertexStride * (int)sizeof(float);
+
+namespace cmesh {
+
+constexpr double kPi = 3.14159265358979323846;
+
+// sin() for constant expressions (range reduced Taylor series)
+constexpr double sinRad(double x) {
+    // wrap to [-pi, pi]
+    long long turns = (long long)(x / (2.0 * kPi));
+    x -= (double)turns * 2.0 * kPi;
+    if (x > kPi) x -= 2.0 * kPi;
+    if (x < -kPi) x += 2.0 * kPi;
+
+    // fold to [-pi/2, pi/2], sin(pi - x) == sin(x)
+    if (x > kPi / 2) x = kPi - x;
+    if (x < -kPi / 2) x = -kPi - x;
+
+    double x2 = x * x;
+    double term = x;
+    double sum = x;
+    for (int n = 1; n < 10; ++n) {
+        term *= -x2 / ((2.0 * n) * (2.0 * n + 1.0));
+        sum += term;
+    }
+    return sum;
+}
+
+constexpr double cosRad(double x) { return sinRad(x + kPi / 2); }
+
+constexpr double sqrt(double v) {
+    if (v <= 0.0) return 0.0;
+    double r = v > 1.0 ? v : 1.0;
+    for (int i = 0; i < 64; ++i) {
+        double next = 0.5 * (r + v / r);
+        if (next == r) break;
+        r = next;
+    }
+    return r;
+}
+
+// ------------------------------
+// Unit sphere (matches Sphere(1.0f, Sectors, Stacks))
+// ------------------------------
+template <int Sectors, int Stacks>
+constexpr std::array<float, (Stacks + 1) * (Sectors + 1) * kVertexStride> sphereVertices() {
+    std::array<float, (Stacks + 1) * (Sectors + 1) * kVertexStride> v{};
+    double sectorStep = 2 * kPi / Sectors;
+    double stackStep = kPi / Stacks;
+    int k = 0;
+
+    for (int i = 0; i <= Stacks; ++i) {
+        double stackAngle = kPi / 2 - i * stackStep;   // pi/2 .. -pi/2
+        double xy = cosRad(stackAngle);
+        double z = sinRad(stackAngle);
+
+        for (int j = 0; j <= Sectors; ++j) {
+            double sectorAngle = j * sectorStep;
+            float x = (float)(xy * cosRad(sectorAngle));
+            float y = (float)(xy * sinRad(sectorAngle));
+
+            v[k++] = x;  v[k++] = y;  v[k++] = (float)z;   // position
+            v[k++] = x;  v[k++] = y;  v[k++] = (float)z;   // normal (unit radius)
+            v[k++] = (float)j / Sectors;                    // s
+            v[k++] = (float)i / Stacks;                     // t
+        }
+    }
+    return v;
+}
+
+template <int Sectors, int Stacks>
+constexpr std::array<unsigned int, 6 * Sectors * (Stacks - 1)> sphereIndices() {
+    std::array<unsigned int, 6 * Sectors * (Stacks - 1)> idx{};
+    int n = 0;
+    for (int i = 0; i < Stacks; ++i) {
+        unsigned int k1 = i * (Sectors + 1);
+        unsigned int k2 = k1 + Sectors + 1;
+        for (int j = 0; j < Sectors; ++j, ++k1, ++k2) {
+            // 2 triangles per sector excluding pole stacks
+            if (i != 0) {
+                idx[n++] = k1; idx[n++] = k2; idx[n++] = k1 + 1;
+            }
+            if (i != (Stacks - 1)) {
+                idx[n++] = k1 + 1; idx[n++] = k2; idx[n++] = k2 + 1;
+            }
+        }
+    }
+    return idx;
+}
+
+// ------------------------------
+// Unit cylinder along Z (matches Cylinder(1, 1, 1, Sectors, Stacks))
+// ------------------------------
+template <int Sectors, int Stacks>
+constexpr std::array<float, (Stacks + 1) * (Sectors + 1) * kVertexStride> cylinderVertices() {
+    std::array<float, (Stacks + 1) * (Sectors + 1) * kVertexStride> v{};
+    double sectorStep = 2 * kPi / Sectors;
+    double stackStep = 1.0 / Stacks;
+    int k = 0;
+
+    for (int i = 0; i <= Stacks; ++i) {
+        double zPos = -0.5 + i * stackStep;
+        for (int j = 0; j <= Sectors; ++j) {
+            double sectorAngle = j * sectorStep;
+            double x = cosRad(sectorAngle);
+            double y = sinRad(sectorAngle);
+            double absN = sqrt(x * x + y * y);
+
+            v[k++] = (float)x;  v[k++] = (float)y;  v[k++] = (float)zPos;
+            v[k++] = (float)(absN == 0 ? 0 : x / absN);
+            v[k++] = (float)(absN == 0 ? 0 : y / absN);
+            v[k++] = 0.0f;
+            v[k++] = (float)j / Sectors;
+            v[k++] = (float)i / Stacks;
+        }
+    }
+    return v;
+}
+
+template <int Sectors, int Stacks>
+constexpr std::array<unsigned int, 6 * Sectors * Stacks> cylinderIndices() {
+    std::array<unsigned int, 6 * Sectors * Stacks> idx{};
+    int n = 0;
+    for (int i = 0; i < Stacks; ++i) {
+        unsigned int k1 = i * (Sectors + 1);
+        unsigned int k2 = k1 + Sectors + 1;
+        for (int j = 0; j < Sectors; ++j, ++k1, ++k2) {
+            idx[n++] = k1;     idx[n++] = k2; idx[n++] = k1 + 1;
+            idx[n++] = k1 + 1; idx[n++] = k2; idx[n++] = k2 + 1;
+        }
+    }
+    return idx;
+}
+
+// ------------------------------
+// Unit cone, tip at +Y (matches SimpleCone::build(Segments))
+// ------------------------------
+template <int Segments>
+constexpr std::array<float, Segments * 3 * kVertexStride> coneVertices() {
+    std::array<float, Segments * 3 * kVertexStride> v{};
+    int k = 0;
+
+    auto push = [&](double px, double py, double pz, double s, double t) {
+        // same normal as SimpleCone: normalize(p.x, 0.6, p.z)
+        double len = sqrt(px * px + 0.36 + pz * pz);
+        v[k++] = (float)px; v[k++] = (float)py; v[k++] = (float)pz;
+        v[k++] = (float)(px / len); v[k++] = (float)(0.6 / len); v[k++] = (float)(pz / len);
+        v[k++] = (float)s; v[k++] = (float)t;
+    };
+
+    for (int i = 0; i < Segments; i++) {
+        double a0 = (double)i / Segments * 2.0 * kPi;
+        double a1 = (double)(i + 1) / Segments * 2.0 * kPi;
+
+        push(cosRad(a0), 0.0, sinRad(a0), (double)i / Segments, 0.0);
+        push(cosRad(a1), 0.0, sinRad(a1), (double)(i + 1) / Segments, 0.0);
+        push(0.0, 1.0, 0.0, ((double)i + 0.5) / Segments, 1.0);
+    }
+    return v;
+}
+
+} // namespace cmesh
+
+// ======================================================
+// Generators
+// e.g. ConstSphere<32, 16>::vertices / ::indices
+// ======================================================
+template <int Sectors, int Stacks>
+struct ConstSphere {
+    static_assert(Sectors >= 3 && Stacks >= 2, "ConstSphere needs at least 3 sectors and 2 stacks");
+
+    static constexpr int kVertexCount = (Stacks + 1) * (Sectors + 1);
+    static constexpr int kIndexCount = 6 * Sectors * (Stacks - 1);
+
+    static constexpr std::array<float, kVertexCount * kVertexStride> vertices = cmesh::sphereVertices<Sectors, Stacks>();
+    static constexpr std::array<unsigned int, kIndexCount> indices = cmesh::sphereIndices<Sectors, Stacks>();
+};
+
+template <int Sectors, int Stacks = 1>
+struct ConstCylinder {
+    static_assert(Sectors >= 3 && Stacks >= 1, "ConstCylinder needs at least 3 sectors and 1 stack");
+
+    static constexpr int kVertexCount = (Stacks + 1) * (Sectors + 1);
+    static constexpr int kIndexCount = 6 * Sectors * Stacks;
+
+    static constexpr std::array<float, kVertexCount * kVertexStride> vertices = cmesh::cylinderVertices<Sectors, Stacks>();
+    static constexpr std::array<unsigned int, kIndexCount> indices = cmesh::cylinderIndices<Sectors, Stacks>();
+};
+
+template <int Segments>
+struct ConstCone {
+    static_assert(Segments >= 3, "ConstCone needs at least 3 segments");
+
+    static constexpr int kVertexCount = Segments * 3;   // non-indexed, drawn with glDrawArrays
+
+    static constexpr std::array<float, kVertexCount * kVertexStride> vertices = cmesh::coneVertices<Segments>();
+};
+
+#endif
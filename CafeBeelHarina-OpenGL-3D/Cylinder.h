@@ -11,6 +11,7 @@ public:
     std::vector<float> vertices;
     std::vector<unsigned int> indices;
     unsigned int vao, vbo, ebo;
+    int indexCount = 0;
 
     Cylinder(float baseRadius = 1.0f, float topRadius = 1.0f, float height = 1.0f, int sectorCount = 36, int stackCount = 1) {
         float x, y, z;
@@ -64,27 +65,34 @@ public:
                 indices.push_back(k2 + 1);
             }
         }
-        setupMesh();
+        setupMesh(vertices.data(), (int)(vertices.size() / 8), indices.data(), (int)indices.size());
+    }
+
+    // Upload prebuilt interleaved data (e.g. ConstCylinder<>) without running the generator
+    Cylinder(const float* vertexData, int vertexCount, const unsigned int* indexData, int count) {
+        setupMesh(vertexData, vertexCount, indexData, count);
     }
 
     void draw() {
         glBindVertexArray(vao);
-        glDrawElements(GL_TRIANGLES, (unsigned int)indices.size(), GL_UNSIGNED_INT, 0);
+        glDrawElements(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, 0);
         glBindVertexArray(0);
     }
 
 private:
-    void setupMesh() {
+    void setupMesh(const float* vertexData, int vertexCount, const unsigned int* indexData, int count) {
+        indexCount = count;
+
         glGenVertexArrays(1, &vao);
         glGenBuffers(1, &vbo);
         glGenBuffers(1, &ebo);
 
         glBindVertexArray(vao);
         glBindBuffer(GL_ARRAY_BUFFER, vbo);
-        glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), &vertices[0], GL_STATIC_DRAW);
+        glBufferData(GL_ARRAY_BUFFER, vertexCount * 8 * sizeof(float), vertexData, GL_STATIC_DRAW);
 
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), &indices[0], GL_STATIC_DRAW);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexCount * sizeof(unsigned int), indexData, GL_STATIC_DRAW);
 
         glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
         glEnableVertexAttribArray(0);
@@ -0,0 +1,253 @@
+#ifndef ECS_H
+#define ECS_H
+
+#include <algorithm>
+#include <atomic>
+#include <utility>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "BVH.h"
+#include "Bounds.h"
+#include "JobSystem.h"
+#include "OcclusionCuller.h"
+#include "SceneGraph.h"
+
+// ======================================================
+// Entity store (structure of arrays)
+// An entity is an index; every component lives in its own contiguous array
+// so each system only streams the data it needs.
+// ======================================================
+enum EntityFlags : unsigned int {
+    ENT_VISIBLE     = 1u << 0,  // written by the culling system each frame
+    ENT_STATIC      = 1u << 1,  // world transform never changes after creation
+    ENT_TRANSPARENT = 1u << 2,  // glass (material alpha < 1), drawn after opaque entities
+    ENT_OCCLUDER    = 1u << 3,  // large solid surface, usable to hide others
+    ENT_HIDDEN      = 1u << 4,  // switched off: skipped by culling and drawing
+    ENT_REPLACED    = 1u << 5,  // stood in for by an HLOD proxy, or a proxy not in use (see Hlod.h)
+    ENT_BAKED       = 1u << 6,  // colour comes from its texture in every texture mode (HLOD atlas)
+    ENT_LIGHT       = 1u << 7,  // point light at its centre, in its colour (see Clustered.h)
+
+    ENT_SKIP        = ENT_HIDDEN | ENT_REPLACED
+};
+
+class EntityStore {
+public:
+    // Transform
+    std::vector<glm::mat4> world;
+    std::vector<int> node;              // scene graph node driving world, -1 if none
+    // Bounds
+    std::vector<Aabb> localBounds;
+    std::vector<Aabb> bounds;           // world space
+    // Mesh handle / material
+    std::vector<int> mesh;
+    std::vector<glm::vec4> color;
+    std::vector<unsigned int> texture;
+    // Flags
+    std::vector<unsigned int> flags;
+    std::vector<int> group;             // e.g. owning table set, -1 if none
+    std::vector<int> cell;              // visibility cell, -1 if none (see Portals.h)
+
+    int create(const glm::mat4& m, const Aabb& local, int meshId, glm::vec4 c, unsigned int tex,
+               unsigned int f, int sceneNode = -1, int grp = -1) {
+        int id = size();
+        world.push_back(m);
+        node.push_back(sceneNode);
+        localBounds.push_back(local);
+        bounds.push_back(transformAabb(local, m));
+        mesh.push_back(meshId);
+        color.push_back(c);
+        texture.push_back(tex);
+        flags.push_back(f);
+        group.push_back(grp);
+        cell.push_back(-1);
+        return id;
+    }
+
+    void setLocalBounds(int e, const Aabb& local) {
+        localBounds[e] = local;
+        bounds[e] = transformAabb(local, world[e]);
+    }
+
+    int size() const { return (int)world.size(); }
+
+    void clear() { *this = EntityStore(); }
+
+    size_t memoryBytes() const {
+        return world.capacity() * sizeof(glm::mat4) + node.capacity() * sizeof(int)
+            + (localBounds.capacity() + bounds.capacity()) * sizeof(Aabb)
+            + mesh.capacity() * sizeof(int) + color.capacity() * sizeof(glm::vec4)
+            + (texture.capacity() + flags.capacity()) * sizeof(unsigned int) + (group.capacity() + cell.capacity()) * sizeof(int);
+    }
+};
+
+// Entity indices ready for submission
+struct DrawList {
+    std::vector<int> opaque;        // sorted by mesh, then texture (or front to back)
+    std::vector<int> transparent;   // creation order (or back to front, or by state under OIT)
+};
+
+namespace ecs {
+
+// Copies world matrices from scene nodes recomputed by the last
+// SceneGraph::update(); skipped entirely when nothing moved.
+inline int updateTransforms(EntityStore& s, const SceneGraph& graph, int recomputedNodes) {
+    if (recomputedNodes == 0) return 0;
+    int updated = 0;
+    for (int e = 0; e < s.size(); ++e) {
+        int n = s.node[e];
+        if (n < 0 || !graph.wasUpdated(n)) continue;
+        s.world[e] = graph.world(n);
+        s.bounds[e] = transformAabb(s.localBounds[e], s.world[e]);
+        ++updated;
+    }
+    return updated;
+}
+
+// Sets / clears ENT_VISIBLE against the frustum; returns the visible count
+inline int cull(EntityStore& s, const Frustum& frustum) {
+    std::atomic<int> visible{ 0 };
+    const Aabb* bounds = s.bounds.data();
+    unsigned int* flags = s.flags.data();
+
+    JobSystem::instance().parallelFor(s.size(), 512, [&](int begin, int end) {
+        int n = 0;
+        for (int e = begin; e < end; ++e) {
+            bool in = !(flags[e] & ENT_SKIP) && frustum.intersects(bounds[e]);
+            flags[e] = in ? (flags[e] | ENT_VISIBLE) : (flags[e] & ~ENT_VISIBLE);
+            n += in;
+        }
+        visible += n;
+    });
+    return visible.load();
+}
+
+// BVH path: only touches entities that were or are visible. `visible` holds
+// last frame's list on entry (its flags are cleared) and this frame's, in
+// entity order, on return.
+inline int cull(EntityStore& s, const Bvh& bvh, const Frustum& frustum, std::vector<int>& visible) {
+    unsigned int* flags = s.flags.data();
+    for (int e : visible) flags[e] &= ~ENT_VISIBLE;
+    visible.clear();
+
+    bvh.queryFrustum(frustum, [&](int e) {
+        if (flags[e] & ENT_SKIP) return;
+        flags[e] |= ENT_VISIBLE;
+        visible.push_back(e);
+    });
+    std::sort(visible.begin(), visible.end());
+    return (int)visible.size();
+}
+
+// Cell / portal path: frusta[i] only admits entities of cell frustumCell[i]
+// (-1 = entities in no cell), so each entity is emitted at most once
+inline int cull(EntityStore& s, const Bvh& bvh, const Frustum* frusta, const int* frustumCell, int count,
+                std::vector<int>& visible) {
+    unsigned int* flags = s.flags.data();
+    const int* cell = s.cell.data();
+    for (int e : visible) flags[e] &= ~ENT_VISIBLE;
+    visible.clear();
+
+    for (int first = 0; first < count; first += Bvh::kMaxFrusta) {
+        int n = std::min(Bvh::kMaxFrusta, count - first);
+        bvh.queryFrusta(frusta + first, n, [&](int f, int e) {
+            if (cell[e] != frustumCell[first + f] || (flags[e] & ENT_SKIP)) return;
+            flags[e] |= ENT_VISIBLE;
+            visible.push_back(e);
+        });
+    }
+    std::sort(visible.begin(), visible.end());
+    return (int)visible.size();
+}
+
+// Fewer VAO / texture switches; stable so equal keys keep creation order
+inline void sortByState(const EntityStore& s, std::vector<int>& ids) {
+    std::stable_sort(ids.begin(), ids.end(), [&](int a, int b) {
+        if (s.mesh[a] != s.mesh[b]) return s.mesh[a] < s.mesh[b];
+        return s.texture[a] < s.texture[b];
+    });
+}
+
+inline void sortDrawList(const EntityStore& s, DrawList& list) {
+    sortByState(s, list.opaque);
+}
+
+// Re-sorts a built draw list by view depth: opaque front to back by the
+// distance to each box (what the eye stands in comes first and fills the
+// depth buffer early), glass back to front by box centre so it blends
+// over what is behind it. Stable, so equal depths keep the state order.
+// With order-independent transparency the glass is state sorted instead.
+inline void sortDrawListByDepth(const EntityStore& s, DrawList& list, const glm::vec3& eye, bool glassBackToFront = true) {
+    std::vector<std::pair<float, int>> keyed;
+    auto sortBy = [&](std::vector<int>& ids, auto&& key) {
+        keyed.clear();
+        for (int e : ids) keyed.push_back({ key(s.bounds[e]), e });
+        std::stable_sort(keyed.begin(), keyed.end(), [](const std::pair<float, int>& a, const std::pair<float, int>& b) {
+            return a.first < b.first;
+        });
+        for (size_t i = 0; i < ids.size(); ++i) ids[i] = keyed[i].second;
+    };
+    sortBy(list.opaque, [&](const Aabb& b) {
+        glm::vec3 d = glm::max(glm::max(b.min - eye, eye - b.max), glm::vec3(0.0f));
+        return glm::dot(d, d);
+    });
+    if (!glassBackToFront) {
+        sortByState(s, list.transparent);
+        return;
+    }
+    sortBy(list.transparent, [&](const Aabb& b) {
+        glm::vec3 d = b.center() - eye;
+        return -glm::dot(d, d);
+    });
+}
+
+inline void buildDrawList(const EntityStore& s, DrawList& list) {
+    list.opaque.clear();
+    list.transparent.clear();
+    for (int e = 0; e < s.size(); ++e) {
+        unsigned int f = s.flags[e];
+        if (!(f & ENT_VISIBLE)) continue;
+        if (f & ENT_TRANSPARENT) list.transparent.push_back(e);
+        else list.opaque.push_back(e);
+    }
+    sortDrawList(s, list);
+}
+
+// Same, from a visible list in entity order (see the BVH cull)
+inline void buildDrawList(const EntityStore& s, const std::vector<int>& visible, DrawList& list) {
+    list.opaque.clear();
+    list.transparent.clear();
+    for (int e : visible) {
+        if (s.flags[e] & ENT_TRANSPARENT) list.transparent.push_back(e);
+        else list.opaque.push_back(e);
+    }
+    sortDrawList(s, list);
+}
+
+// Drops draw-list entries hidden behind the rasterized occluders and clears
+// their ENT_VISIBLE; occluders themselves are kept. Returns the count dropped.
+inline int occlusionCull(EntityStore& s, const OcclusionCuller& occlusion, DrawList& list) {
+    int dropped = 0;
+    std::vector<unsigned char> keep;
+    for (std::vector<int>* ids : { &list.opaque, &list.transparent }) {
+        keep.assign(ids->size(), 1);
+        const int* id = ids->data();
+        JobSystem::instance().parallelFor((int)ids->size(), 256, [&](int begin, int end) {
+            for (int i = begin; i < end; ++i)
+                keep[i] = (s.flags[id[i]] & ENT_OCCLUDER) || occlusion.isVisible(s.bounds[id[i]]);
+        });
+
+        int n = 0;
+        for (size_t i = 0; i < ids->size(); ++i) {
+            int e = (*ids)[i];
+            if (keep[i]) (*ids)[n++] = e;
+            else s.flags[e] &= ~ENT_VISIBLE;
+        }
+        dropped += (int)ids->size() - n;
+        ids->resize(n);
+    }
+    return dropped;
+}
+
+} // namespace ecs
+#endif
@@ -0,0 +1,68 @@
+#ifndef FRAMEBUFFER_H
+#define FRAMEBUFFER_H
+
+#include <glad/glad.h>
+
+#include <iostream>
+
+// ======================================================
+// Offscreen render target: a color texture plus an optional depth
+// renderbuffer. bind() also sets the viewport; rebinding framebuffer 0 and
+// the window viewport is up to the caller.
+// ======================================================
+class Framebuffer {
+public:
+    unsigned int fbo = 0;
+    unsigned int color = 0;
+    unsigned int depth = 0;
+    int width = 0, height = 0;
+
+    bool create(int w, int h, GLenum internalFormat = GL_RGBA8, GLenum format = GL_RGBA,
+                GLenum type = GL_UNSIGNED_BYTE, bool withDepth = true) {
+        release();
+        width = w;
+        height = h;
+
+        glGenTextures(1, &color);
+        glBindTexture(GL_TEXTURE_2D, color);
+        glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, w, h, 0, format, type, nullptr);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+        glGenFramebuffers(1, &fbo);
+        glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, color, 0);
+
+        if (withDepth) {
+            glGenRenderbuffers(1, &depth);
+            glBindRenderbuffer(GL_RENDERBUFFER, depth);
+            glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, w, h);
+            glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depth);
+        }
+
+        GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        if (status != GL_FRAMEBUFFER_COMPLETE) {
+            std::cout << "ERROR::FRAMEBUFFER::INCOMPLETE: 0x" << std::hex << status << std::dec << std::endl;
+            release();
+            return false;
+        }
+        return true;
+    }
+
+    void bind() const {
+        glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+        glViewport(0, 0, width, height);
+    }
+
+    void release() {
+        if (fbo) glDeleteFramebuffers(1, &fbo);
+        if (color) glDeleteTextures(1, &color);
+        if (depth) glDeleteRenderbuffers(1, &depth);
+        fbo = color = depth = 0;
+        width = height = 0;
+    }
+};
+#endif
@@ -0,0 +1,111 @@
+#ifndef GPU_OCCLUSION_H
+#define GPU_OCCLUSION_H
+
+#include <glad/glad.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "Bounds.h"
+
+// ======================================================
+// Hardware occlusion queries per table set (GL_ANY_SAMPLES_PASSED)
+// One query per set, never waited on from the CPU:
+// - visible last frame : drawn normally, bounding box tested afterwards
+// - hidden last frame  : box tested first, set drawn under
+//                        glBeginConditionalRender so the GPU skips it
+// - result not back yet: drawn normally, no new query
+// Skipped counts are known once a conditional set's result arrives, so
+// they lag the frame they describe by one or two frames.
+// ======================================================
+class OcclusionQueries {
+public:
+    enum Mode { DRAW, DRAW_THEN_TEST, TEST_THEN_CONDITIONAL };
+
+    std::vector<Aabb> bounds;       // per set, world space
+
+    void resize(int sets) {
+        release();
+        queries.assign(sets, 0);
+        if (sets > 0) glGenQueries(sets, queries.data());
+        state.assign(sets, SetState());
+        bounds.assign(sets, Aabb());
+    }
+
+    void release() {
+        if (!queries.empty()) glDeleteQueries((GLsizei)queries.size(), queries.data());
+        queries.clear();
+        state.clear();
+        bounds.clear();
+    }
+
+    int size() const { return (int)queries.size(); }
+
+    // Start of frame: pick up every result that is ready, without waiting
+    void poll(int& skippedSets, int64_t& skippedTriangles) {
+        skippedSets = 0;
+        skippedTriangles = 0;
+        for (int g = 0; g < size(); ++g) {
+            SetState& s = state[g];
+            s.wrapped = false;
+            if (!s.pending) continue;
+            GLuint ready = 0;
+            glGetQueryObjectuiv(queries[g], GL_QUERY_RESULT_AVAILABLE, &ready);
+            if (!ready) continue;
+
+            GLuint passed = 0;
+            glGetQueryObjectuiv(queries[g], GL_QUERY_RESULT, &passed);
+            s.visible = passed != 0;
+            s.pending = false;
+            if (s.conditional && !s.visible) {
+                ++skippedSets;
+                skippedTriangles += s.conditionalTriangles;
+            }
+        }
+    }
+
+    Mode mode(int g) const {
+        const SetState& s = state[g];
+        if (s.pending) return DRAW;
+        return s.visible ? DRAW_THEN_TEST : TEST_THEN_CONDITIONAL;
+    }
+
+    // Sets the camera is inside (or nearly) are never tested: the box
+    // faces would be clipped away and the query would report nothing
+    void forceVisible(int g) { state[g].visible = true; }
+
+    // Wrap the bounding-box draw; `conditional` = the set is drawn under it next
+    void beginTest(int g, bool conditional) {
+        glBeginQuery(GL_ANY_SAMPLES_PASSED, queries[g]);
+        state[g].conditional = conditional;
+        state[g].wrapped = conditional;
+        state[g].conditionalTriangles = 0;
+    }
+
+    void endTest(int g) {
+        glEndQuery(GL_ANY_SAMPLES_PASSED);
+        state[g].pending = true;
+    }
+
+    void beginConditional(int g) { glBeginConditionalRender(queries[g], GL_QUERY_WAIT); }
+    void endConditional() { glEndConditionalRender(); }
+
+    // Triangles submitted under the set's current conditional render
+    void addConditionalTriangles(int g, int64_t tris) { state[g].conditionalTriangles += tris; }
+
+    // Drawn under its query this frame: later passes (glass parts) wrap the same way
+    bool conditionalThisFrame(int g) const { return state[g].wrapped; }
+
+private:
+    struct SetState {
+        bool visible = true;
+        bool pending = false;
+        bool conditional = false;   // last query guarded a draw
+        bool wrapped = false;       // ... issued this frame
+        int64_t conditionalTriangles = 0;
+    };
+
+    std::vector<GLuint> queries;
+    std::vector<SetState> state;
+};
+#endif
@@ -0,0 +1,217 @@
+#ifndef HLOD_H
+#define HLOD_H
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "Bounds.h"
+#include "Ecs.h"
+#include "Mesh.h"
+
+// ======================================================
+// Hierarchical LOD
+// Far away, a table set is one merged proxy instead of ~40 part draws, and
+// a pavilion's whole furniture group is one more. Proxies are built once per
+// load: each part becomes its transformed bounding box (24 vertices, 12
+// triangles) in world space, coloured by one texel of a material atlas.
+// Pavilion proxies leave out the small parts (legs, crockery).
+// Selection is by projected size, parent first, with some hysteresis:
+//   pavilion under kPavilionPixels -> pavilion proxy
+//   else set under kSetPixels      -> set proxy
+//   else                           -> detailed parts
+// Swapped-out entities carry ENT_REPLACED; culling skips them.
+// ======================================================
+class Hlod {
+public:
+    static constexpr float kSetPixels = 150.0f;
+    static constexpr float kPavilionPixels = 360.0f;
+    static constexpr float kHysteresis = 1.15f;        // switch back only above threshold * this
+    static constexpr float kMinPavilionPartVolume = 0.03f;
+
+    struct Material {
+        glm::vec4 color;
+        unsigned int texture;
+    };
+
+    struct Cluster {
+        Aabb bounds;
+        std::vector<int> members;   // set: its entities; pavilion: its set indices
+        int parent = -1;            // pavilion of a set, -1 if none
+        int proxy = -1;             // proxy entity
+        bool useProxy = false;
+        MeshData mesh;              // until uploaded
+    };
+
+    std::vector<Cluster> sets;
+    std::vector<Cluster> pavilions;
+    std::vector<Material> materials;    // atlas texel i = materials[i]
+
+    bool empty() const { return sets.empty(); }
+
+    // Proxy choices (the hysteresis state), so a second view can select
+    // without disturbing the main one
+    std::vector<char> saveSelection() const {
+        std::vector<char> used;
+        for (const Cluster& c : pavilions) used.push_back(c.useProxy);
+        for (const Cluster& c : sets) used.push_back(c.useProxy);
+        return used;
+    }
+
+    void restoreSelection(const std::vector<char>& used) {
+        size_t i = 0;
+        for (Cluster& c : pavilions) c.useProxy = used[i++] != 0;
+        for (Cluster& c : sets) c.useProxy = used[i++] != 0;
+    }
+
+    void clear() {
+        sets.clear();
+        pavilions.clear();
+        materials.clear();
+    }
+
+    // Groups table set parts (`group` >= 0) into set clusters and sets into
+    // pavilions by cell; fills every cluster's proxy mesh. Only built-in
+    // primitives are merged, other meshes in a set are swapped out with it.
+    void build(const EntityStore& s, int primitiveMeshes, const std::function<int(const Aabb&)>& cellOf) {
+        clear();
+        std::vector<int> partMaterial(s.size(), -1);
+        for (int e = 0; e < s.size(); ++e) {
+            int g = s.group[e];
+            if (g < 0) continue;
+            if (g >= (int)sets.size()) sets.resize(g + 1);
+            sets[g].members.push_back(e);
+            if (s.mesh[e] < primitiveMeshes) partMaterial[e] = materialOf(s.color[e], s.texture[e]);
+        }
+
+        std::vector<int> pavilionOfCell;
+        for (Cluster& set : sets) {
+            bool first = true;
+            for (int e : set.members) {
+                if (partMaterial[e] < 0) continue;
+                if (first) set.bounds = s.bounds[e];
+                else set.bounds.expand(s.bounds[e]);
+                first = false;
+            }
+            if (first) continue;
+
+            int cell = cellOf(set.bounds);
+            if (cell < 0) continue;
+            if (cell >= (int)pavilionOfCell.size()) pavilionOfCell.resize(cell + 1, -1);
+            if (pavilionOfCell[cell] < 0) {
+                pavilionOfCell[cell] = (int)pavilions.size();
+                pavilions.emplace_back();
+                pavilions.back().bounds = set.bounds;
+            }
+            set.parent = pavilionOfCell[cell];
+            pavilions[set.parent].members.push_back(int(&set - sets.data()));
+            pavilions[set.parent].bounds.expand(set.bounds);
+        }
+
+        // A pavilion with a single set would just duplicate the set proxy
+        for (Cluster& p : pavilions)
+            if (p.members.size() < 2)
+                for (int i : p.members) sets[i].parent = -1;
+
+        for (Cluster& set : sets)
+            for (int e : set.members)
+                if (partMaterial[e] >= 0) appendBox(set.mesh, s.world[e], s.localBounds[e], partMaterial[e]);
+        for (Cluster& p : pavilions) {
+            if (p.members.size() < 2) continue;
+            for (int i : p.members)
+                for (int e : sets[i].members) {
+                    if (partMaterial[e] < 0) continue;
+                    glm::vec3 d = s.bounds[e].max - s.bounds[e].min;
+                    if (d.x * d.y * d.z < kMinPavilionPartVolume) continue;
+                    appendBox(p.mesh, s.world[e], s.localBounds[e], partMaterial[e]);
+                }
+        }
+
+        // Texel centres of a one-row atlas
+        float width = (float)std::max<size_t>(materials.size(), 1);
+        for (std::vector<Cluster>* list : { &sets, &pavilions })
+            for (Cluster& c : *list)
+                for (size_t v = 0; v < c.mesh.vertices.size(); v += kVertexStride)
+                    c.mesh.vertices[v + 6] = (c.mesh.vertices[v + 6] + 0.5f) / width;
+    }
+
+    // Picks each cluster's level for this view and sets ENT_REPLACED to
+    // match. pixelScale = viewport height * projection[1][1]. Returns the
+    // number of proxies drawn in place of detail.
+    int select(EntityStore& s, const glm::vec3& eye, float pixelScale, bool enabled) {
+        int proxies = 0;
+        for (Cluster& p : pavilions) {
+            if (p.proxy < 0) continue;
+            p.useProxy = enabled && below(p, eye, pixelScale, kPavilionPixels);
+            setReplaced(s, p.proxy, !p.useProxy);
+            proxies += p.useProxy;
+        }
+        for (Cluster& set : sets) {
+            bool parentProxy = set.parent >= 0 && pavilions[set.parent].useProxy;
+            set.useProxy = set.proxy >= 0 && enabled && !parentProxy && below(set, eye, pixelScale, kSetPixels);
+            if (set.proxy >= 0) setReplaced(s, set.proxy, !set.useProxy);
+            for (int e : set.members) setReplaced(s, e, set.useProxy || parentProxy);
+            proxies += set.useProxy;
+        }
+        return proxies;
+    }
+
+private:
+    int materialOf(const glm::vec4& color, unsigned int texture) {
+        for (size_t i = 0; i < materials.size(); ++i)
+            if (materials[i].color == color && materials[i].texture == texture) return (int)i;
+        materials.push_back({ color, texture });
+        return (int)materials.size() - 1;
+    }
+
+    // Projected diameter in pixels; a proxy stays until the cluster grows
+    // past the threshold by the hysteresis factor
+    static bool below(const Cluster& c, const glm::vec3& eye, float pixelScale, float threshold) {
+        float radius = glm::length(c.bounds.extent());
+        float dist = glm::length(c.bounds.center() - eye);
+        if (dist <= radius) return false;
+        float pixels = radius * pixelScale / dist;
+        return pixels < (c.useProxy ? threshold * kHysteresis : threshold);
+    }
+
+    static void setReplaced(EntityStore& s, int e, bool replaced) {
+        s.flags[e] = replaced ? (s.flags[e] | ENT_REPLACED) : (s.flags[e] & ~ENT_REPLACED);
+    }
+
+    // Part box as 6 flat quads; u holds the material index until build() ends
+    static void appendBox(MeshData& m, const glm::mat4& world, const Aabb& local, int material) {
+        glm::vec3 corner[8];
+        for (int i = 0; i < 8; ++i) {
+            glm::vec3 p((i & 1) ? local.max.x : local.min.x, (i & 2) ? local.max.y : local.min.y, (i & 4) ? local.max.z : local.min.z);
+            corner[i] = glm::vec3(world * glm::vec4(p, 1.0f));
+        }
+        glm::vec3 center = glm::vec3(world * glm::vec4(local.center(), 1.0f));
+
+        static const int faces[6][4] = {
+            { 0, 2, 6, 4 }, { 1, 5, 7, 3 },     // -x, +x
+            { 0, 4, 5, 1 }, { 2, 3, 7, 6 },     // -y, +y
+            { 0, 1, 3, 2 }, { 4, 6, 7, 5 }      // -z, +z
+        };
+        for (const int* f : faces) {
+            glm::vec3 a = corner[f[0]], b = corner[f[1]], c = corner[f[2]], d = corner[f[3]];
+            glm::vec3 n = glm::cross(c - a, d - b);
+            float len = glm::length(n);
+            if (len < 1e-12f) continue;     // flattened part
+            n /= len;
+            bool flip = glm::dot(n, (a + c) * 0.5f - center) < 0.0f;
+            if (flip) n = -n;
+
+            unsigned int base = (unsigned int)m.vertexCount();
+            for (const glm::vec3& p : { a, b, c, d }) {
+                const float v[kVertexStride] = { p.x, p.y, p.z, n.x, n.y, n.z, (float)material, 0.5f };
+                m.vertices.insert(m.vertices.end(), v, v + kVertexStride);
+            }
+            static const unsigned int front[6] = { 0, 1, 2, 0, 2, 3 }, back[6] = { 0, 2, 1, 0, 3, 2 };
+            const unsigned int* order = flip ? back : front;
+            for (int i = 0; i < 6; ++i) m.indices.push_back(base + order[i]);
+        }
+    }
+};
+#endif
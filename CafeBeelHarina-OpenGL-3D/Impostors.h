@@ -0,0 +1,320 @@
+#ifndef IMPOSTORS_H
+#define IMPOSTORS_H
+
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "Bounds.h"
+#include "Ecs.h"
+#include "SceneGraph.h"
+
+// ======================================================
+// Octahedral view directions
+// The unit sphere folded onto a square: upper hemisphere in the centre
+// diamond, lower one in the corners. Frame (i, j) of an N x N atlas was
+// rendered from octDecode((i + 0.5) / N, (j + 0.5) / N).
+// ======================================================
+inline glm::vec2 octEncode(const glm::vec3& d) {
+    glm::vec3 n = d / (std::fabs(d.x) + std::fabs(d.y) + std::fabs(d.z));
+    glm::vec2 p(n.x, n.z);
+    if (n.y < 0.0f)
+        p = glm::vec2((1.0f - std::fabs(n.z)) * (n.x >= 0.0f ? 1.0f : -1.0f),
+                      (1.0f - std::fabs(n.x)) * (n.z >= 0.0f ? 1.0f : -1.0f));
+    return p * 0.5f + 0.5f;
+}
+
+inline glm::vec3 octDecode(const glm::vec2& uv) {
+    glm::vec2 f = uv * 2.0f - 1.0f;
+    glm::vec3 n(f.x, 1.0f - std::fabs(f.x) - std::fabs(f.y), f.y);
+    float t = std::max(-n.y, 0.0f);
+    n.x += n.x >= 0.0f ? -t : t;
+    n.z += n.z >= 0.0f ? -t : t;
+    return glm::normalize(n);
+}
+
+// Screen axes of a frame looking back along -dir; shared by the bake and the quads
+inline void impostorBasis(const glm::vec3& dir, glm::vec3& right, glm::vec3& up) {
+    glm::vec3 hint = std::fabs(dir.y) > 0.99f ? glm::vec3(0.0f, 0.0f, -1.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+    right = glm::normalize(glm::cross(hint, dir));
+    up = glm::cross(dir, right);
+}
+
+// ======================================================
+// Impostors for far table sets
+// Sets with the same parts in the same place relative to their frame node
+// share a group; each group is baked once (see bakeImpostors in main.cpp)
+// from kFrames x kFrames octahedral directions into one layer of a texture
+// array. Far sets become camera-facing quads showing the nearest frame,
+// all in one instanced draw. Between kFadePixels and kFullPixels parts and
+// quad are dithered against each other; below that the parts are
+// ENT_REPLACED. Parts that do not turn with the frame (crockery) are not
+// baked and are dropped with the rest at full impostor range.
+// ======================================================
+class Impostors {
+public:
+    static const int kFrames = 12;
+    static const int kFrameSize = 64;
+    static const int kAtlasSize = kFrames * kFrameSize;
+    static const int kMaxGroups = 16;               // atlas layers
+    static constexpr float kFadePixels = 96.0f;     // crossfade starts (projected diameter)
+    static constexpr float kFullPixels = 64.0f;     // impostor only
+
+    struct Group {
+        int set = -1;               // set it is baked from
+        glm::vec3 center;           // in the frame node's space
+        float radius = 0.0f;
+    };
+
+    struct SetInfo {
+        int group = -1;             // -1: no impostor
+        glm::mat4 frame;            // frame node, scale removed
+        std::vector<int> parts;     // baked parts, entity order
+        std::vector<int> others;    // members not in the bake
+    };
+
+    struct Instance {
+        glm::vec4 centerRadius;
+        glm::vec4 rightLayer;       // xyz: quad right axis, w: atlas layer
+        glm::vec4 upFade;           // xyz: quad up axis, w: crossfade
+        glm::vec2 frameUv;          // lower-left corner of the frame
+    };
+
+    std::vector<Group> groups;
+    std::vector<SetInfo> sets;      // by table set index
+    std::vector<Instance> instances;    // this frame's quads
+    unsigned int atlas = 0;         // GL_TEXTURE_2D_ARRAY
+    bool baked = false;
+    double bakeMs = 0.0;
+
+    bool empty() const { return groups.empty(); }
+
+    float fadeOf(int set) const { return set >= 0 && set < (int)fade.size() ? fade[set] : 0.0f; }
+
+    // Groups table sets by their parts relative to the frame node of their
+    // largest part. Only built-in primitives are baked.
+    void build(const EntityStore& s, const SceneGraph& graph, int primitiveMeshes) {
+        groups.clear();
+        sets.clear();
+        fade.clear();
+        baked = false;
+
+        std::vector<std::vector<int>> members;
+        for (int e = 0; e < s.size(); ++e) {
+            int g = s.group[e];
+            if (g < 0) continue;
+            if (g >= (int)members.size()) members.resize(g + 1);
+            members[g].push_back(e);
+        }
+        sets.resize(members.size());
+
+        for (size_t g = 0; g < members.size(); ++g) {
+            SetInfo& set = sets[g];
+            int largest = -1;
+            float largestVolume = 0.0f;
+            for (int e : members[g]) {
+                if (s.mesh[e] >= primitiveMeshes || s.node[e] < 0) continue;
+                glm::vec3 d = s.bounds[e].max - s.bounds[e].min;
+                if (largest < 0 || d.x * d.y * d.z > largestVolume) {
+                    largest = e;
+                    largestVolume = d.x * d.y * d.z;
+                }
+            }
+            if (largest < 0) {
+                set.others = members[g];
+                continue;
+            }
+
+            int frameNode = graph.parent(s.node[largest]);
+            if (frameNode < 0) frameNode = s.node[largest];
+            set.frame = graph.world(frameNode);
+            for (int c = 0; c < 3; ++c) set.frame[c] = glm::normalize(set.frame[c]);
+
+            for (int e : members[g]) {
+                bool inBake = s.mesh[e] < primitiveMeshes && descends(graph, s.node[e], frameNode);
+                (inBake ? set.parts : set.others).push_back(e);
+            }
+
+            for (size_t k = 0; k < groups.size(); ++k)
+                if (sameParts(s, sets[groups[k].set], set)) {
+                    set.group = (int)k;
+                    break;
+                }
+            if (set.group >= 0 || (int)groups.size() >= kMaxGroups) continue;
+
+            glm::mat4 toFrame = glm::inverse(set.frame);
+            Aabb b = transformAabb(s.localBounds[set.parts[0]], toFrame * s.world[set.parts[0]]);
+            for (int e : set.parts) b.expand(transformAabb(s.localBounds[e], toFrame * s.world[e]));
+            Group grp;
+            grp.set = (int)g;
+            grp.center = b.center();
+            grp.radius = glm::length(b.extent());
+            set.group = (int)groups.size();
+            groups.push_back(grp);
+        }
+        fade.assign(sets.size(), 0.0f);
+    }
+
+    // Crossfade per set and this frame's quads. Call after Hlod::select():
+    // it only adds ENT_REPLACED, never clears it.
+    int select(EntityStore& s, const glm::vec3& eye, float pixelScale, const Frustum& frustum, bool enabled) {
+        instances.clear();
+        std::fill(fade.begin(), fade.end(), 0.0f);
+        if (!enabled || !baked) return 0;
+
+        for (size_t g = 0; g < sets.size(); ++g) {
+            const SetInfo& set = sets[g];
+            if (set.group < 0) continue;
+            const Group& grp = groups[set.group];
+
+            glm::vec3 c = glm::vec3(set.frame * glm::vec4(grp.center, 1.0f));
+            float dist = glm::length(c - eye);
+            if (dist <= grp.radius) continue;
+            float pixels = grp.radius * pixelScale / dist;
+            float t = glm::clamp((kFadePixels - pixels) / (kFadePixels - kFullPixels), 0.0f, 1.0f);
+            if (t <= 0.0f) continue;
+
+            fade[g] = t;
+            if (t >= 1.0f) {
+                for (int e : set.parts) s.flags[e] |= ENT_REPLACED;
+                for (int e : set.others) s.flags[e] |= ENT_REPLACED;
+            }
+
+            Aabb b;
+            b.min = c - glm::vec3(grp.radius);
+            b.max = c + glm::vec3(grp.radius);
+            if (!frustum.intersects(b)) continue;
+
+            // Nearest baked direction, in the frame node's space
+            glm::mat3 rot(set.frame);
+            glm::vec2 uv = octEncode(glm::transpose(rot) * ((eye - c) / dist));
+            int fx = std::min((int)(uv.x * kFrames), kFrames - 1);
+            int fy = std::min((int)(uv.y * kFrames), kFrames - 1);
+            glm::vec3 dir = octDecode((glm::vec2((float)fx, (float)fy) + 0.5f) / (float)kFrames);
+            glm::vec3 right, up;
+            impostorBasis(dir, right, up);
+
+            Instance in;
+            in.centerRadius = glm::vec4(c, grp.radius);
+            in.rightLayer = glm::vec4(rot * right, (float)set.group);
+            in.upFade = glm::vec4(rot * up, t);
+            in.frameUv = glm::vec2((float)fx, (float)fy) / (float)kFrames;
+            instances.push_back(in);
+        }
+        return (int)instances.size();
+    }
+
+    // Orthographic camera for frame (fx, fy) of a group, in the frame node's space
+    void frameView(int group, int fx, int fy, glm::mat4& view, glm::mat4& projection) const {
+        const Group& grp = groups[group];
+        glm::vec3 dir = octDecode((glm::vec2((float)fx, (float)fy) + 0.5f) / (float)kFrames);
+        glm::vec3 right, up;
+        impostorBasis(dir, right, up);
+        float r = grp.radius;
+        view = glm::lookAt(grp.center + dir * (2.0f * r), grp.center, up);
+        projection = glm::ortho(-r, r, -r, r, 0.01f * r, 4.0f * r);
+    }
+
+    // ---------- GL ----------
+    void initGL() {
+        if (vao) return;
+        const float corners[] = { -1.0f, -1.0f, 1.0f, -1.0f, -1.0f, 1.0f, 1.0f, 1.0f };
+        glGenVertexArrays(1, &vao);
+        glGenBuffers(1, &quadVbo);
+        glGenBuffers(1, &instanceVbo);
+
+        glBindVertexArray(vao);
+        glBindBuffer(GL_ARRAY_BUFFER, quadVbo);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(corners), corners, GL_STATIC_DRAW);
+        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+        glEnableVertexAttribArray(0);
+
+        glBindBuffer(GL_ARRAY_BUFFER, instanceVbo);
+        const GLsizei stride = sizeof(Instance);
+        glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(Instance, centerRadius));
+        glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(Instance, rightLayer));
+        glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(Instance, upFade));
+        glVertexAttribPointer(4, 2, GL_FLOAT, GL_FALSE, stride, (void*)offsetof(Instance, frameUv));
+        for (int a = 1; a <= 4; ++a) {
+            glEnableVertexAttribArray(a);
+            glVertexAttribDivisor(a, 1);
+        }
+        glBindVertexArray(0);
+    }
+
+    // One layer per group, mipmapped after the bake
+    void allocateAtlas() {
+        if (atlas) glDeleteTextures(1, &atlas);
+        glGenTextures(1, &atlas);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, atlas);
+        glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA8, kAtlasSize, kAtlasSize, std::max(1, (int)groups.size()),
+                     0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, 3);    // frames stay >= 8 px, little bleeding
+    }
+
+    // Instanced quads; the impostor shader must be in use
+    int draw() {
+        if (instances.empty()) return 0;
+        glBindBuffer(GL_ARRAY_BUFFER, instanceVbo);
+        glBufferData(GL_ARRAY_BUFFER, instances.size() * sizeof(Instance), instances.data(), GL_STREAM_DRAW);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, atlas);
+        glBindVertexArray(vao);
+        glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, (GLsizei)instances.size());
+        glBindVertexArray(0);
+        return (int)instances.size();
+    }
+
+    // Drops the groups and the atlas; the quad buffers stay for the next scene
+    void clear() {
+        groups.clear();
+        sets.clear();
+        instances.clear();
+        fade.clear();
+        if (atlas) glDeleteTextures(1, &atlas);
+        atlas = 0;
+        baked = false;
+    }
+
+    void release() {
+        clear();
+        if (vao) glDeleteVertexArrays(1, &vao);
+        if (quadVbo) glDeleteBuffers(1, &quadVbo);
+        if (instanceVbo) glDeleteBuffers(1, &instanceVbo);
+        vao = quadVbo = instanceVbo = 0;
+    }
+
+private:
+    std::vector<float> fade;        // per set: 0 parts only .. 1 impostor only
+    unsigned int vao = 0, quadVbo = 0, instanceVbo = 0;
+
+    static bool descends(const SceneGraph& graph, int node, int ancestor) {
+        for (; node >= 0; node = graph.parent(node))
+            if (node == ancestor) return true;
+        return false;
+    }
+
+    static bool sameParts(const EntityStore& s, const SetInfo& a, const SetInfo& b) {
+        if (a.parts.size() != b.parts.size()) return false;
+        glm::mat4 toA = glm::inverse(a.frame), toB = glm::inverse(b.frame);
+        for (size_t i = 0; i < a.parts.size(); ++i) {
+            int ea = a.parts[i], eb = b.parts[i];
+            if (s.mesh[ea] != s.mesh[eb] || s.color[ea] != s.color[eb] || s.texture[ea] != s.texture[eb]) return false;
+            glm::mat4 ra = toA * s.world[ea], rb = toB * s.world[eb];
+            for (int c = 0; c < 4; ++c)
+                for (int r = 0; r < 4; ++r)
+                    if (std::fabs(ra[c][r] - rb[c][r]) > 1e-3f) return false;
+        }
+        return true;
+    }
+};
+#endif
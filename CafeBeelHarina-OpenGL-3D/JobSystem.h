@@ -0,0 +1,126 @@
+#ifndef JOB_SYSTEM_H
+#define JOB_SYSTEM_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+// ======================================================
+// Small worker pool shared by CPU-side systems
+// - submit(fn)            : run fn on a worker, returns a std::future
+// - parallelFor(n, g, fn) : split [0, n) into chunks of ~g items, calling
+//                           fn(begin, end); the caller helps and blocks
+// ======================================================
+class JobSystem {
+public:
+    explicit JobSystem(unsigned int threadCount = 0) {
+        if (threadCount == 0) {
+            unsigned int hw = std::thread::hardware_concurrency();
+            threadCount = hw > 1 ? hw - 1 : 1;     // leave a core for the render thread
+        }
+        for (unsigned int i = 0; i < threadCount; ++i)
+            workers.emplace_back([this] { workerLoop(); });
+    }
+
+    ~JobSystem() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (auto& t : workers) t.join();
+    }
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    static JobSystem& instance() {
+        static JobSystem pool;
+        return pool;
+    }
+
+    int workerCount() const { return (int)workers.size(); }
+
+    template <class F>
+    auto submit(F&& fn) -> std::future<decltype(fn())> {
+        using R = decltype(fn());
+        auto task = std::make_shared<std::packaged_task<R()>>(std::forward<F>(fn));
+        std::future<R> result = task->get_future();
+        push([task] { (*task)(); });
+        return result;
+    }
+
+    void parallelFor(int count, int grain, const std::function<void(int, int)>& fn) {
+        if (count <= 0) return;
+        grain = std::max(grain, 1);
+        int chunks = (count + grain - 1) / grain;
+        if (chunks == 1 || workers.empty()) { fn(0, count); return; }
+
+        // Shared so a helper that is dequeued after we return only touches
+        // the counters (it finds no chunk left and never calls fn)
+        struct Batch {
+            std::atomic<int> next{ 0 };
+            std::atomic<int> done{ 0 };
+            std::mutex m;
+            std::condition_variable cv;
+        };
+        auto batch = std::make_shared<Batch>();
+        const std::function<void(int, int)>* body = &fn;
+
+        auto runChunks = [batch, body, chunks, grain, count] {
+            int c;
+            while ((c = batch->next.fetch_add(1)) < chunks) {
+                int begin = c * grain;
+                (*body)(begin, std::min(begin + grain, count));
+                if (batch->done.fetch_add(1) + 1 == chunks) {
+                    std::lock_guard<std::mutex> lock(batch->m);
+                    batch->cv.notify_all();
+                }
+            }
+        };
+
+        int helpers = std::min(chunks - 1, workerCount());
+        for (int i = 0; i < helpers; ++i) push(runChunks);
+        runChunks();
+
+        std::unique_lock<std::mutex> lock(batch->m);
+        batch->cv.wait(lock, [&] { return batch->done.load() == chunks; });
+    }
+
+private:
+    void push(std::function<void()> job) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            jobs.push(std::move(job));
+        }
+        wake.notify_one();
+    }
+
+    void workerLoop() {
+        for (;;) {
+            std::function<void()> job;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [&] { return stopping || !jobs.empty(); });
+                if (stopping && jobs.empty()) return;
+                job = std::move(jobs.front());
+                jobs.pop();
+            }
+            job();
+        }
+    }
+
+    std::vector<std::thread> workers;
+    std::queue<std::function<void()>> jobs;
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool stopping = false;
+};
+#endif
@@ -0,0 +1,165 @@
+#ifndef JSON_H
+#define JSON_H
+
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+// ======================================================
+// Minimal read-only JSON DOM (enough for glTF 2.0 headers)
+// ======================================================
+class JsonValue {
+public:
+    enum Type { NUL, BOOL, NUMBER, STRING, ARRAY, OBJECT };
+
+    Type type = NUL;
+    bool boolean = false;
+    double number = 0.0;
+    std::string str;
+    std::vector<JsonValue> items;                               // ARRAY
+    std::vector<std::pair<std::string, JsonValue>> members;     // OBJECT
+
+    bool isNull() const { return type == NUL; }
+    bool isArray() const { return type == ARRAY; }
+    bool isObject() const { return type == OBJECT; }
+    size_t size() const { return type == ARRAY ? items.size() : members.size(); }
+
+    const JsonValue& operator[](size_t i) const { return i < items.size() ? items[i] : null(); }
+    const JsonValue& operator[](int i) const { return i < 0 ? null() : (*this)[(size_t)i]; }
+    const JsonValue& operator[](const char* key) const {
+        for (const auto& m : members)
+            if (m.first == key) return m.second;
+        return null();
+    }
+    bool has(const char* key) const { return !(*this)[key].isNull(); }
+
+    double asNumber(double fallback = 0.0) const { return type == NUMBER ? number : fallback; }
+    int asInt(int fallback = 0) const { return type == NUMBER ? (int)number : fallback; }
+    const std::string& asString() const { return str; }
+
+    static const JsonValue& null() {
+        static const JsonValue n;
+        return n;
+    }
+
+    // Parses [text, text + len). Returns false and fills error on malformed input.
+    static bool parse(const char* text, size_t len, JsonValue& out, std::string& error) {
+        Parser p{ text, text + len, error };
+        p.skipWs();
+        if (!p.value(out, 0)) return false;
+        p.skipWs();
+        return true;
+    }
+
+private:
+    struct Parser {
+        const char* p;
+        const char* end;
+        std::string& error;
+
+        bool fail(const char* msg) { error = msg; return false; }
+
+        void skipWs() { while (p < end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r')) ++p; }
+
+        bool literal(const char* word) {
+            size_t n = strlen(word);
+            if ((size_t)(end - p) < n || strncmp(p, word, n) != 0) return false;
+            p += n;
+            return true;
+        }
+
+        bool value(JsonValue& v, int depth) {
+            if (depth > 64) return fail("JSON nested too deeply");
+            skipWs();
+            if (p >= end) return fail("unexpected end of JSON");
+
+            char c = *p;
+            if (c == '{') return object(v, depth);
+            if (c == '[') return array(v, depth);
+            if (c == '"') { v.type = STRING; return string(v.str); }
+            if (literal("true")) { v.type = BOOL; v.boolean = true; return true; }
+            if (literal("false")) { v.type = BOOL; v.boolean = false; return true; }
+            if (literal("null")) { v.type = NUL; return true; }
+
+            // number: strtod needs a terminated buffer
+            char buf[64];
+            size_t n = 0;
+            while (p + n < end && n < sizeof(buf) - 1 && strchr("+-0123456789.eE", p[n])) { buf[n] = p[n]; ++n; }
+            if (n == 0) return fail("unexpected character in JSON");
+            buf[n] = '\0';
+            v.type = NUMBER;
+            v.number = strtod(buf, nullptr);
+            p += n;
+            return true;
+        }
+
+        bool string(std::string& s) {
+            ++p; // opening quote
+            while (p < end && *p != '"') {
+                if (*p == '\\' && p + 1 < end) {
+                    ++p;
+                    switch (*p) {
+                    case 'n': s += '\n'; break;
+                    case 't': s += '\t'; break;
+                    case 'r': s += '\r'; break;
+                    case 'b': s += '\b'; break;
+                    case 'f': s += '\f'; break;
+                    case 'u': {
+                        // keep ASCII, replace anything else (names only, never used as paths here)
+                        unsigned code = (p + 4 < end) ? (unsigned)strtoul(std::string(p + 1, 4).c_str(), nullptr, 16) : '?';
+                        s += code < 0x80 ? (char)code : '?';
+                        p += 4;
+                        break;
+                    }
+                    default: s += *p; break;
+                    }
+                    ++p;
+                }
+                else s += *p++;
+            }
+            if (p >= end) return fail("unterminated JSON string");
+            ++p; // closing quote
+            return true;
+        }
+
+        bool array(JsonValue& v, int depth) {
+            v.type = ARRAY;
+            ++p;
+            skipWs();
+            if (p < end && *p == ']') { ++p; return true; }
+            for (;;) {
+                v.items.emplace_back();
+                if (!value(v.items.back(), depth + 1)) return false;
+                skipWs();
+                if (p < end && *p == ',') { ++p; continue; }
+                if (p < end && *p == ']') { ++p; return true; }
+                return fail("expected , or ] in JSON array");
+            }
+        }
+
+        bool object(JsonValue& v, int depth) {
+            v.type = OBJECT;
+            ++p;
+            skipWs();
+            if (p < end && *p == '}') { ++p; return true; }
+            for (;;) {
+                skipWs();
+                if (p >= end || *p != '"') return fail("expected key in JSON object");
+                std::string key;
+                if (!string(key)) return false;
+                skipWs();
+                if (p >= end || *p != ':') return fail("expected : in JSON object");
+                ++p;
+                v.members.emplace_back(std::move(key), JsonValue());
+                if (!value(v.members.back().second, depth + 1)) return false;
+                skipWs();
+                if (p < end && *p == ',') { ++p; continue; }
+                if (p < end && *p == '}') { ++p; return true; }
+                return fail("expected , or } in JSON object");
+            }
+        }
+    };
+};
+#endif
@@ -0,0 +1,514 @@
+#ifndef LIGHTMAP_H
+#define LIGHTMAP_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "BVH.h"
+#include "Clustered.h"
+#include "Ecs.h"
+#include "JobSystem.h"
+#include "Shader.h"
+
+#ifndef GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT 0x83F0
+#endif
+
+// ======================================================
+// Baked lighting for the static boxes
+// Every static opaque cube gets six charts in one atlas, a face each,
+// sized by the face's world extent at kTexelsPerMetre. Texel centres sit
+// on the face edges, so bilinear filtering never reads a neighbour's.
+// The cube's second UV set is its box unwrap (face from the normal,
+// position across it): vertex_shader.vs computes it from aPos / aNormal
+// and the draw's six chart rects, so the shared cube mesh stays as it is.
+// Texels are path traced on the job system against the entity BVH, boxes
+// tested exactly in their own space, other meshes as their bounds:
+// kSamples cosine-weighted paths of up to kBounces hits, the bulbs added
+// at every vertex through a shadow ray, sky or river light on escape.
+// Sky and bulb light are separate layers so the bulbs can still go off.
+// Each layer is stored as sqrt(value / range) in DXT1 (4 bits per texel),
+// encoded here; charts start on 4x4 block corners so no block mixes faces.
+// ======================================================
+class Lightmap {
+public:
+    static constexpr int kAtlasWidth = 1024;
+    static constexpr int kMaxHeight = 2048;
+    static constexpr float kTexelsPerMetre = 8.0f;     // halved until the charts fit
+    static constexpr int kMinTexels = 2;                // per face side
+    static constexpr int kMaxTexels = 256;
+    static constexpr int kSamples = 32;                 // paths per texel, a multiple of 4
+    static constexpr int kBounces = 2;
+    static constexpr float kSkyRange = 1.0f;            // largest value each layer stores
+    static constexpr float kBulbRange = 2.0f;
+    static constexpr float kOffset = 1e-3f;             // ray origins off the surface, metres
+
+    bool baked = false;
+    bool compressed = false;    // DXT1, or RGB8 where S3TC is missing
+    int charts = 0;             // boxes lightmapped
+    int texels = 0;             // in use, both layers alike
+    int height = 0;             // atlas rows
+    float density = 0.0f;       // texels per metre used
+    double bakeMs = 0.0;
+    size_t gpuBytes = 0;
+
+    // Sky and bulbs on units firstUnit, firstUnit + 1
+    void bind(const Shader& shader, int firstUnit, bool bulbs) const {
+        for (int i = 0; i < 2; ++i) {
+            glActiveTexture(GL_TEXTURE0 + firstUnit + i);
+            glBindTexture(GL_TEXTURE_2D, textures[i]);
+        }
+        glActiveTexture(GL_TEXTURE0);
+        shader.setInt("uLightmapSky", firstUnit);
+        shader.setInt("uLightmapBulbs", firstUnit + 1);
+        shader.setV2("uLightmapRange", glm::vec2(kSkyRange, bulbs ? kBulbRange : 0.0f));
+    }
+
+    // The six face rects for the cube shader (xy: first texel centre,
+    // zw: span to the last), or nullptr when e has no charts
+    const glm::vec4* rectsOf(int e) const {
+        if (e >= (int)chartOf.size() || chartOf[e] < 0) return nullptr;
+        return rects[chartOf[e]].data();
+    }
+
+    // Charts, path tracing and upload. bulbs: world lights, as drawn.
+    // Entities of mesh cubeMesh are charted; meshes from firstBatchMesh on
+    // (merged batches) neither receive nor block light, their bounds being
+    // far larger than their geometry.
+    bool bake(const EntityStore& s, const Bvh& bvh, const std::vector<PointLight>& bulbs, int cubeMesh, int firstBatchMesh) {
+        auto start = std::chrono::high_resolution_clock::now();
+        release();
+
+        const unsigned int noLight = ENT_HIDDEN | ENT_TRANSPARENT | ENT_LIGHT | ENT_BAKED;
+        std::vector<int> boxes;
+        occluder.assign(s.size(), 0);
+        toLocal.resize(s.size());
+        for (int e = 0; e < s.size(); ++e) {
+            if ((s.flags[e] & noLight) || s.mesh[e] >= firstBatchMesh) continue;
+            occluder[e] = 1;
+            toLocal[e] = glm::inverse(s.world[e]);
+            if (s.mesh[e] == cubeMesh && (s.flags[e] & ENT_STATIC)) boxes.push_back(e);
+        }
+        if (boxes.empty() || bvh.empty()) return false;
+
+        for (density = kTexelsPerMetre; !layout(s, boxes, density); density *= 0.5f)
+            if (density < 0.05f) return false;
+
+        // One job per texel row of a face: faces range from 2x2 to 256x256
+        store = &s;
+        tree = &bvh;
+        lights = &bulbs;
+        sky.assign((size_t)kAtlasWidth * height, glm::vec3(0.0f));
+        bulb.assign(sky.size(), glm::vec3(0.0f));
+        covered.assign(sky.size(), 0);
+        std::vector<glm::ivec2> rows;
+        for (int f = 0; f < (int)faces.size(); ++f)
+            for (int j = 0; j < faces[f].h; ++j) rows.push_back(glm::ivec2(f, j));
+        JobSystem::instance().parallelFor((int)rows.size(), 4, [&](int r0, int r1) {
+            for (int r = r0; r < r1; ++r) bakeRow(rows[r].x, rows[r].y);
+        });
+
+        upload();
+        sky.clear();
+        bulb.clear();
+        covered.clear();
+        sky.shrink_to_fit();
+        bulb.shrink_to_fit();
+        covered.shrink_to_fit();
+        store = nullptr;
+        tree = nullptr;
+        lights = nullptr;
+        charts = (int)boxes.size();
+        baked = true;
+        bakeMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+        return true;
+    }
+
+    void release() {
+        if (textures[0]) glDeleteTextures(2, textures);
+        textures[0] = textures[1] = 0;
+        chartOf.clear();
+        rects.clear();
+        faces.clear();
+        baked = compressed = false;
+        charts = texels = height = 0;
+        gpuBytes = 0;
+    }
+
+private:
+    struct Face {
+        int entity, face;       // face = axis * 2 + (1 on the negative side)
+        int x, y, w, h;         // texels in the atlas
+    };
+
+    unsigned int textures[2] = {};
+    std::vector<int> chartOf;                       // per entity, -1: not lightmapped
+    std::vector<std::array<glm::vec4, 6>> rects;
+    std::vector<Face> faces;
+
+    // Bake state
+    const EntityStore* store = nullptr;
+    const Bvh* tree = nullptr;
+    const std::vector<PointLight>* lights = nullptr;
+    std::vector<char> occluder;
+    std::vector<glm::mat4> toLocal;
+    std::vector<glm::vec3> sky, bulb;
+    std::vector<char> covered;
+
+    // Axes across face axis a, in the order the vertex shader reads them
+    static int uAxis(int a) { return a == 0 ? 1 : 0; }
+    static int vAxis(int a) { return a == 2 ? 1 : 2; }
+
+    static int align4(int v) { return (v + 3) & ~3; }
+
+    // Inverse transpose of m up to a scale
+    static glm::mat3 cofactor(const glm::mat4& m) {
+        glm::vec3 c0(m[0]), c1(m[1]), c2(m[2]);
+        return glm::mat3(glm::cross(c1, c2), glm::cross(c2, c0), glm::cross(c0, c1));
+    }
+
+    // Shelf packing, tallest faces first; false when the atlas overflows
+    bool layout(const EntityStore& s, const std::vector<int>& boxes, float texelsPerMetre) {
+        faces.clear();
+        for (int e : boxes) {
+            glm::vec3 size = s.localBounds[e].extent() * 2.0f;
+            float len[3];
+            for (int a = 0; a < 3; ++a) len[a] = glm::length(glm::vec3(s.world[e][a])) * size[a];
+            for (int f = 0; f < 6; ++f) {
+                int a = f / 2;
+                Face face;
+                face.entity = e;
+                face.face = f;
+                face.w = std::min(std::max((int)std::ceil(len[uAxis(a)] * texelsPerMetre) + 1, kMinTexels), kMaxTexels);
+                face.h = std::min(std::max((int)std::ceil(len[vAxis(a)] * texelsPerMetre) + 1, kMinTexels), kMaxTexels);
+                face.x = face.y = 0;
+                faces.push_back(face);
+            }
+        }
+        std::vector<int> order(faces.size());
+        for (int i = 0; i < (int)order.size(); ++i) order[i] = i;
+        std::sort(order.begin(), order.end(), [&](int a, int b) { return faces[a].h > faces[b].h; });
+
+        int x = 0, y = 0, shelf = 0;
+        for (int i : order) {
+            Face& f = faces[i];
+            if (x + align4(f.w) > kAtlasWidth) {
+                x = 0;
+                y += shelf;
+                shelf = 0;
+            }
+            f.x = x;
+            f.y = y;
+            x += align4(f.w);
+            shelf = std::max(shelf, align4(f.h));
+        }
+        height = y + shelf;     // a multiple of 4, like every shelf
+        if (height > kMaxHeight) return false;
+
+        chartOf.assign(s.size(), -1);
+        rects.assign(boxes.size(), std::array<glm::vec4, 6>());
+        for (int b = 0; b < (int)boxes.size(); ++b) chartOf[boxes[b]] = b;
+        texels = 0;
+        for (const Face& f : faces) {
+            rects[chartOf[f.entity]][f.face] = glm::vec4((f.x + 0.5f) / kAtlasWidth, (f.y + 0.5f) / height,
+                (f.w - 1.0f) / kAtlasWidth, (f.h - 1.0f) / height);
+            texels += f.w * f.h;
+        }
+        return true;
+    }
+
+    // ---------- path tracing ----------
+    struct Rng {
+        uint32_t state;
+        float next() {
+            state ^= state << 13;
+            state ^= state >> 17;
+            state ^= state << 5;
+            return (state >> 8) * (1.0f / 16777216.0f);
+        }
+    };
+
+    // Cosine-weighted direction about n
+    static glm::vec3 cosineSample(const glm::vec3& n, Rng& rng) {
+        float phi = 6.2831853f * rng.next(), r2 = rng.next(), r = std::sqrt(r2);
+        float sign = n.z >= 0.0f ? 1.0f : -1.0f;        // orthonormal basis (Duff et al.)
+        float a = -1.0f / (sign + n.z), b = n.x * n.y * a;
+        glm::vec3 t(1.0f + sign * n.x * n.x * a, sign * b, -sign * n.x);
+        glm::vec3 bt(b, sign + n.y * n.y * a, -n.y);
+        return t * (r * std::cos(phi)) + bt * (r * std::sin(phi)) + n * std::sqrt(std::max(0.0f, 1.0f - r2));
+    }
+
+    // Light arriving from an escaped direction: sky above, lit river below
+    static glm::vec3 skyLight(const glm::vec3& dir) {
+        return dir.y >= 0.0f ? glm::vec3(1.0f) : glm::vec3(0.3f, 0.36f, 0.4f);
+    }
+
+    // Ray against entity e in its own space (affine, so t carries over)
+    float hitEntity(int e, const glm::vec3& origin, const glm::vec3& dir) const {
+        if (!occluder[e]) return FLT_MAX;
+        const glm::mat4& m = toLocal[e];
+        glm::vec3 o = glm::vec3(m * glm::vec4(origin, 1.0f)), d = glm::mat3(m) * dir;
+        const Aabb& b = store->localBounds[e];
+        float lo = 0.0f, hi = FLT_MAX;
+        for (int a = 0; a < 3; ++a) {
+            float inv = 1.0f / (std::fabs(d[a]) > 1e-12f ? d[a] : (d[a] < 0.0f ? -1e-12f : 1e-12f));
+            float t1 = (b.min[a] - o[a]) * inv, t2 = (b.max[a] - o[a]) * inv;
+            lo = std::max(lo, std::min(t1, t2));
+            hi = std::min(hi, std::max(t1, t2));
+        }
+        return lo <= hi ? lo : FLT_MAX;
+    }
+
+    // World normal of entity e's box at a hit, facing the ray
+    glm::vec3 hitNormal(int e, const glm::vec3& point, const glm::vec3& dir) const {
+        const Aabb& b = store->localBounds[e];
+        glm::vec3 q = (glm::vec3(toLocal[e] * glm::vec4(point, 1.0f)) - b.center()) / glm::max(b.extent(), glm::vec3(1e-6f));
+        int a = std::fabs(q.x) > std::fabs(q.y) ? (std::fabs(q.x) > std::fabs(q.z) ? 0 : 2) : (std::fabs(q.y) > std::fabs(q.z) ? 1 : 2);
+        glm::vec3 n(0.0f);
+        n[a] = q[a] < 0.0f ? -1.0f : 1.0f;
+        n = glm::normalize(cofactor(store->world[e]) * n);
+        return glm::dot(n, dir) > 0.0f ? -n : n;
+    }
+
+    void trace(const glm::vec3 origin[4], const glm::vec3 dir[4], const float tMax[4], RayHit hits[4]) const {
+        RayPacket4 rays;
+        for (int k = 0; k < 4; ++k) {
+            rays.origin[k] = origin[k];
+            rays.dir[k] = dir[k];
+            rays.tMax[k] = tMax[k];
+        }
+        tree->trace4(rays, hits, [&](int prim, int k, float) { return hitEntity(prim, origin[k], dir[k]); });
+    }
+
+    // Bulb light reaching p (normal n), shadow rays four at a time
+    glm::vec3 direct(const glm::vec3& p, const glm::vec3& n) const {
+        glm::vec3 sum(0.0f);
+        glm::vec3 origin[4], dir[4], light[4];
+        float tMax[4];
+        int count = 0;
+        auto flush = [&]() {
+            for (int k = count; k < 4; ++k) {
+                origin[k] = p;
+                dir[k] = n;
+                tMax[k] = 0.0f;
+            }
+            RayHit hits[4];
+            trace(origin, dir, tMax, hits);
+            for (int k = 0; k < count; ++k)
+                if (hits[k].prim < 0) sum += light[k];
+            count = 0;
+        };
+        for (const PointLight& l : *lights) {
+            glm::vec3 to = l.position - p;
+            float d = glm::length(to);
+            if (d >= l.radius || d < 1e-4f) continue;
+            float ndotl = glm::dot(n, to) / d;
+            if (ndotl <= 0.0f) continue;
+            float falloff = 1.0f - d / l.radius;
+            origin[count] = p;
+            dir[count] = to / d;
+            tMax[count] = d;
+            light[count] = l.color * (l.intensity * falloff * falloff * ndotl);
+            if (++count == 4) flush();
+        }
+        if (count > 0) flush();
+        return sum;
+    }
+
+    void bakeTexel(const Face& f, int i, int j, glm::vec3& skyOut, glm::vec3& bulbOut) const {
+        const EntityStore& s = *store;
+        int e = f.entity, a = f.face / 2;
+        const Aabb& b = s.localBounds[e];
+
+        // Texel centres span the face; pulled in a little so corner rays
+        // do not start inside a neighbouring box
+        glm::vec3 local = b.center();
+        local[a] = (f.face & 1) ? b.min[a] : b.max[a];
+        int ua = uAxis(a), va = vAxis(a);
+        float su = (float)i / (f.w - 1), sv = (float)j / (f.h - 1);
+        local[ua] = glm::mix(b.min[ua], b.max[ua], glm::mix(0.005f, 0.995f, su));
+        local[va] = glm::mix(b.min[va], b.max[va], glm::mix(0.005f, 0.995f, sv));
+        glm::vec3 nLocal(0.0f);
+        nLocal[a] = (f.face & 1) ? -1.0f : 1.0f;
+        glm::vec3 n = glm::normalize(cofactor(s.world[e]) * nLocal);
+        glm::vec3 p = glm::vec3(s.world[e] * glm::vec4(local, 1.0f)) + n * kOffset;
+
+        Rng rng{ 0x9E3779B9u ^ ((uint32_t)e * 7919u + (uint32_t)f.face * 104729u + (uint32_t)j * 1299709u + (uint32_t)i * 15485863u) };
+        if (rng.state == 0) rng.state = 1;
+        glm::vec3 skySum(0.0f), bulbSum(0.0f);
+        for (int s0 = 0; s0 < kSamples; s0 += 4) {
+            glm::vec3 origin[4], normal[4], dir[4], weight[4];
+            float tMax[4];
+            bool alive[4];
+            for (int k = 0; k < 4; ++k) {
+                origin[k] = p;
+                normal[k] = n;
+                weight[k] = glm::vec3(1.0f);
+                alive[k] = true;
+            }
+            for (int bounce = 0; bounce < kBounces; ++bounce) {
+                for (int k = 0; k < 4; ++k) {
+                    dir[k] = alive[k] ? cosineSample(normal[k], rng) : normal[k];
+                    tMax[k] = alive[k] ? FLT_MAX : 0.0f;
+                }
+                RayHit hits[4];
+                trace(origin, dir, tMax, hits);
+                for (int k = 0; k < 4; ++k) {
+                    if (!alive[k]) continue;
+                    if (hits[k].prim < 0) {
+                        skySum += weight[k] * skyLight(dir[k]);
+                        alive[k] = false;
+                        continue;
+                    }
+                    if (hits[k].t < kOffset) {
+                        alive[k] = false;     // started inside a solid: no light gets here
+                        continue;
+                    }
+                    int hit = hits[k].prim;
+                    glm::vec3 point = origin[k] + dir[k] * hits[k].t;
+                    normal[k] = hitNormal(hit, point, dir[k]);
+                    origin[k] = point + normal[k] * kOffset;
+                    weight[k] *= glm::vec3(s.color[hit]);
+                    bulbSum += weight[k] * direct(origin[k], normal[k]);
+                }
+            }
+        }
+        skyOut = skySum / (float)kSamples;
+        bulbOut = direct(p, n) + bulbSum / (float)kSamples;
+    }
+
+    void bakeRow(int faceIndex, int j) {
+        const Face& f = faces[faceIndex];
+        for (int i = 0; i < f.w; ++i) {
+            size_t t = (size_t)(f.y + j) * kAtlasWidth + f.x + i;
+            bakeTexel(f, i, j, sky[t], bulb[t]);
+            covered[t] = 1;
+        }
+    }
+
+    // ---------- encoding ----------
+    static uint8_t encode(float v, float range) {
+        return (uint8_t)(std::sqrt(std::min(std::max(v / range, 0.0f), 1.0f)) * 255.0f + 0.5f);
+    }
+
+    static uint16_t to565(const int c[3]) {
+        return (uint16_t)(((c[0] * 31 + 127) / 255) << 11 | ((c[1] * 63 + 127) / 255) << 5 | ((c[2] * 31 + 127) / 255));
+    }
+
+    static void from565(uint16_t v, int c[3]) {
+        c[0] = ((v >> 11) & 31) * 255 / 31;
+        c[1] = ((v >> 5) & 63) * 255 / 63;
+        c[2] = (v & 31) * 255 / 31;
+    }
+
+    // One 4x4 block: endpoints from the covered texels' bounding box, inset
+    // by 1/16; every texel takes the nearest of the four palette colours
+    void encodeBlock(const std::vector<uint8_t>& rgb, int bx, int by, uint8_t out[8]) const {
+        int lo[3] = { 255, 255, 255 }, hi[3] = { 0, 0, 0 };
+        bool any = false;
+        for (int y = 0; y < 4; ++y)
+            for (int x = 0; x < 4; ++x) {
+                size_t t = (size_t)(by * 4 + y) * kAtlasWidth + bx * 4 + x;
+                if (!covered[t]) continue;
+                any = true;
+                for (int c = 0; c < 3; ++c) {
+                    lo[c] = std::min(lo[c], (int)rgb[t * 3 + c]);
+                    hi[c] = std::max(hi[c], (int)rgb[t * 3 + c]);
+                }
+            }
+        std::fill(out, out + 8, (uint8_t)0);
+        if (!any) return;
+        for (int c = 0; c < 3; ++c) {
+            int inset = (hi[c] - lo[c]) / 16;
+            lo[c] += inset;
+            hi[c] -= inset;
+        }
+        uint16_t c0 = to565(hi), c1 = to565(lo);
+        if (c0 < c1) std::swap(c0, c1);
+        out[0] = (uint8_t)(c0 & 255);
+        out[1] = (uint8_t)(c0 >> 8);
+        out[2] = (uint8_t)(c1 & 255);
+        out[3] = (uint8_t)(c1 >> 8);
+        if (c0 == c1) return;     // flat block: every index 0
+
+        int palette[4][3];
+        from565(c0, palette[0]);
+        from565(c1, palette[1]);
+        for (int c = 0; c < 3; ++c) {
+            palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+        }
+        uint32_t indices = 0;
+        for (int y = 0; y < 4; ++y)
+            for (int x = 0; x < 4; ++x) {
+                size_t t = (size_t)(by * 4 + y) * kAtlasWidth + bx * 4 + x;
+                int best = 0, bestD = INT32_MAX;
+                for (int k = 0; k < 4; ++k) {
+                    int d = 0;
+                    for (int c = 0; c < 3; ++c) {
+                        int diff = (int)rgb[t * 3 + c] - palette[k][c];
+                        d += diff * diff;
+                    }
+                    if (d < bestD) {
+                        bestD = d;
+                        best = k;
+                    }
+                }
+                indices |= (uint32_t)best << (2 * (y * 4 + x));
+            }
+        for (int k = 0; k < 4; ++k) out[4 + k] = (uint8_t)(indices >> (8 * k));
+    }
+
+    static bool s3tcSupported() {
+        GLint count = 0;
+        glGetIntegerv(GL_NUM_COMPRESSED_TEXTURE_FORMATS, &count);
+        std::vector<GLint> formats(std::max(count, 1));
+        if (count > 0) glGetIntegerv(GL_COMPRESSED_TEXTURE_FORMATS, formats.data());
+        return std::find(formats.begin(), formats.begin() + count, (GLint)GL_COMPRESSED_RGB_S3TC_DXT1_EXT) != formats.begin() + count;
+    }
+
+    void upload() {
+        compressed = s3tcSupported();
+        glGenTextures(2, textures);
+        gpuBytes = 0;
+        const std::vector<glm::vec3>* layers[2] = { &sky, &bulb };
+        const float ranges[2] = { kSkyRange, kBulbRange };
+        for (int l = 0; l < 2; ++l) {
+            std::vector<uint8_t> rgb(sky.size() * 3);
+            for (size_t t = 0; t < sky.size(); ++t)
+                for (int c = 0; c < 3; ++c) rgb[t * 3 + c] = encode((*layers[l])[t][c], ranges[l]);
+
+            glBindTexture(GL_TEXTURE_2D, textures[l]);
+            if (compressed) {
+                int blocksX = kAtlasWidth / 4, blocksY = height / 4;
+                std::vector<uint8_t> blocks((size_t)blocksX * blocksY * 8);
+                JobSystem::instance().parallelFor(blocksY, 4, [&](int y0, int y1) {
+                    for (int by = y0; by < y1; ++by)
+                        for (int bx = 0; bx < blocksX; ++bx) encodeBlock(rgb, bx, by, &blocks[((size_t)by * blocksX + bx) * 8]);
+                });
+                glCompressedTexImage2D(GL_TEXTURE_2D, 0, GL_COMPRESSED_RGB_S3TC_DXT1_EXT, kAtlasWidth, height, 0, (GLsizei)blocks.size(), blocks.data());
+                gpuBytes += blocks.size();
+            }
+            else {
+                glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+                glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB8, kAtlasWidth, height, 0, GL_RGB, GL_UNSIGNED_BYTE, rgb.data());
+                glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+                gpuBytes += rgb.size();
+            }
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        }
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+};
+#endif
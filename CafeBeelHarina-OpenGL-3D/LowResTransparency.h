@@ -0,0 +1,138 @@
+#ifndef LOW_RES_TRANSPARENCY_H
+#define LOW_RES_TRANSPARENCY_H
+
+#include <glad/glad.h>
+
+#include <iostream>
+
+#include "Shader.h"
+
+// ======================================================
+// Transparent pass at 1/2 or 1/4 resolution
+// The frame's depth is copied and reduced to the low resolution (farthest
+// depth of each footprint), the glass is blended into an RGBA16F target
+// there, cleared to (0, 0, 0, 1):
+//   rgb = glass composited over black, a = transmittance
+// and put back over the frame as rgb + frame * a. The upsample weighs the
+// four nearest low-res texels by how close their depth is to the pixel's,
+// so glass does not bleed across the edges of nearer objects.
+// ======================================================
+class LowResTransparency {
+public:
+    unsigned int fbo = 0, color = 0, depth = 0, fullDepth = 0;
+    int width = 0, height = 0;          // low resolution
+    int fullWidth = 0, fullHeight = 0;
+    int scale = 0;
+
+    bool matches(int w, int h, int s) const { return fbo && fullWidth == w && fullHeight == h && scale == s; }
+
+    bool create(int w, int h, int s) {
+        release();
+        fullWidth = w;
+        fullHeight = h;
+        scale = s;
+        width = (w + s - 1) / s;
+        height = (h + s - 1) / s;
+
+        color = texture(width, height, GL_RGBA16F, GL_RGBA, GL_FLOAT);
+        depth = texture(width, height, GL_DEPTH_COMPONENT24, GL_DEPTH_COMPONENT, GL_UNSIGNED_INT);
+        fullDepth = texture(w, h, GL_DEPTH_COMPONENT24, GL_DEPTH_COMPONENT, GL_UNSIGNED_INT);
+
+        glGenFramebuffers(1, &fbo);
+        glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, color, 0);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, depth, 0);
+
+        GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        if (status != GL_FRAMEBUFFER_COMPLETE) {
+            std::cout << "ERROR::LOW_RES_TRANSPARENCY::FRAMEBUFFER_INCOMPLETE: 0x" << std::hex << status << std::dec << std::endl;
+            release();
+            return false;
+        }
+        return true;
+    }
+
+    // Reduces the current framebuffer's depth and redirects drawing into the
+    // low-res target, blending over with no depth writes
+    void begin(Shader& downsample, unsigned int fullscreenVao) {
+        glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &target);
+        glGetIntegerv(GL_VIEWPORT, viewport);
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, (unsigned int)target);
+        glBindTexture(GL_TEXTURE_2D, fullDepth);
+        glCopyTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, 0, 0, fullWidth, fullHeight);
+
+        glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+        glViewport(0, 0, width, height);
+        glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+        glDepthFunc(GL_ALWAYS);
+        glDepthMask(GL_TRUE);
+        downsample.use();
+        downsample.setInt("uDepth", 0);
+        downsample.setInt("uScale", scale);
+        glBindVertexArray(fullscreenVao);
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+        glBindVertexArray(0);
+        glDepthFunc(GL_LESS);
+        glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+
+        const float clear[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+        glClearBufferfv(GL_COLOR, 0, clear);
+        glEnable(GL_BLEND);
+        glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ZERO, GL_ONE_MINUS_SRC_ALPHA);
+        glDepthMask(GL_FALSE);
+    }
+
+    // Back to the frame at full resolution, depth-aware upsample on top
+    void composite(Shader& upsample, unsigned int fullscreenVao, float nearPlane, float farPlane) {
+        glBindFramebuffer(GL_FRAMEBUFFER, (unsigned int)target);
+        glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+        glDepthMask(GL_TRUE);
+        glDisable(GL_DEPTH_TEST);
+        glBlendFunc(GL_ONE, GL_SRC_ALPHA);
+
+        upsample.use();
+        upsample.setInt("uColor", 0);
+        upsample.setInt("uLowDepth", 1);
+        upsample.setInt("uFullDepth", 2);
+        upsample.setInt("uScale", scale);
+        upsample.setV2("uNearFar", glm::vec2(nearPlane, farPlane));
+        glActiveTexture(GL_TEXTURE2);
+        glBindTexture(GL_TEXTURE_2D, fullDepth);
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_2D, depth);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, color);
+        glBindVertexArray(fullscreenVao);
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+        glBindVertexArray(0);
+
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        glEnable(GL_DEPTH_TEST);
+    }
+
+    void release() {
+        if (fbo) glDeleteFramebuffers(1, &fbo);
+        for (unsigned int* t : { &color, &depth, &fullDepth })
+            if (*t) glDeleteTextures(1, t);
+        fbo = color = depth = fullDepth = 0;
+        width = height = fullWidth = fullHeight = scale = 0;
+    }
+
+private:
+    GLint target = 0;
+    GLint viewport[4] = {};
+
+    static unsigned int texture(int w, int h, GLenum internalFormat, GLenum format, GLenum type) {
+        unsigned int t;
+        glGenTextures(1, &t);
+        glBindTexture(GL_TEXTURE_2D, t);
+        glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, w, h, 0, format, type, nullptr);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        return t;
+    }
+};
+#endif
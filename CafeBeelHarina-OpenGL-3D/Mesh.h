@@ -0,0 +1,46 @@
+#ifndef MESH_H
+#define MESH_H
+
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "ConstMesh.h"
+
+// ======================================================
+// CPU-side mesh in the engine's vertex format
+// vertices: interleaved pos(3) normal(3) uv(2), kVertexStride floats each
+// indices : triangle list; empty means a non-indexed triangle list
+// ======================================================
+struct MeshData {
+    std::vector<float> vertices;
+    std::vector<unsigned int> indices;
+
+    int vertexCount() const { return (int)(vertices.size() / kVertexStride); }
+    int triangleCount() const { return indices.empty() ? vertexCount() / 3 : (int)indices.size() / 3; }
+
+    glm::vec3 position(int v) const {
+        const float* p = &vertices[(size_t)v * kVertexStride];
+        return glm::vec3(p[0], p[1], p[2]);
+    }
+
+    void computeBounds(glm::vec3& outMin, glm::vec3& outMax) const {
+        outMin = glm::vec3(0.0f);
+        outMax = glm::vec3(0.0f);
+        if (vertices.empty()) return;
+
+        outMin = outMax = position(0);
+        for (int i = 1; i < vertexCount(); ++i) {
+            glm::vec3 p = position(i);
+            outMin = glm::min(outMin, p);
+            outMax = glm::max(outMax, p);
+        }
+    }
+
+    static MeshData fromArrays(const float* v, int vertexCount, const unsigned int* idx = nullptr, int indexCount = 0) {
+        MeshData m;
+        m.vertices.assign(v, v + (size_t)vertexCount * kVertexStride);
+        if (idx) m.indices.assign(idx, idx + indexCount);
+        return m;
+    }
+};
+#endif
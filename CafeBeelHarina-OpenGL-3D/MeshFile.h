@@ -0,0 +1,275 @@
+#ifndef MESH_FILE_H
+#define MESH_FILE_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "Mesh.h"
+#include "MappedFile.h"
+
+// ======================================================
+// .cbm - compact binary mesh container
+//
+//   MeshFileHeader
+//   MeshAttribute[attributeCount]   vertex layout descriptor
+//   MeshLod[lodCount]               LOD table (LOD 0 = full detail)
+//   vertex blob                     all LODs back to back, 16-byte aligned
+//   index blob                      uint32, 16-byte aligned (may be empty)
+//
+// Every LOD addresses the shared blobs through firstIndex/baseVertex, so a
+// loader maps the file once and uploads both blobs straight from the mapping.
+// ======================================================
+const char kMeshFileMagic[4] = { 'C', 'B', 'M', 'F' };
+const uint32_t kMeshFileVersion = 1;
+const uint32_t kMeshFileAlign = 16;
+
+struct MeshFileHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t attributeCount;
+    uint32_t lodCount;
+
+    uint32_t vertexStride;      // bytes
+    uint32_t vertexCount;       // all LODs
+    uint32_t indexCount;        // all LODs, 0 = non-indexed
+    uint32_t reserved;
+
+    uint64_t attributeOffset;
+    uint64_t lodOffset;
+    uint64_t vertexOffset;
+    uint64_t indexOffset;
+
+    float boundsMin[3];
+    float boundsMax[3];
+    uint32_t pad[2];
+};
+
+struct MeshAttribute {
+    uint32_t location;          // shader attribute location
+    uint32_t components;        // 1..4
+    uint32_t type;              // GL enum (GL_FLOAT ...)
+    uint32_t offset;            // byte offset inside a vertex
+};
+
+struct MeshLod {
+    uint32_t firstIndex;        // into the index blob (or first vertex if non-indexed)
+    uint32_t indexCount;        // index count (or vertex count if non-indexed)
+    int32_t baseVertex;
+    uint32_t vertexCount;       // vertices owned by this LOD
+    float screenSize;           // use this LOD while projected height >= screenSize (fraction of viewport)
+    uint32_t pad[3];
+};
+
+static_assert(sizeof(MeshFileHeader) % kMeshFileAlign == 0, "header must keep blobs aligned");
+static_assert(sizeof(MeshLod) % kMeshFileAlign == 0, "LOD entries must keep blobs aligned");
+
+// The engine's interleaved layout: pos(3) normal(3) uv(2)
+inline std::vector<MeshAttribute> standardMeshAttributes() {
+    return {
+        { 0, 3, GL_FLOAT, 0 },
+        { 1, 3, GL_FLOAT, 3 * sizeof(float) },
+        { 2, 2, GL_FLOAT, 6 * sizeof(float) },
+    };
+}
+
+inline uint64_t alignMeshOffset(uint64_t v) { return (v + kMeshFileAlign - 1) & ~(uint64_t)(kMeshFileAlign - 1); }
+
+// ------------------------------
+// Writer (offline bake)
+// lods[0] is full detail; screenSizes[i] pairs with lods[i]
+// ------------------------------
+inline bool writeMeshFile(const std::string& path, const std::vector<MeshData>& lods, const std::vector<float>& screenSizes)
+{
+    if (lods.empty()) return false;
+    bool indexed = !lods[0].indices.empty();
+
+    std::vector<MeshAttribute> attributes = standardMeshAttributes();
+    std::vector<MeshLod> lodTable;
+    std::vector<float> vertexBlob;
+    std::vector<unsigned int> indexBlob;
+
+    glm::vec3 bMin, bMax;
+    lods[0].computeBounds(bMin, bMax);
+
+    for (size_t i = 0; i < lods.size(); ++i) {
+        const MeshData& m = lods[i];
+        if (m.indices.empty() == indexed) {
+            std::cout << "ERROR::MESHFILE::MIXED_INDEXED_LODS: " << path << std::endl;
+            return false;
+        }
+
+        MeshLod lod = {};
+        lod.baseVertex = (int32_t)(vertexBlob.size() / kVertexStride);
+        lod.vertexCount = (uint32_t)m.vertexCount();
+        lod.screenSize = i < screenSizes.size() ? screenSizes[i] : 0.0f;
+        if (indexed) {
+            lod.firstIndex = (uint32_t)indexBlob.size();
+            lod.indexCount = (uint32_t)m.indices.size();
+            indexBlob.insert(indexBlob.end(), m.indices.begin(), m.indices.end());
+        }
+        else {
+            lod.firstIndex = (uint32_t)lod.baseVertex;
+            lod.indexCount = lod.vertexCount;
+        }
+        vertexBlob.insert(vertexBlob.end(), m.vertices.begin(), m.vertices.end());
+        lodTable.push_back(lod);
+    }
+
+    MeshFileHeader h = {};
+    memcpy(h.magic, kMeshFileMagic, 4);
+    h.version = kMeshFileVersion;
+    h.attributeCount = (uint32_t)attributes.size();
+    h.lodCount = (uint32_t)lodTable.size();
+    h.vertexStride = kVertexStrideBytes;
+    h.vertexCount = (uint32_t)(vertexBlob.size() / kVertexStride);
+    h.indexCount = (uint32_t)indexBlob.size();
+    for (int k = 0; k < 3; ++k) { h.boundsMin[k] = bMin[k]; h.boundsMax[k] = bMax[k]; }
+
+    h.attributeOffset = sizeof(MeshFileHeader);
+    h.lodOffset = alignMeshOffset(h.attributeOffset + attributes.size() * sizeof(MeshAttribute));
+    h.vertexOffset = alignMeshOffset(h.lodOffset + lodTable.size() * sizeof(MeshLod));
+    h.indexOffset = alignMeshOffset(h.vertexOffset + vertexBlob.size() * sizeof(float));
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        std::cout << "ERROR::MESHFILE::CANNOT_WRITE: " << path << std::endl;
+        return false;
+    }
+
+    auto padTo = [&](uint64_t offset) {
+        static const char zeros[kMeshFileAlign] = {};
+        uint64_t at = (uint64_t)out.tellp();
+        if (offset > at) out.write(zeros, (std::streamsize)(offset - at));
+    };
+
+    out.write((const char*)&h, sizeof(h));
+    out.write((const char*)attributes.data(), attributes.size() * sizeof(MeshAttribute));
+    padTo(h.lodOffset);
+    out.write((const char*)lodTable.data(), lodTable.size() * sizeof(MeshLod));
+    padTo(h.vertexOffset);
+    out.write((const char*)vertexBlob.data(), vertexBlob.size() * sizeof(float));
+    padTo(h.indexOffset);
+    if (!indexBlob.empty())
+        out.write((const char*)indexBlob.data(), indexBlob.size() * sizeof(unsigned int));
+
+    return (bool)out;
+}
+
+// ======================================================
+// Loader: maps the file and exposes typed views into it (no copies)
+// ======================================================
+class MeshFileView {
+public:
+    bool open(const std::string& path) {
+        if (!file.open(path)) return false;
+
+        const unsigned char* base = file.data();
+        size_t size = file.size();
+        if (size < sizeof(MeshFileHeader)) return fail(path, "TRUNCATED");
+
+        hdr = (const MeshFileHeader*)base;
+        if (memcmp(hdr->magic, kMeshFileMagic, 4) != 0) return fail(path, "BAD_MAGIC");
+        if (hdr->version != kMeshFileVersion) return fail(path, "BAD_VERSION");
+
+        // Blobs inside the file and aligned for their element type. Written as
+        // a subtraction from size: offsets come from the file and may be huge.
+        auto fits = [size](uint64_t offset, uint64_t bytes, size_t align) {
+            return offset % align == 0 && offset <= size && bytes <= size - offset;
+        };
+        if (hdr->vertexStride != (uint32_t)kVertexStrideBytes ||
+            !fits(hdr->attributeOffset, (uint64_t)hdr->attributeCount * sizeof(MeshAttribute), alignof(MeshAttribute)) ||
+            !fits(hdr->lodOffset, (uint64_t)hdr->lodCount * sizeof(MeshLod), alignof(MeshLod)) ||
+            !fits(hdr->vertexOffset, (uint64_t)hdr->vertexCount * hdr->vertexStride, alignof(float)) ||
+            !fits(hdr->indexOffset, (uint64_t)hdr->indexCount * sizeof(uint32_t), alignof(uint32_t)) ||
+            hdr->lodCount == 0)
+            return fail(path, "BAD_LAYOUT");
+        for (uint32_t i = 0; i < hdr->attributeCount; ++i) {
+            const MeshAttribute& a = attributes()[i];
+            if (a.components < 1 || a.components > 4 || (uint64_t)a.offset + a.components * 4 > hdr->vertexStride)
+                return fail(path, "BAD_ATTRIBUTE");
+        }
+
+        // Each LOD's ranges inside the blobs, and its indices inside its own vertices
+        for (int i = 0; i < lodCount(); ++i) {
+            const MeshLod& l = lod(i);
+            uint64_t rangeEnd = (uint64_t)l.firstIndex + l.indexCount;
+            if (l.baseVertex < 0 || (uint64_t)l.baseVertex + l.vertexCount > hdr->vertexCount ||
+                rangeEnd > (hdr->indexCount ? hdr->indexCount : hdr->vertexCount))
+                return fail(path, "BAD_LOD");
+            for (uint32_t k = 0; k < (hdr->indexCount ? l.indexCount : 0u); ++k)
+                if (indices()[l.firstIndex + k] >= l.vertexCount) return fail(path, "BAD_LOD");
+        }
+
+        return true;
+    }
+
+    void close() { file.close(); hdr = nullptr; }
+
+    const MeshFileHeader& header() const { return *hdr; }
+    const MeshAttribute* attributes() const { return (const MeshAttribute*)(file.data() + hdr->attributeOffset); }
+    const MeshLod& lod(int i) const { return ((const MeshLod*)(file.data() + hdr->lodOffset))[i]; }
+    int lodCount() const { return (int)hdr->lodCount; }
+
+    const float* vertices() const { return (const float*)(file.data() + hdr->vertexOffset); }
+    const unsigned int* indices() const { return hdr->indexCount ? (const unsigned int*)(file.data() + hdr->indexOffset) : nullptr; }
+
+    // LOD i's own vertices and indices (indices are relative to its first vertex)
+    const float* lodVertices(int i) const { return vertices() + (size_t)lod(i).baseVertex * (hdr->vertexStride / sizeof(float)); }
+    const unsigned int* lodIndices(int i) const { return hdr->indexCount ? indices() + lod(i).firstIndex : nullptr; }
+
+    glm::vec3 boundsMin() const { return glm::vec3(hdr->boundsMin[0], hdr->boundsMin[1], hdr->boundsMin[2]); }
+    glm::vec3 boundsMax() const { return glm::vec3(hdr->boundsMax[0], hdr->boundsMax[1], hdr->boundsMax[2]); }
+
+    // True when the blob can be fed to Sphere / Cylinder / SimpleCone as-is
+    bool hasStandardLayout() const {
+        std::vector<MeshAttribute> expected = standardMeshAttributes();
+        if (hdr->vertexStride != (uint32_t)kVertexStrideBytes || hdr->attributeCount != expected.size()) return false;
+        return memcmp(attributes(), expected.data(), expected.size() * sizeof(MeshAttribute)) == 0;
+    }
+
+    // Generic upload using the file's own layout descriptor.
+    // Buffers are filled directly from the mapping.
+    unsigned int createVertexArray(unsigned int& vbo, unsigned int& ebo) const {
+        unsigned int vao;
+        glGenVertexArrays(1, &vao);
+        glGenBuffers(1, &vbo);
+        glBindVertexArray(vao);
+
+        glBindBuffer(GL_ARRAY_BUFFER, vbo);
+        glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)hdr->vertexCount * hdr->vertexStride, file.data() + hdr->vertexOffset, GL_STATIC_DRAW);
+
+        ebo = 0;
+        if (hdr->indexCount) {
+            glGenBuffers(1, &ebo);
+            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
+            glBufferData(GL_ELEMENT_ARRAY_BUFFER, (GLsizeiptr)hdr->indexCount * sizeof(uint32_t), indices(), GL_STATIC_DRAW);
+        }
+
+        for (uint32_t a = 0; a < hdr->attributeCount; ++a) {
+            const MeshAttribute& at = attributes()[a];
+            glVertexAttribPointer(at.location, at.components, at.type, GL_FALSE, hdr->vertexStride, (void*)(size_t)at.offset);
+            glEnableVertexAttribArray(at.location);
+        }
+
+        glBindVertexArray(0);
+        return vao;
+    }
+
+private:
+    bool fail(const std::string& path, const char* why) {
+        std::cout << "ERROR::MESHFILE::" << why << ": " << path << std::endl;
+        close();
+        return false;
+    }
+
+    MappedFile file;
+    const MeshFileHeader* hdr = nullptr;
+};
+#endif
@@ -0,0 +1,165 @@
+#ifndef MESH_POOL_H
+#define MESH_POOL_H
+
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "Mesh.h"
+
+// ======================================================
+// Shared GPU geometry buffers
+// Many meshes live in one VBO/EBO pair behind a single VAO; each mesh is a
+// (baseVertex, firstIndex, indexCount) range drawn with glDrawElementsBaseVertex.
+// Buffers grow by doubling, old contents are copied on the GPU.
+// Positions are also kept tightly packed in a second VBO behind depthVao
+// (same EBO) for the depth pre-pass.
+// ======================================================
+struct PooledMesh {
+    int baseVertex = 0;
+    unsigned int firstIndex = 0;
+    unsigned int indexCount = 0;
+};
+
+class MeshPool {
+public:
+    unsigned int vao = 0, vbo = 0, ebo = 0;
+    unsigned int depthVao = 0, positionVbo = 0;
+    int vertexCapacity = 0, vertexUsed = 0;
+    int indexCapacity = 0, indexUsed = 0;
+
+    void init(int vertexCap = 64 * 1024, int indexCap = 192 * 1024) {
+        glGenVertexArrays(1, &vao);
+        glGenVertexArrays(1, &depthVao);
+        allocate(vertexCap, indexCap);
+    }
+
+    PooledMesh add(const MeshData& mesh) {
+        return add(mesh.vertices.data(), mesh.vertexCount(),
+                   mesh.indices.empty() ? nullptr : mesh.indices.data(), (int)mesh.indices.size());
+    }
+
+    // Raw form, e.g. straight from a mapped file; indices == nullptr means non-indexed
+    PooledMesh add(const float* vertices, int vCount, const unsigned int* indices, int indexCount) {
+        PooledMesh h;
+        int iCount = indices ? indexCount : vCount;
+
+        if (vertexUsed + vCount > vertexCapacity || indexUsed + iCount > indexCapacity)
+            allocate(std::max(vertexCapacity * 2, vertexUsed + vCount), std::max(indexCapacity * 2, indexUsed + iCount));
+
+        h.baseVertex = vertexUsed;
+        h.firstIndex = (unsigned int)indexUsed;
+        h.indexCount = (unsigned int)iCount;
+
+        glBindBuffer(GL_ARRAY_BUFFER, vbo);
+        glBufferSubData(GL_ARRAY_BUFFER, (GLintptr)vertexUsed * kVertexStrideBytes, (GLsizeiptr)vCount * kVertexStrideBytes, vertices);
+
+        std::vector<float> positions((size_t)vCount * 3);
+        for (int v = 0; v < vCount; ++v)
+            for (int c = 0; c < 3; ++c) positions[(size_t)v * 3 + c] = vertices[(size_t)v * kVertexStride + c];
+        glBindBuffer(GL_ARRAY_BUFFER, positionVbo);
+        glBufferSubData(GL_ARRAY_BUFFER, (GLintptr)vertexUsed * kPositionBytes, (GLsizeiptr)vCount * kPositionBytes, positions.data());
+
+        glBindVertexArray(vao);
+        if (!indices) {
+            std::vector<unsigned int> seq(vCount);
+            for (int i = 0; i < vCount; ++i) seq[i] = (unsigned int)i;
+            glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, (GLintptr)indexUsed * sizeof(unsigned int), (GLsizeiptr)iCount * sizeof(unsigned int), seq.data());
+        }
+        else {
+            glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, (GLintptr)indexUsed * sizeof(unsigned int), (GLsizeiptr)iCount * sizeof(unsigned int), indices);
+        }
+        glBindVertexArray(0);
+
+        vertexUsed += vCount;
+        indexUsed += iCount;
+        return h;
+    }
+
+    void bind() const { glBindVertexArray(vao); }
+
+    // Position-only stream, same ranges
+    void bindDepth() const { glBindVertexArray(depthVao); }
+
+    size_t memoryBytes() const {
+        return (size_t)vertexCapacity * (kVertexStrideBytes + kPositionBytes) + (size_t)indexCapacity * sizeof(unsigned int);
+    }
+
+    // Caller binds once, then issues any number of ranges
+    void drawRange(int baseVertex, unsigned int firstIndex, unsigned int indexCount) const {
+        glDrawElementsBaseVertex(GL_TRIANGLES, (GLsizei)indexCount, GL_UNSIGNED_INT,
+            (void*)((size_t)firstIndex * sizeof(unsigned int)), baseVertex);
+    }
+
+    void draw(const PooledMesh& m) const { drawRange(m.baseVertex, m.firstIndex, m.indexCount); }
+
+    void release() {
+        if (vbo) glDeleteBuffers(1, &vbo);
+        if (ebo) glDeleteBuffers(1, &ebo);
+        if (positionVbo) glDeleteBuffers(1, &positionVbo);
+        if (vao) glDeleteVertexArrays(1, &vao);
+        if (depthVao) glDeleteVertexArrays(1, &depthVao);
+        vao = vbo = ebo = depthVao = positionVbo = 0;
+        vertexCapacity = vertexUsed = indexCapacity = indexUsed = 0;
+    }
+
+private:
+    static const int kPositionBytes = 3 * sizeof(float);
+
+    void allocate(int vertexCap, int indexCap) {
+        unsigned int newVbo, newEbo, newPositionVbo;
+        glGenBuffers(1, &newVbo);
+        glGenBuffers(1, &newEbo);
+        glGenBuffers(1, &newPositionVbo);
+
+        glBindBuffer(GL_COPY_WRITE_BUFFER, newVbo);
+        glBufferData(GL_COPY_WRITE_BUFFER, (GLsizeiptr)vertexCap * kVertexStrideBytes, nullptr, GL_STATIC_DRAW);
+        if (vbo && vertexUsed) {
+            glBindBuffer(GL_COPY_READ_BUFFER, vbo);
+            glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, (GLsizeiptr)vertexUsed * kVertexStrideBytes);
+        }
+
+        glBindBuffer(GL_COPY_WRITE_BUFFER, newPositionVbo);
+        glBufferData(GL_COPY_WRITE_BUFFER, (GLsizeiptr)vertexCap * kPositionBytes, nullptr, GL_STATIC_DRAW);
+        if (positionVbo && vertexUsed) {
+            glBindBuffer(GL_COPY_READ_BUFFER, positionVbo);
+            glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, (GLsizeiptr)vertexUsed * kPositionBytes);
+        }
+
+        glBindBuffer(GL_COPY_WRITE_BUFFER, newEbo);
+        glBufferData(GL_COPY_WRITE_BUFFER, (GLsizeiptr)indexCap * sizeof(unsigned int), nullptr, GL_STATIC_DRAW);
+        if (ebo && indexUsed) {
+            glBindBuffer(GL_COPY_READ_BUFFER, ebo);
+            glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, (GLsizeiptr)indexUsed * sizeof(unsigned int));
+        }
+
+        if (vbo) glDeleteBuffers(1, &vbo);
+        if (ebo) glDeleteBuffers(1, &ebo);
+        if (positionVbo) glDeleteBuffers(1, &positionVbo);
+        vbo = newVbo;
+        ebo = newEbo;
+        positionVbo = newPositionVbo;
+        vertexCapacity = vertexCap;
+        indexCapacity = indexCap;
+
+        // Re-point the VAO at the new buffers
+        glBindVertexArray(vao);
+        glBindBuffer(GL_ARRAY_BUFFER, vbo);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, kVertexStrideBytes, (void*)0);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, kVertexStrideBytes, (void*)(3 * sizeof(float)));
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, kVertexStrideBytes, (void*)(6 * sizeof(float)));
+        glEnableVertexAttribArray(2);
+
+        glBindVertexArray(depthVao);
+        glBindBuffer(GL_ARRAY_BUFFER, positionVbo);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, kPositionBytes, (void*)0);
+        glEnableVertexAttribArray(0);
+        glBindVertexArray(0);
+    }
+};
+#endif
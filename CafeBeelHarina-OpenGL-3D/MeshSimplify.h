@@ -0,0 +1,393 @@
+#ifndef MESH_SIMPLIFY_H
+#define MESH_SIMPLIFY_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <numeric>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "JobSystem.h"
+#include "Mesh.h"
+
+// ======================================================
+// Mesh simplification (quadric error metric, edge collapse)
+// Vertices only ever collapse onto a neighbour, so every kept vertex keeps
+// its exact position, normal and UV. A position where attributes differ
+// (UV seam, hard normal edge) or the mesh is open is treated specially:
+//   free   : interior, one attribute set      -> may collapse anywhere
+//   line   : on exactly two seam/border edges -> may only slide along them
+//   locked : corner, non-manifold, or border with lockBorders -> never moves
+// Seam and border edges also add a plane constraint to the quadrics so
+// sliding along them stays on the original outline. Each pass collapses
+// the cheapest edges (each vertex at most once), rejecting collapses that
+// would flip a triangle, until the target count or error bound is reached.
+// Errors are distances relative to the mesh's bounding radius.
+// ======================================================
+struct SimplifyOptions {
+    int targetTriangles = 0;            // stop at or below this count
+    float maxError = 1.0f;              // no collapse above this (relative distance)
+    bool lockBorders = false;           // open borders stay exactly as they are
+    const std::vector<int>* regions = nullptr;  // per input triangle (e.g. material); region boundaries are kept like seams
+};
+
+struct SimplifyResult {
+    float error = 0.0f;                 // largest collapse error used (relative distance)
+    std::vector<int> regions;           // per output triangle, when regions were given
+};
+
+namespace simplify {
+
+struct Quadric {
+    double a00 = 0, a01 = 0, a02 = 0, a03 = 0;
+    double a11 = 0, a12 = 0, a13 = 0;
+    double a22 = 0, a23 = 0, a33 = 0;
+
+    // Plane n.x + d = 0 (n unit length), times weight
+    void addPlane(const glm::vec3& n, float d, double w) {
+        a00 += w * n.x * n.x; a01 += w * n.x * n.y; a02 += w * n.x * n.z; a03 += w * n.x * d;
+        a11 += w * n.y * n.y; a12 += w * n.y * n.z; a13 += w * n.y * d;
+        a22 += w * n.z * n.z; a23 += w * n.z * d;
+        a33 += w * (double)d * d;
+    }
+
+    void add(const Quadric& q) {
+        a00 += q.a00; a01 += q.a01; a02 += q.a02; a03 += q.a03;
+        a11 += q.a11; a12 += q.a12; a13 += q.a13;
+        a22 += q.a22; a23 += q.a23; a33 += q.a33;
+    }
+
+    // Weighted squared distance of p to the accumulated planes
+    double eval(const glm::vec3& p) const {
+        double x = p.x, y = p.y, z = p.z;
+        return a00 * x * x + 2 * a01 * x * y + 2 * a02 * x * z + 2 * a03 * x
+             + a11 * y * y + 2 * a12 * y * z + 2 * a13 * y
+             + a22 * z * z + 2 * a23 * z + a33;
+    }
+};
+
+enum VertexKind : unsigned char { KIND_FREE, KIND_LINE, KIND_LOCKED };
+
+inline uint64_t edgeKey(int a, int b) {
+    if (a > b) std::swap(a, b);
+    return ((uint64_t)(uint32_t)a << 32) | (uint32_t)b;
+}
+
+// Bit-exact key of a float run, for welding
+struct FloatRunHash {
+    size_t operator()(const std::vector<uint32_t>& k) const {
+        size_t h = 1469598103934665603ull;
+        for (uint32_t v : k) h = (h ^ v) * 1099511628211ull;
+        return h;
+    }
+};
+
+inline std::vector<uint32_t> floatBits(const float* p, int n) {
+    std::vector<uint32_t> k(n);
+    memcpy(k.data(), p, n * sizeof(float));
+    return k;
+}
+
+} // namespace simplify
+
+inline MeshData simplifyMesh(const MeshData& in, const SimplifyOptions& opt, SimplifyResult* result = nullptr)
+{
+    using namespace simplify;
+    const int vertexCount = in.vertexCount();
+    std::vector<unsigned int> indices = in.indices;
+    if (indices.empty()) {
+        indices.resize(vertexCount);
+        std::iota(indices.begin(), indices.end(), 0u);
+    }
+    int triCount = (int)indices.size() / 3;
+    std::vector<int> regions = opt.regions ? *opt.regions : std::vector<int>(triCount, 0);
+    regions.resize(triCount, 0);
+
+    // Weld identical vertices (triangle soups), then group them by position
+    std::vector<unsigned int> canon(vertexCount);
+    std::vector<int> posOf(vertexCount, -1);
+    std::vector<glm::vec3> positions;
+    {
+        std::unordered_map<std::vector<uint32_t>, unsigned int, FloatRunHash> byVertex;
+        std::unordered_map<std::vector<uint32_t>, int, FloatRunHash> byPosition;
+        for (int v = 0; v < vertexCount; ++v) {
+            const float* p = &in.vertices[(size_t)v * kVertexStride];
+            canon[v] = byVertex.emplace(floatBits(p, kVertexStride), (unsigned int)v).first->second;
+            auto it = byPosition.emplace(floatBits(p, 3), (int)positions.size());
+            if (it.second) positions.push_back(glm::vec3(p[0], p[1], p[2]));
+            posOf[v] = it.first->second;
+        }
+    }
+    for (unsigned int& i : indices) i = canon[i];
+    const int posCount = (int)positions.size();
+
+    glm::vec3 bMin, bMax;
+    in.computeBounds(bMin, bMax);
+    float radius = 0.5f * glm::length(bMax - bMin);
+    if (triCount == 0 || radius <= 0.0f) {
+        if (result) result->regions = regions;
+        return in;
+    }
+
+    // Position-level edges: border (one triangle), seam (attributes or
+    // regions differ across it), non-manifold (more than two triangles)
+    struct EdgeInfo { int count; unsigned int va, vb; int region; bool seam; };
+    std::unordered_map<uint64_t, EdgeInfo> edges;
+    for (int t = 0; t < triCount; ++t)
+        for (int k = 0; k < 3; ++k) {
+            unsigned int va = indices[t * 3 + k], vb = indices[t * 3 + (k + 1) % 3];
+            int pa = posOf[va], pb = posOf[vb];
+            if (pa == pb) continue;
+            if (pa > pb) { std::swap(pa, pb); std::swap(va, vb); }
+            auto it = edges.find(edgeKey(pa, pb));
+            if (it == edges.end()) { edges.emplace(edgeKey(pa, pb), EdgeInfo{ 1, va, vb, regions[t], false }); continue; }
+            EdgeInfo& e = it->second;
+            ++e.count;
+            if (e.va != va || e.vb != vb || e.region != regions[t]) e.seam = true;
+        }
+
+    std::unordered_set<uint64_t> special;
+    std::vector<int> specialCount(posCount, 0);
+    std::vector<unsigned char> kind(posCount, KIND_FREE);
+    for (const auto& kv : edges) {
+        const EdgeInfo& e = kv.second;
+        bool border = e.count == 1, nonManifold = e.count > 2;
+        if (!border && !nonManifold && !e.seam) continue;
+        special.insert(kv.first);
+        int pa = (int)(kv.first >> 32), pb = (int)(uint32_t)kv.first;
+        ++specialCount[pa];
+        ++specialCount[pb];
+        if (nonManifold || (border && opt.lockBorders)) kind[pa] = kind[pb] = KIND_LOCKED;
+    }
+    for (int p = 0; p < posCount; ++p)
+        if (kind[p] != KIND_LOCKED && specialCount[p] > 0)
+            kind[p] = specialCount[p] == 2 ? KIND_LINE : KIND_LOCKED;
+
+    // Quadrics: area-weighted triangle planes; seams and borders add a plane
+    // through the edge, perpendicular to the triangle, weighted heavier
+    const double kEdgeWeight = 10.0;
+    std::vector<Quadric> quadric(posCount);
+    std::vector<double> weight(posCount, 0.0);
+    for (int t = 0; t < triCount; ++t) {
+        int p[3] = { posOf[indices[t * 3]], posOf[indices[t * 3 + 1]], posOf[indices[t * 3 + 2]] };
+        glm::vec3 n = glm::cross(positions[p[1]] - positions[p[0]], positions[p[2]] - positions[p[0]]);
+        float len = glm::length(n);
+        if (len <= 0.0f) continue;
+        n /= len;
+        double area = 0.5 * len;
+        for (int k = 0; k < 3; ++k) {
+            quadric[p[k]].addPlane(n, -glm::dot(n, positions[p[0]]), area);
+            weight[p[k]] += area;
+
+            int a = p[k], b = p[(k + 1) % 3];
+            if (a == b || !special.count(edgeKey(a, b))) continue;
+            glm::vec3 e = positions[b] - positions[a];
+            glm::vec3 side = glm::cross(e, n);
+            float sideLen = glm::length(side);
+            if (sideLen <= 0.0f) continue;
+            side /= sideLen;
+            double w = kEdgeWeight * glm::dot(e, e);
+            quadric[a].addPlane(side, -glm::dot(side, positions[a]), w);
+            quadric[b].addPlane(side, -glm::dot(side, positions[a]), w);
+        }
+    }
+
+    std::vector<std::vector<unsigned int>> attrs(posCount);
+    std::vector<unsigned char> used;
+
+    std::vector<unsigned int> vremap(vertexCount);
+    std::iota(vremap.begin(), vremap.end(), 0u);
+    auto resolve = [&](unsigned int v) { while (vremap[v] != v) v = vremap[v]; return v; };
+
+    const double maxCost = (double)opt.maxError * radius * opt.maxError * radius;
+    double usedCost = 0.0;
+    const int target = std::max(opt.targetTriangles, 0);
+
+    struct Collapse { int from, to; double cost; };
+    std::vector<Collapse> candidates;
+    std::vector<int> triStart, triList;
+    std::vector<unsigned char> touched;
+    std::vector<std::pair<unsigned int, unsigned int>> mapping;
+
+    while (triCount > target) {
+        // Attribute vertices still in use at each position
+        for (std::vector<unsigned int>& list : attrs) list.clear();
+        used.assign(vertexCount, 0);
+        for (unsigned int i : indices)
+            if (!used[i]) { used[i] = 1; attrs[posOf[i]].push_back(i); }
+
+        // Triangles around each position
+        triStart.assign(posCount + 1, 0);
+        for (unsigned int i : indices) ++triStart[posOf[i] + 1];
+        for (int p = 0; p < posCount; ++p) triStart[p + 1] += triStart[p];
+        triList.resize(indices.size());
+        {
+            std::vector<int> fill(triStart.begin(), triStart.end() - 1);
+            for (int t = 0; t < triCount; ++t)
+                for (int k = 0; k < 3; ++k) triList[fill[posOf[indices[t * 3 + k]]]++] = t;
+        }
+
+        // Cheapest allowed direction per edge
+        std::vector<uint64_t> passEdges;
+        passEdges.reserve(indices.size());
+        for (int t = 0; t < triCount; ++t)
+            for (int k = 0; k < 3; ++k) {
+                int a = posOf[indices[t * 3 + k]], b = posOf[indices[t * 3 + (k + 1) % 3]];
+                if (a != b) passEdges.push_back(edgeKey(a, b));
+            }
+        std::sort(passEdges.begin(), passEdges.end());
+        passEdges.erase(std::unique(passEdges.begin(), passEdges.end()), passEdges.end());
+
+        candidates.clear();
+        for (uint64_t key : passEdges) {
+            int a = (int)(key >> 32), b = (int)(uint32_t)key;
+            bool onSpecial = special.count(key) != 0;
+            auto allowed = [&](int from) { return kind[from] == KIND_FREE || (kind[from] == KIND_LINE && onSpecial); };
+            auto cost = [&](int from, int to) {
+                Quadric q = quadric[from];
+                q.add(quadric[to]);
+                double w = weight[from] + weight[to];
+                return std::max(q.eval(positions[to]), 0.0) / (w > 0.0 ? w : 1.0);
+            };
+            double cab = allowed(a) ? cost(a, b) : -1.0;
+            double cba = allowed(b) ? cost(b, a) : -1.0;
+            if (cab < 0.0 && cba < 0.0) continue;
+            if (cba < 0.0 || (cab >= 0.0 && cab <= cba)) candidates.push_back({ a, b, cab });
+            else candidates.push_back({ b, a, cba });
+        }
+        std::sort(candidates.begin(), candidates.end(), [](const Collapse& x, const Collapse& y) { return x.cost < y.cost; });
+
+        touched.assign(posCount, 0);
+        int removed = 0;
+        for (const Collapse& c : candidates) {
+            if (c.cost > maxCost || triCount - removed <= target) break;
+            int p = c.from, q = c.to;
+            if (touched[p] || touched[q]) continue;
+
+            // Attribute vertex of q each of p's takes over, and no flips
+            mapping.clear();
+            bool ok = true;
+            int dying = 0;
+            for (int i = triStart[p]; i < triStart[p + 1] && ok; ++i) {
+                int t = triList[i];
+                unsigned int v[3] = { resolve(indices[t * 3]), resolve(indices[t * 3 + 1]), resolve(indices[t * 3 + 2]) };
+                int kp = -1, kq = -1;
+                for (int k = 0; k < 3; ++k) {
+                    if (posOf[v[k]] == p) kp = k;
+                    else if (posOf[v[k]] == q) kq = k;
+                }
+                if (kp < 0) continue;       // already collapsed away this pass
+                if (kq >= 0) {
+                    ++dying;
+                    bool known = false;
+                    for (auto& m : mapping)
+                        if (m.first == v[kp]) { known = true; ok = m.second == v[kq]; }
+                    if (!known) mapping.push_back({ v[kp], v[kq] });
+                    continue;
+                }
+                glm::vec3 a = positions[posOf[v[0]]], b = positions[posOf[v[1]]], d = positions[posOf[v[2]]];
+                glm::vec3 before = glm::cross(b - a, d - a);
+                glm::vec3 moved[3] = { a, b, d };
+                moved[kp] = positions[q];
+                glm::vec3 after = glm::cross(moved[1] - moved[0], moved[2] - moved[0]);
+                if (glm::dot(before, after) <= 0.0f) ok = false;
+            }
+            for (unsigned int a : attrs[p]) {
+                bool found = false;
+                for (auto& m : mapping) found |= m.first == a;
+                if (!found) ok = false;
+            }
+            if (!ok || dying == 0) continue;
+
+            for (auto& m : mapping) vremap[m.first] = m.second;
+            quadric[q].add(quadric[p]);
+            weight[q] += weight[p];
+            if (kind[p] == KIND_LINE)
+                for (int i = triStart[p]; i < triStart[p + 1]; ++i)
+                    for (int k = 0; k < 3; ++k) {
+                        int r = posOf[resolve(indices[triList[i] * 3 + k])];
+                        if (r != p && r != q && special.count(edgeKey(p, r))) special.insert(edgeKey(q, r));
+                    }
+            touched[p] = touched[q] = 1;
+            removed += dying;
+            usedCost = std::max(usedCost, c.cost);
+        }
+        if (removed == 0) break;
+
+        // Rewrite, dropping triangles that lost an edge
+        int n = 0;
+        for (int t = 0; t < triCount; ++t) {
+            unsigned int a = resolve(indices[t * 3]), b = resolve(indices[t * 3 + 1]), d = resolve(indices[t * 3 + 2]);
+            if (posOf[a] == posOf[b] || posOf[b] == posOf[d] || posOf[a] == posOf[d]) continue;
+            indices[n * 3] = a; indices[n * 3 + 1] = b; indices[n * 3 + 2] = d;
+            regions[n++] = regions[t];
+        }
+        triCount = n;
+        indices.resize((size_t)n * 3);
+        regions.resize(n);
+        for (unsigned int& v : vremap) v = resolve(v);
+    }
+
+    // Compact: referenced vertices only, in first-use order
+    MeshData out;
+    std::vector<int> newIndex(vertexCount, -1);
+    out.indices.reserve(indices.size());
+    for (unsigned int i : indices) {
+        if (newIndex[i] < 0) {
+            newIndex[i] = out.vertexCount();
+            const float* v = &in.vertices[(size_t)i * kVertexStride];
+            out.vertices.insert(out.vertices.end(), v, v + kVertexStride);
+        }
+        out.indices.push_back((unsigned int)newIndex[i]);
+    }
+    if (result) {
+        result->error = (float)(std::sqrt(usedCost) / radius);
+        result->regions = regions;
+    }
+    return out;
+}
+
+// Full detail first, then every level simplified from the original down to
+// ratio^level of its triangles. Stops early once a level no longer shrinks
+// or would exceed maxError.
+inline std::vector<MeshData> buildLodChain(const MeshData& mesh, int maxLevels, float ratio, float maxError,
+                                           std::vector<float>* errors = nullptr, const std::vector<int>* regions = nullptr)
+{
+    std::vector<MeshData> chain{ mesh };
+    if (errors) errors->assign(1, 0.0f);
+    int full = mesh.triangleCount();
+    float fraction = 1.0f;
+    for (int level = 1; level < maxLevels; ++level) {
+        fraction *= ratio;
+        SimplifyOptions opt;
+        opt.targetTriangles = (int)(full * fraction);
+        opt.maxError = maxError;
+        opt.regions = regions;
+        SimplifyResult info;
+        MeshData lod = simplifyMesh(mesh, opt, &info);
+        if (lod.triangleCount() == 0 || lod.triangleCount() > chain.back().triangleCount() * 9 / 10) break;
+        chain.push_back(std::move(lod));
+        if (errors) errors->push_back(info.error);
+    }
+    return chain;
+}
+
+// One chain per mesh, meshes spread over the job system
+inline std::vector<std::vector<MeshData>> buildLodChains(const std::vector<MeshData>& meshes, int maxLevels, float ratio,
+                                                         float maxError, std::vector<std::vector<float>>* errors = nullptr,
+                                                         const std::vector<std::vector<int>>* regions = nullptr)
+{
+    std::vector<std::vector<MeshData>> chains(meshes.size());
+    if (errors) errors->assign(meshes.size(), std::vector<float>());
+    JobSystem::instance().parallelFor((int)meshes.size(), 1, [&](int begin, int end) {
+        for (int i = begin; i < end; ++i)
+            chains[i] = buildLodChain(meshes[i], maxLevels, ratio, maxError, errors ? &(*errors)[i] : nullptr,
+                                      regions ? &(*regions)[i] : nullptr);
+    });
+    return chains;
+}
+#endif
@@ -0,0 +1,733 @@
+#ifndef MODEL_IMPORT_H
+#define MODEL_IMPORT_H
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <future>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Mesh.h"
+#include "MappedFile.h"
+#include "JobSystem.h"
+#include "Json.h"
+
+// ======================================================
+// Model import: Wavefront OBJ and glTF 2.0 (.gltf + .bin, .glb)
+// Files are memory mapped and parsed on JobSystem workers; the result is a
+// single indexed MeshData in the engine's vertex format plus one part per
+// material, ready to be appended to a shared MeshPool.
+// ======================================================
+struct ModelPart {
+    unsigned int firstIndex = 0;
+    unsigned int indexCount = 0;
+    glm::vec4 color = glm::vec4(1.0f);
+};
+
+struct ImportedModel {
+    std::string path;
+    MeshData mesh;
+    std::vector<ModelPart> parts;
+    glm::vec3 boundsMin = glm::vec3(0.0f);
+    glm::vec3 boundsMax = glm::vec3(0.0f);
+    bool ok = false;
+    std::string error;
+};
+
+namespace modelimport {
+
+inline std::string directoryOf(const std::string& path) {
+    size_t slash = path.find_last_of("/\\");
+    return slash == std::string::npos ? std::string() : path.substr(0, slash + 1);
+}
+
+inline std::string lowerExtension(const std::string& path) {
+    size_t dot = path.find_last_of('.');
+    std::string ext = dot == std::string::npos ? std::string() : path.substr(dot + 1);
+    for (auto& c : ext) c = (char)tolower((unsigned char)c);
+    return ext;
+}
+
+// Smooth normals for vertices that came without one (normal == 0)
+inline void fillMissingNormals(MeshData& m) {
+    std::vector<glm::vec3> acc(m.vertexCount(), glm::vec3(0.0f));
+    for (size_t t = 0; t + 2 < m.indices.size(); t += 3) {
+        unsigned int a = m.indices[t], b = m.indices[t + 1], c = m.indices[t + 2];
+        glm::vec3 n = glm::cross(m.position(b) - m.position(a), m.position(c) - m.position(a));
+        acc[a] += n; acc[b] += n; acc[c] += n;
+    }
+    for (int v = 0; v < m.vertexCount(); ++v) {
+        float* p = &m.vertices[(size_t)v * kVertexStride];
+        if (p[3] != 0.0f || p[4] != 0.0f || p[5] != 0.0f) continue;
+        float len = glm::length(acc[v]);
+        glm::vec3 n = len > 0.0f ? acc[v] / len : glm::vec3(0, 1, 0);
+        p[3] = n.x; p[4] = n.y; p[5] = n.z;
+    }
+}
+
+// Any error fails the whole model, even with triangles already emitted
+inline void finishModel(ImportedModel& model) {
+    fillMissingNormals(model.mesh);
+    model.mesh.computeBounds(model.boundsMin, model.boundsMax);
+    model.ok = model.error.empty() && !model.mesh.indices.empty();
+    if (!model.ok && model.error.empty()) model.error = "no triangles";
+}
+
+// ------------------------------
+// OBJ
+// ------------------------------
+// 0-based indices; a set bit in `relative` means the index is relative to the
+// chunk start (OBJ negative indices) and still needs the chunk's prefix count
+struct ObjCorner { int v, vt, vn; unsigned char relative; };
+
+// Resolved (v, vt, vn), -1 where absent: one output vertex per distinct key
+struct ObjVertexKey {
+    int v, vt, vn;
+    bool operator==(const ObjVertexKey& o) const { return v == o.v && vt == o.vt && vn == o.vn; }
+};
+
+struct ObjVertexKeyHash {
+    size_t operator()(const ObjVertexKey& k) const {
+        size_t h = std::hash<int>()(k.v);
+        h ^= std::hash<int>()(k.vt) + 0x9E3779B9u + (h << 6) + (h >> 2);
+        h ^= std::hash<int>()(k.vn) + 0x9E3779B9u + (h << 6) + (h >> 2);
+        return h;
+    }
+};
+
+struct ObjChunk {
+    std::vector<glm::vec3> positions;
+    std::vector<glm::vec2> uvs;
+    std::vector<glm::vec3> normals;
+    std::vector<ObjCorner> corners;
+    std::vector<int> faceSizes;
+    std::vector<std::pair<int, std::string>> materialSwitches;   // (face index, name)
+    std::string mtllib;
+};
+
+inline const char* objSkipSpace(const char* p, const char* end) {
+    while (p < end && (*p == ' ' || *p == '\t')) ++p;
+    return p;
+}
+
+inline const char* objParseFloat(const char* p, const char* end, float& out) {
+    p = objSkipSpace(p, end);
+    char buf[48];
+    size_t n = 0;
+    while (p + n < end && n < sizeof(buf) - 1 && strchr("+-0123456789.eE", p[n])) { buf[n] = p[n]; ++n; }
+    buf[n] = '\0';
+    out = n ? strtof(buf, nullptr) : 0.0f;
+    return p + n;
+}
+
+inline const char* objParseInt(const char* p, const char* end, int& out, bool& present) {
+    present = false;
+    bool neg = false;
+    if (p < end && (*p == '-' || *p == '+')) { neg = *p == '-'; ++p; }
+    int v = 0;
+    while (p < end && *p >= '0' && *p <= '9') { v = v * 10 + (*p - '0'); ++p; present = true; }
+    out = neg ? -v : v;
+    return p;
+}
+
+// An OBJ index is either absolute (1-based) or relative to the elements seen
+// so far; relative ones become chunk-local (possibly < 0 = previous chunk)
+inline int objEncodeIndex(int raw, int localCount, unsigned char bit, unsigned char& relative) {
+    if (raw > 0) return raw - 1;
+    relative |= bit;
+    return localCount + raw;
+}
+
+inline void parseObjChunk(const char* p, const char* end, ObjChunk& c) {
+    while (p < end) {
+        const char* lineEnd = (const char*)memchr(p, '\n', end - p);
+        if (!lineEnd) lineEnd = end;
+        const char* s = objSkipSpace(p, lineEnd);
+
+        if (s + 1 < lineEnd && s[0] == 'v' && (s[1] == ' ' || s[1] == '\t')) {
+            glm::vec3 v;
+            s = objParseFloat(s + 1, lineEnd, v.x);
+            s = objParseFloat(s, lineEnd, v.y);
+            objParseFloat(s, lineEnd, v.z);
+            c.positions.push_back(v);
+        }
+        else if (s + 2 < lineEnd && s[0] == 'v' && s[1] == 't') {
+            glm::vec2 t;
+            s = objParseFloat(s + 2, lineEnd, t.x);
+            objParseFloat(s, lineEnd, t.y);
+            c.uvs.push_back(t);
+        }
+        else if (s + 2 < lineEnd && s[0] == 'v' && s[1] == 'n') {
+            glm::vec3 n;
+            s = objParseFloat(s + 2, lineEnd, n.x);
+            s = objParseFloat(s, lineEnd, n.y);
+            objParseFloat(s, lineEnd, n.z);
+            c.normals.push_back(n);
+        }
+        else if (s + 1 < lineEnd && s[0] == 'f' && (s[1] == ' ' || s[1] == '\t')) {
+            int count = 0;
+            s += 1;
+            for (;;) {
+                s = objSkipSpace(s, lineEnd);
+                if (s >= lineEnd || *s == '\r' || *s == '#') break;
+
+                ObjCorner k = { INT32_MIN, INT32_MIN, INT32_MIN, 0 };
+                int raw; bool present;
+                s = objParseInt(s, lineEnd, raw, present);
+                if (!present) break;
+                k.v = objEncodeIndex(raw, (int)c.positions.size(), 1, k.relative);
+                if (s < lineEnd && *s == '/') {
+                    s = objParseInt(s + 1, lineEnd, raw, present);
+                    if (present) k.vt = objEncodeIndex(raw, (int)c.uvs.size(), 2, k.relative);
+                    if (s < lineEnd && *s == '/') {
+                        s = objParseInt(s + 1, lineEnd, raw, present);
+                        if (present) k.vn = objEncodeIndex(raw, (int)c.normals.size(), 4, k.relative);
+                    }
+                }
+                while (s < lineEnd && *s != ' ' && *s != '\t') ++s;
+                c.corners.push_back(k);
+                ++count;
+            }
+            if (count >= 3) c.faceSizes.push_back(count);
+            else c.corners.resize(c.corners.size() - count);
+        }
+        else if (lineEnd - s > 7 && strncmp(s, "usemtl", 6) == 0) {
+            std::string name(objSkipSpace(s + 6, lineEnd), lineEnd);
+            while (!name.empty() && (name.back() == '\r' || name.back() == ' ')) name.pop_back();
+            c.materialSwitches.push_back({ (int)c.faceSizes.size(), name });
+        }
+        else if (lineEnd - s > 7 && strncmp(s, "mtllib", 6) == 0) {
+            std::string name(objSkipSpace(s + 6, lineEnd), lineEnd);
+            while (!name.empty() && (name.back() == '\r' || name.back() == ' ')) name.pop_back();
+            c.mtllib = name;
+        }
+        p = lineEnd + 1;
+    }
+}
+
+// Kd colors from a .mtl file (missing file -> white parts)
+inline std::map<std::string, glm::vec4> loadMtlColors(const std::string& path) {
+    std::map<std::string, glm::vec4> colors;
+    MappedFile f;
+    if (!f.open(path)) return colors;
+
+    const char* p = (const char*)f.data();
+    const char* end = p + f.size();
+    std::string current;
+    while (p < end) {
+        const char* lineEnd = (const char*)memchr(p, '\n', end - p);
+        if (!lineEnd) lineEnd = end;
+        const char* s = objSkipSpace(p, lineEnd);
+        if (lineEnd - s > 7 && strncmp(s, "newmtl", 6) == 0) {
+            current.assign(objSkipSpace(s + 6, lineEnd), lineEnd);
+            while (!current.empty() && (current.back() == '\r' || current.back() == ' ')) current.pop_back();
+            colors[current] = glm::vec4(1.0f);
+        }
+        else if (s + 2 < lineEnd && s[0] == 'K' && s[1] == 'd' && !current.empty()) {
+            glm::vec4& c = colors[current];
+            s = objParseFloat(s + 2, lineEnd, c.x);
+            s = objParseFloat(s, lineEnd, c.y);
+            objParseFloat(s, lineEnd, c.z);
+        }
+        else if (s + 1 < lineEnd && s[0] == 'd' && s[1] == ' ' && !current.empty()) {
+            objParseFloat(s + 1, lineEnd, colors[current].w);
+        }
+        p = lineEnd + 1;
+    }
+    return colors;
+}
+
+inline void importObj(const std::string& path, ImportedModel& model) {
+    MappedFile file;
+    if (!file.open(path)) { model.error = "cannot open file"; return; }
+
+    const char* data = (const char*)file.data();
+    const char* end = data + file.size();
+
+    // Split at line boundaries, one chunk per worker (small files stay single chunk)
+    JobSystem& jobs = JobSystem::instance();
+    size_t minChunk = 256 * 1024;
+    int chunkCount = (int)std::max<size_t>(1, std::min<size_t>(jobs.workerCount() + 1, file.size() / minChunk));
+    std::vector<const char*> cuts(chunkCount + 1, end);
+    cuts[0] = data;
+    for (int i = 1; i < chunkCount; ++i) {
+        const char* c = data + file.size() * i / chunkCount;
+        c = std::max(c, cuts[i - 1]);
+        const char* nl = (const char*)memchr(c, '\n', end - c);
+        cuts[i] = nl ? nl + 1 : end;
+    }
+
+    std::vector<ObjChunk> chunks(chunkCount);
+    jobs.parallelFor(chunkCount, 1, [&](int b, int e) {
+        for (int i = b; i < e; ++i) parseObjChunk(cuts[i], cuts[i + 1], chunks[i]);
+    });
+
+    // Merge element arrays and resolve chunk-relative indices
+    std::vector<glm::vec3> positions, normals;
+    std::vector<glm::vec2> uvs;
+    std::vector<int> posBase(chunkCount), uvBase(chunkCount), nrmBase(chunkCount);
+    std::string mtllib;
+    for (int i = 0; i < chunkCount; ++i) {
+        posBase[i] = (int)positions.size();
+        uvBase[i] = (int)uvs.size();
+        nrmBase[i] = (int)normals.size();
+        positions.insert(positions.end(), chunks[i].positions.begin(), chunks[i].positions.end());
+        uvs.insert(uvs.end(), chunks[i].uvs.begin(), chunks[i].uvs.end());
+        normals.insert(normals.end(), chunks[i].normals.begin(), chunks[i].normals.end());
+        if (!chunks[i].mtllib.empty()) mtllib = chunks[i].mtllib;
+    }
+
+    auto resolve = [](int encoded, bool relative, int base, int count) {
+        if (encoded == INT32_MIN) return -1;
+        int idx = relative ? base + encoded : encoded;
+        return (idx >= 0 && idx < count) ? idx : -1;
+    };
+
+    std::map<std::string, glm::vec4> mtlColors;
+    if (!mtllib.empty()) mtlColors = loadMtlColors(directoryOf(path) + mtllib);
+
+    // Triangles grouped by material, vertices deduplicated by (v, vt, vn)
+    std::map<std::string, std::vector<unsigned int>> trianglesByMaterial;
+    std::unordered_map<ObjVertexKey, unsigned int, ObjVertexKeyHash> vertexMap;
+    MeshData& mesh = model.mesh;
+
+    auto emit = [&](int v, int vt, int vn) -> unsigned int {
+        ObjVertexKey key = { v, vt, vn };
+        auto it = vertexMap.find(key);
+        if (it != vertexMap.end()) return it->second;
+
+        glm::vec3 p = positions[v];
+        glm::vec3 n = vn >= 0 ? normals[vn] : glm::vec3(0.0f);
+        glm::vec2 t = vt >= 0 ? uvs[vt] : glm::vec2(0.0f);
+        mesh.vertices.insert(mesh.vertices.end(), { p.x, p.y, p.z, n.x, n.y, n.z, t.x, t.y });
+        unsigned int index = (unsigned int)mesh.vertexCount() - 1;
+        vertexMap.emplace(key, index);
+        return index;
+    };
+
+    std::string material;
+    for (int ci = 0; ci < chunkCount; ++ci) {
+        const ObjChunk& c = chunks[ci];
+        size_t switchAt = 0;
+        size_t corner = 0;
+        for (size_t f = 0; f < c.faceSizes.size(); ++f) {
+            while (switchAt < c.materialSwitches.size() && c.materialSwitches[switchAt].first <= (int)f)
+                material = c.materialSwitches[switchAt++].second;
+
+            std::vector<unsigned int>& tris = trianglesByMaterial[material];
+            unsigned int first = 0, prev = 0;
+            bool valid = true;
+            for (int k = 0; k < c.faceSizes[f]; ++k) {
+                const ObjCorner& oc = c.corners[corner + k];
+                int v = resolve(oc.v, (oc.relative & 1) != 0, posBase[ci], (int)positions.size());
+                if (v < 0) { valid = false; break; }
+                int vt = resolve(oc.vt, (oc.relative & 2) != 0, uvBase[ci], (int)uvs.size());
+                int vn = resolve(oc.vn, (oc.relative & 4) != 0, nrmBase[ci], (int)normals.size());
+                unsigned int idx = emit(v, vt, vn);
+                if (k == 0) first = idx;
+                else if (k >= 2) tris.insert(tris.end(), { first, prev, idx });   // fan triangulation
+                prev = idx;
+            }
+            if (!valid) { model.error = "face references a missing vertex"; return; }
+            corner += c.faceSizes[f];
+        }
+        // trailing usemtl with no faces after it still sets the material for the next chunk
+        while (switchAt < c.materialSwitches.size()) material = c.materialSwitches[switchAt++].second;
+    }
+
+    for (auto& group : trianglesByMaterial) {
+        if (group.second.empty()) continue;
+        ModelPart part;
+        part.firstIndex = (unsigned int)mesh.indices.size();
+        part.indexCount = (unsigned int)group.second.size();
+        auto color = mtlColors.find(group.first);
+        if (color != mtlColors.end()) part.color = color->second;
+        mesh.indices.insert(mesh.indices.end(), group.second.begin(), group.second.end());
+        model.parts.push_back(part);
+    }
+    finishModel(model);
+}
+
+// ------------------------------
+// glTF 2.0
+// ------------------------------
+inline bool decodeBase64(const char* s, size_t n, std::vector<unsigned char>& out) {
+    auto val = [](char c) -> int {
+        if (c >= 'A' && c <= 'Z') return c - 'A';
+        if (c >= 'a' && c <= 'z') return c - 'a' + 26;
+        if (c >= '0' && c <= '9') return c - '0' + 52;
+        if (c == '+' || c == '-') return 62;
+        if (c == '/' || c == '_') return 63;
+        return -1;
+    };
+    unsigned int acc = 0;
+    int bits = 0;
+    for (size_t i = 0; i < n && s[i] != '='; ++i) {
+        int v = val(s[i]);
+        if (v < 0) return false;
+        acc = (acc << 6) | (unsigned int)v;
+        bits += 6;
+        if (bits >= 8) { bits -= 8; out.push_back((unsigned char)((acc >> bits) & 0xFF)); }
+    }
+    return true;
+}
+
+struct GltfBuffer {
+    const unsigned char* data = nullptr;
+    size_t size = 0;
+};
+
+struct GltfDoc {
+    JsonValue json;
+    std::vector<GltfBuffer> buffers;
+    std::vector<std::unique_ptr<MappedFile>> mappedBuffers;     // external .bin files
+    std::vector<std::vector<unsigned char>> decodedBuffers;     // data: URIs
+};
+
+// Where an accessor's elements sit in their buffer, checked against it
+struct GltfAccessorView {
+    const unsigned char* data = nullptr;    // first element; nullptr without a bufferView (all zeros)
+    size_t count = 0;
+    size_t stride = 0;
+    int componentType = 0;
+    int compSize = 0;
+    bool normalized = false;
+};
+
+inline int gltfTypeComponents(const std::string& type) {
+    if (type == "SCALAR") return 1;
+    if (type == "VEC2") return 2;
+    if (type == "VEC3") return 3;
+    if (type == "VEC4") return 4;
+    return 0;
+}
+
+// Validates accessor `index` as `components` per element: its type, count
+// and every element inside the buffer (checked without overflow)
+inline bool gltfAccessorView(const GltfDoc& doc, int index, int components, GltfAccessorView& v, std::string& error) {
+    const JsonValue& acc = doc.json["accessors"][index];
+    if (acc.isNull()) { error = "missing accessor"; return false; }
+    if (acc.has("sparse")) { error = "sparse accessors are not supported"; return false; }
+    if (gltfTypeComponents(acc["type"].asString()) != components) { error = "accessor type mismatch"; return false; }
+
+    double count = acc["count"].asNumber(-1.0);
+    if (count < 0.0 || count > (double)INT32_MAX) { error = "bad accessor count"; return false; }
+    v.count = (size_t)count;
+    v.componentType = acc["componentType"].asInt();
+    v.compSize = (v.componentType == 5126 || v.componentType == 5125) ? 4 : (v.componentType == 5123 || v.componentType == 5122) ? 2 : 1;
+    v.normalized = acc["normalized"].type == JsonValue::BOOL && acc["normalized"].boolean;
+    if (!acc.has("bufferView")) return true;
+
+    const JsonValue& view = doc.json["bufferViews"][acc["bufferView"].asInt()];
+    int bufferIndex = view["buffer"].asInt(-1);
+    if (bufferIndex < 0 || bufferIndex >= (int)doc.buffers.size()) { error = "bad buffer index"; return false; }
+    const GltfBuffer& buf = doc.buffers[bufferIndex];
+
+    size_t elemSize = (size_t)v.compSize * components;
+    double viewOffset = view["byteOffset"].asNumber(), accOffset = acc["byteOffset"].asNumber();
+    double stride = view.has("byteStride") ? view["byteStride"].asNumber() : (double)elemSize;
+    if (viewOffset < 0.0 || accOffset < 0.0 || viewOffset + accOffset > (double)buf.size || stride < (double)elemSize || stride > 255.0) {
+        error = "accessor out of range";
+        return false;
+    }
+    size_t base = (size_t)viewOffset + (size_t)accOffset;
+    v.stride = (size_t)stride;
+    if (base > buf.size || elemSize > buf.size - base ||
+        (v.count > 0 && (v.count - 1) > (buf.size - base - elemSize) / v.stride)) {
+        error = "accessor out of range";
+        return false;
+    }
+    v.data = buf.data + base;
+    return true;
+}
+
+// Reads accessor `index` into `out` as floats, `components` per element.
+// Handles float and normalized integer components, interleaved views.
+inline bool gltfReadAccessor(const GltfDoc& doc, int index, int components, std::vector<float>& out, std::string& error) {
+    GltfAccessorView v;
+    if (!gltfAccessorView(doc, index, components, v, error)) return false;
+    out.assign(v.count * components, 0.0f);
+    if (!v.data) return true;       // all zeros per spec
+
+    for (size_t i = 0; i < v.count; ++i) {
+        const unsigned char* e = v.data + v.stride * i;
+        for (int c = 0; c < components; ++c) {
+            const unsigned char* q = e + (size_t)c * v.compSize;
+            float f = 0.0f;
+            switch (v.componentType) {
+            case 5126: memcpy(&f, q, 4); break;
+            case 5125: { uint32_t u; memcpy(&u, q, 4); f = (float)u; break; }
+            case 5123: { uint16_t u; memcpy(&u, q, 2); f = v.normalized ? u / 65535.0f : (float)u; break; }
+            case 5122: { int16_t u; memcpy(&u, q, 2); f = v.normalized ? std::max(u / 32767.0f, -1.0f) : (float)u; break; }
+            case 5121: f = v.normalized ? *q / 255.0f : (float)*q; break;
+            case 5120: { int8_t u = (int8_t)*q; f = v.normalized ? std::max(u / 127.0f, -1.0f) : (float)u; break; }
+            default: error = "unsupported component type"; return false;
+            }
+            out[i * components + c] = f;
+        }
+    }
+    return true;
+}
+
+inline bool gltfReadIndices(const GltfDoc& doc, int index, std::vector<unsigned int>& out, std::string& error) {
+    const JsonValue& acc = doc.json["accessors"][index];
+    int type = acc["componentType"].asInt();
+    if (type != 5121 && type != 5123 && type != 5125) { error = "unsupported index type"; return false; }
+
+    if (type == 5125) {
+        // read raw so large indices keep full precision
+        GltfAccessorView v;
+        if (!gltfAccessorView(doc, index, 1, v, error)) return false;
+        out.assign(v.count, 0u);
+        if (v.data)
+            for (size_t i = 0; i < v.count; ++i) memcpy(&out[i], v.data + v.stride * i, 4);
+        return true;
+    }
+    std::vector<float> tmp;
+    if (!gltfReadAccessor(doc, index, 1, tmp, error)) return false;
+    out.resize(tmp.size());
+    for (size_t i = 0; i < tmp.size(); ++i) out[i] = (unsigned int)tmp[i];
+    return true;
+}
+
+inline glm::mat4 gltfNodeMatrix(const JsonValue& node) {
+    const JsonValue& m = node["matrix"];
+    if (m.isArray() && m.size() == 16) {
+        glm::mat4 r;
+        for (int c = 0; c < 4; ++c)
+            for (int k = 0; k < 4; ++k) r[c][k] = (float)m[c * 4 + k].asNumber();
+        return r;
+    }
+
+    glm::vec3 t(0.0f), s(1.0f);
+    float q[4] = { 0, 0, 0, 1 };
+    const JsonValue& T = node["translation"];
+    const JsonValue& R = node["rotation"];
+    const JsonValue& S = node["scale"];
+    for (int i = 0; i < 3; ++i) {
+        if (T.size() == 3) t[i] = (float)T[i].asNumber();
+        if (S.size() == 3) s[i] = (float)S[i].asNumber(1.0);
+    }
+    if (R.size() == 4) for (int i = 0; i < 4; ++i) q[i] = (float)R[i].asNumber();
+
+    float x = q[0], y = q[1], z = q[2], w = q[3];
+    glm::mat4 r(1.0f);
+    r[0][0] = 1 - 2 * (y * y + z * z); r[0][1] = 2 * (x * y + z * w);     r[0][2] = 2 * (x * z - y * w);
+    r[1][0] = 2 * (x * y - z * w);     r[1][1] = 1 - 2 * (x * x + z * z); r[1][2] = 2 * (y * z + x * w);
+    r[2][0] = 2 * (x * z + y * w);     r[2][1] = 2 * (y * z - x * w);     r[2][2] = 1 - 2 * (x * x + y * y);
+    r[0] *= s.x; r[1] *= s.y; r[2] *= s.z;
+    r[3] = glm::vec4(t, 1.0f);
+    return r;
+}
+
+struct GltfPrimitiveJob {
+    const JsonValue* primitive;
+    glm::mat4 world;
+    MeshData mesh;
+    glm::vec4 color = glm::vec4(1.0f);
+    std::string error;
+};
+
+inline void gltfConvertPrimitive(const GltfDoc& doc, GltfPrimitiveJob& job) {
+    const JsonValue& prim = *job.primitive;
+    if (prim.has("mode") && prim["mode"].asInt() != 4) { job.error = "only triangle primitives are supported"; return; }
+
+    const JsonValue& attrs = prim["attributes"];
+    if (!attrs.has("POSITION")) { job.error = "primitive without POSITION"; return; }
+
+    std::vector<float> pos, nrm, uv;
+    if (!gltfReadAccessor(doc, attrs["POSITION"].asInt(), 3, pos, job.error)) return;
+    if (attrs.has("NORMAL") && !gltfReadAccessor(doc, attrs["NORMAL"].asInt(), 3, nrm, job.error)) return;
+    if (attrs.has("TEXCOORD_0") && !gltfReadAccessor(doc, attrs["TEXCOORD_0"].asInt(), 2, uv, job.error)) return;
+
+    size_t count = pos.size() / 3;
+    glm::mat3 normalMat = glm::transpose(glm::inverse(glm::mat3(job.world)));
+
+    job.mesh.vertices.resize(count * kVertexStride);
+    for (size_t i = 0; i < count; ++i) {
+        glm::vec3 p = glm::vec3(job.world * glm::vec4(pos[i * 3], pos[i * 3 + 1], pos[i * 3 + 2], 1.0f));
+        glm::vec3 n(0.0f);
+        if (!nrm.empty()) {
+            n = normalMat * glm::vec3(nrm[i * 3], nrm[i * 3 + 1], nrm[i * 3 + 2]);
+            float len = glm::length(n);
+            if (len > 0.0f) n /= len;
+        }
+        float* v = &job.mesh.vertices[i * kVertexStride];
+        v[0] = p.x; v[1] = p.y; v[2] = p.z;
+        v[3] = n.x; v[4] = n.y; v[5] = n.z;
+        // glTF UV origin is top-left, the engine loads textures flipped (bottom-left)
+        v[6] = uv.empty() ? 0.0f : uv[i * 2];
+        v[7] = uv.empty() ? 0.0f : 1.0f - uv[i * 2 + 1];
+    }
+
+    if (prim.has("indices")) {
+        if (!gltfReadIndices(doc, prim["indices"].asInt(), job.mesh.indices, job.error)) return;
+        for (unsigned int idx : job.mesh.indices)
+            if (idx >= count) { job.error = "index out of range"; return; }
+    }
+    else {
+        job.mesh.indices.resize(count);
+        for (size_t i = 0; i < count; ++i) job.mesh.indices[i] = (unsigned int)i;
+    }
+
+    // mirrored transforms flip winding
+    if (glm::dot(glm::cross(glm::vec3(job.world[0]), glm::vec3(job.world[1])), glm::vec3(job.world[2])) < 0.0f)
+        for (size_t t = 0; t + 2 < job.mesh.indices.size(); t += 3) std::swap(job.mesh.indices[t + 1], job.mesh.indices[t + 2]);
+
+    if (prim.has("material")) {
+        const JsonValue& f = doc.json["materials"][prim["material"].asInt()]["pbrMetallicRoughness"]["baseColorFactor"];
+        if (f.size() == 4) job.color = glm::vec4((float)f[0].asNumber(), (float)f[1].asNumber(), (float)f[2].asNumber(), (float)f[3].asNumber());
+    }
+}
+
+inline void importGltf(const std::string& path, ImportedModel& model) {
+    MappedFile file;
+    if (!file.open(path)) { model.error = "cannot open file"; return; }
+
+    GltfDoc doc;
+    const unsigned char* bytes = file.data();
+    const char* jsonText = (const char*)bytes;
+    size_t jsonLen = file.size();
+    GltfBuffer glbBin;
+
+    // .glb: 12-byte header, JSON chunk, optional BIN chunk
+    if (file.size() >= 20 && memcmp(bytes, "glTF", 4) == 0) {
+        uint32_t version, chunkLen, chunkType;
+        memcpy(&version, bytes + 4, 4);
+        memcpy(&chunkLen, bytes + 12, 4);
+        memcpy(&chunkType, bytes + 16, 4);
+        if (version != 2 || chunkType != 0x4E4F534Au || 20 + (size_t)chunkLen > file.size()) { model.error = "bad GLB header"; return; }
+        jsonText = (const char*)bytes + 20;
+        jsonLen = chunkLen;
+
+        size_t binAt = 20 + (size_t)chunkLen;
+        if (binAt + 8 <= file.size()) {
+            uint32_t binLen, binType;
+            memcpy(&binLen, bytes + binAt, 4);
+            memcpy(&binType, bytes + binAt + 4, 4);
+            if (binType == 0x004E4942u && binAt + 8 + binLen <= file.size()) {
+                glbBin.data = bytes + binAt + 8;
+                glbBin.size = binLen;
+            }
+        }
+    }
+
+    if (!JsonValue::parse(jsonText, jsonLen, doc.json, model.error)) return;
+
+    const JsonValue& buffers = doc.json["buffers"];
+    for (size_t i = 0; i < buffers.size(); ++i) {
+        const JsonValue& b = buffers[i];
+        GltfBuffer gb;
+        if (!b.has("uri")) gb = glbBin;
+        else {
+            const std::string& uri = b["uri"].asString();
+            if (uri.compare(0, 5, "data:") == 0) {
+                size_t comma = uri.find(',');
+                doc.decodedBuffers.emplace_back();
+                if (comma == std::string::npos || !decodeBase64(uri.c_str() + comma + 1, uri.size() - comma - 1, doc.decodedBuffers.back())) {
+                    model.error = "bad data URI";
+                    return;
+                }
+                gb.data = doc.decodedBuffers.back().data();
+                gb.size = doc.decodedBuffers.back().size();
+            }
+            else {
+                doc.mappedBuffers.emplace_back(new MappedFile());
+                if (!doc.mappedBuffers.back()->open(directoryOf(path) + uri)) { model.error = "cannot open buffer " + uri; return; }
+                gb.data = doc.mappedBuffers.back()->data();
+                gb.size = doc.mappedBuffers.back()->size();
+            }
+        }
+        doc.buffers.push_back(gb);
+    }
+
+    // Flatten the node hierarchy into (primitive, world matrix) jobs
+    std::vector<GltfPrimitiveJob> jobs;
+    const JsonValue& nodes = doc.json["nodes"];
+    const JsonValue& meshes = doc.json["meshes"];
+    std::vector<std::pair<int, glm::mat4>> stack;
+
+    const JsonValue& scene = doc.json["scenes"][doc.json["scene"].asInt(0)];
+    if (scene.has("nodes")) {
+        for (size_t i = 0; i < scene["nodes"].size(); ++i) stack.push_back({ scene["nodes"][i].asInt(), glm::mat4(1.0f) });
+    }
+    else {
+        // no scene: every node that is nobody's child is a root
+        std::vector<bool> isChild(nodes.size(), false);
+        for (size_t i = 0; i < nodes.size(); ++i)
+            for (size_t c = 0; c < nodes[i]["children"].size(); ++c) {
+                int child = nodes[i]["children"][c].asInt();
+                if (child >= 0 && child < (int)nodes.size()) isChild[child] = true;
+            }
+        for (size_t i = 0; i < nodes.size(); ++i)
+            if (!isChild[i]) stack.push_back({ (int)i, glm::mat4(1.0f) });
+    }
+
+    int guard = 0;
+    while (!stack.empty() && guard++ < 100000) {
+        auto top = stack.back();
+        stack.pop_back();
+        if (top.first < 0 || top.first >= (int)nodes.size()) continue;
+        const JsonValue& node = nodes[top.first];
+        glm::mat4 world = top.second * gltfNodeMatrix(node);
+
+        if (node.has("mesh")) {
+            const JsonValue& prims = meshes[node["mesh"].asInt()]["primitives"];
+            for (size_t p = 0; p < prims.size(); ++p) {
+                GltfPrimitiveJob job;
+                job.primitive = &prims[p];
+                job.world = world;
+                jobs.push_back(job);
+            }
+        }
+        const JsonValue& children = node["children"];
+        for (size_t c = 0; c < children.size(); ++c) stack.push_back({ children[c].asInt(), world });
+    }
+
+    JobSystem::instance().parallelFor((int)jobs.size(), 1, [&](int b, int e) {
+        for (int i = b; i < e; ++i) gltfConvertPrimitive(doc, jobs[i]);
+    });
+
+    MeshData& mesh = model.mesh;
+    for (auto& job : jobs) {
+        if (!job.error.empty()) { model.error = job.error; continue; }
+        unsigned int base = (unsigned int)mesh.vertexCount();
+        ModelPart part;
+        part.firstIndex = (unsigned int)mesh.indices.size();
+        part.indexCount = (unsigned int)job.mesh.indices.size();
+        part.color = job.color;
+        mesh.vertices.insert(mesh.vertices.end(), job.mesh.vertices.begin(), job.mesh.vertices.end());
+        for (unsigned int idx : job.mesh.indices) mesh.indices.push_back(base + idx);
+        model.parts.push_back(part);
+    }
+    finishModel(model);
+}
+
+} // namespace modelimport
+
+// ======================================================
+// Entry points
+// ======================================================
+inline ImportedModel importModel(const std::string& path) {
+    ImportedModel model;
+    model.path = path;
+    std::string ext = modelimport::lowerExtension(path);
+    if (ext == "obj") modelimport::importObj(path, model);
+    else if (ext == "gltf" || ext == "glb") modelimport::importGltf(path, model);
+    else model.error = "unknown model format ." + ext;
+    return model;
+}
+
+// Parses on a worker; poll the future from the render thread and upload when ready
+inline std::future<ImportedModel> importModelAsync(const std::string& path) {
+    return JobSystem::instance().submit([path] { return importModel(path); });
+}
+#endif
@@ -0,0 +1,252 @@
+#ifndef OCCLUSION_CULLER_H
+#define OCCLUSION_CULLER_H
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "Bounds.h"
+#include "JobSystem.h"
+#include "Simd.h"
+
+// ======================================================
+// Software occlusion culling (CPU only, no GL)
+// 1. begin(viewProj), then addOccluderBox() for large solid boxes
+// 2. rasterize(): occluder triangles are binned into 32x32 tiles and each
+//    tile is drawn depth-only on a worker, four pixels per SSE op
+// 3. a max-depth pyramid (HiZ) is built over the result
+// 4. isVisible(box) compares the box's nearest depth with the farthest
+//    occluder depth over its screen rectangle
+// Depth is NDC z mapped to [0, 1]; 1 = nothing drawn.
+// ======================================================
+class OcclusionCuller {
+public:
+    static const int kWidth = 256;
+    static const int kHeight = 128;
+    static const int kTile = 32;
+    static const int kTilesX = kWidth / kTile;
+    static const int kTilesY = kHeight / kTile;
+    static const int kLevels = 9;           // 256x128 down to 1x1
+
+    OcclusionCuller() {
+        for (int l = 0; l < kLevels; ++l)
+            levels[l].assign((size_t)levelWidth(l) * levelHeight(l), 1.0f);
+    }
+
+    void begin(const glm::mat4& viewProj) {
+        vp = viewProj;
+        tris.clear();
+    }
+
+    // Unit cube (+-0.5) under `world`, the shape of every cube entity
+    void addOccluderBox(const glm::mat4& world) {
+        static const float c[8][3] = {
+            { -0.5f, -0.5f, -0.5f }, { 0.5f, -0.5f, -0.5f }, { 0.5f, 0.5f, -0.5f }, { -0.5f, 0.5f, -0.5f },
+            { -0.5f, -0.5f,  0.5f }, { 0.5f, -0.5f,  0.5f }, { 0.5f, 0.5f,  0.5f }, { -0.5f, 0.5f,  0.5f } };
+        static const int faces[12][3] = {
+            { 0, 2, 1 }, { 0, 3, 2 }, { 4, 5, 6 }, { 4, 6, 7 }, { 0, 1, 5 }, { 0, 5, 4 },
+            { 3, 6, 2 }, { 3, 7, 6 }, { 0, 4, 7 }, { 0, 7, 3 }, { 1, 2, 6 }, { 1, 6, 5 } };
+
+        glm::mat4 m = vp * world;
+        glm::vec4 clip[8];
+        for (int i = 0; i < 8; ++i) clip[i] = m * glm::vec4(c[i][0], c[i][1], c[i][2], 1.0f);
+        for (const int* f : faces) addClipTriangle(clip[f[0]], clip[f[1]], clip[f[2]]);
+    }
+
+    int occluderTriangles() const { return (int)tris.size(); }
+
+    void rasterize() {
+        for (std::vector<int>& bin : bins) bin.clear();
+        for (int t = 0; t < (int)tris.size(); ++t) {
+            const ScreenTri& tri = tris[t];
+            for (int ty = tri.minY / kTile; ty <= tri.maxY / kTile; ++ty)
+                for (int tx = tri.minX / kTile; tx <= tri.maxX / kTile; ++tx)
+                    bins[ty * kTilesX + tx].push_back(t);
+        }
+
+        // One job per tile: tiles own disjoint depth rows, so no locking
+        JobSystem::instance().parallelFor(kTilesX * kTilesY, 1, [&](int begin, int end) {
+            for (int tile = begin; tile < end; ++tile) rasterizeTile(tile);
+        });
+
+        buildHiZ();
+    }
+
+    // Conservative: true unless the whole box is behind drawn occluders
+    bool isVisible(const Aabb& box) const {
+        float minX = FLT_MAX, minY = FLT_MAX, maxX = -FLT_MAX, maxY = -FLT_MAX, minZ = FLT_MAX;
+        for (int i = 0; i < 8; ++i) {
+            glm::vec3 p((i & 1) ? box.max.x : box.min.x, (i & 2) ? box.max.y : box.min.y, (i & 4) ? box.max.z : box.min.z);
+            glm::vec4 clip = vp * glm::vec4(p, 1.0f);
+            if (clip.w <= 1e-5f) return true;   // crosses the eye plane
+            float inv = 1.0f / clip.w;
+            float sx = (clip.x * inv * 0.5f + 0.5f) * kWidth;
+            float sy = (clip.y * inv * 0.5f + 0.5f) * kHeight;
+            minX = std::min(minX, sx); maxX = std::max(maxX, sx);
+            minY = std::min(minY, sy); maxY = std::max(maxY, sy);
+            minZ = std::min(minZ, clip.z * inv * 0.5f + 0.5f);
+        }
+        if (minZ <= 0.0f) return true;          // in front of the near plane
+        if (maxX < 0.0f || maxY < 0.0f || minX >= kWidth || minY >= kHeight) return true;  // frustum culling's job
+
+        int x0 = std::max(0, (int)minX), x1 = std::min(kWidth - 1, (int)maxX);
+        int y0 = std::max(0, (int)minY), y1 = std::min(kHeight - 1, (int)maxY);
+
+        // Coarsest level where the rectangle spans at most 4x4 texels
+        int l = 0;
+        while (l < kLevels - 1 && ((x1 >> l) - (x0 >> l) > 3 || (y1 >> l) - (y0 >> l) > 3)) ++l;
+
+        const float* d = levels[l].data();
+        int w = levelWidth(l);
+        float farthest = 0.0f;
+        for (int y = y0 >> l; y <= (y1 >> l); ++y)
+            for (int x = x0 >> l; x <= (x1 >> l); ++x)
+                farthest = std::max(farthest, d[y * w + x]);
+        return minZ <= farthest;
+    }
+
+    // Level 0 is the full-resolution depth buffer (row 0 = bottom of the screen)
+    const float* depth(int level = 0) const { return levels[level].data(); }
+    static int levelWidth(int l) { return std::max(1, kWidth >> l); }
+    static int levelHeight(int l) { return std::max(1, kHeight >> l); }
+
+private:
+    // Screen-space triangle with edge functions and depth plane ready for
+    // evaluation at pixel centers: inside when all three edges are >= 0
+    struct ScreenTri {
+        float ea[3], eb[3], ec[3];      // edge i: ea*x + eb*y + ec
+        float za, zb, zc;               // depth: za*x + zb*y + zc
+        int minX, minY, maxX, maxY;     // pixel bounds, clamped to the screen
+    };
+
+    glm::mat4 vp = glm::mat4(1.0f);
+    std::vector<ScreenTri> tris;
+    std::vector<int> bins[kTilesX * kTilesY];
+    std::vector<float> levels[kLevels];
+
+    // Clips against the near plane (z >= -w), then maps to pixels
+    void addClipTriangle(const glm::vec4& a, const glm::vec4& b, const glm::vec4& c) {
+        glm::vec4 in[3] = { a, b, c };
+        glm::vec4 poly[4];
+        int n = 0;
+        for (int i = 0; i < 3; ++i) {
+            const glm::vec4& p = in[i];
+            const glm::vec4& q = in[(i + 1) % 3];
+            float dp = p.z + p.w, dq = q.z + q.w;
+            if (dp >= 0.0f) poly[n++] = p;
+            if ((dp >= 0.0f) != (dq >= 0.0f)) poly[n++] = p + (q - p) * (dp / (dp - dq));
+        }
+        if (n < 3) return;
+
+        glm::vec3 s[4];
+        for (int i = 0; i < n; ++i) {
+            float inv = 1.0f / poly[i].w;
+            s[i] = glm::vec3((poly[i].x * inv * 0.5f + 0.5f) * kWidth,
+                             (poly[i].y * inv * 0.5f + 0.5f) * kHeight,
+                             poly[i].z * inv * 0.5f + 0.5f);
+        }
+        addScreenTriangle(s[0], s[1], s[2]);
+        if (n == 4) addScreenTriangle(s[0], s[2], s[3]);
+    }
+
+    void addScreenTriangle(glm::vec3 v0, glm::vec3 v1, glm::vec3 v2) {
+        float area = (v1.x - v0.x) * (v2.y - v0.y) - (v2.x - v0.x) * (v1.y - v0.y);
+        if (std::fabs(area) < 1e-6f) return;
+        if (area < 0.0f) {                  // both windings are drawn
+            std::swap(v1, v2);
+            area = -area;
+        }
+
+        ScreenTri t;
+        t.minX = std::max(0, (int)std::floor(std::min(v0.x, std::min(v1.x, v2.x))));
+        t.minY = std::max(0, (int)std::floor(std::min(v0.y, std::min(v1.y, v2.y))));
+        t.maxX = std::min(kWidth - 1, (int)std::ceil(std::max(v0.x, std::max(v1.x, v2.x))));
+        t.maxY = std::min(kHeight - 1, (int)std::ceil(std::max(v0.y, std::max(v1.y, v2.y))));
+        if (t.minX > t.maxX || t.minY > t.maxY) return;
+
+        const glm::vec3* v[3] = { &v0, &v1, &v2 };
+        for (int i = 0; i < 3; ++i) {
+            const glm::vec3& p = *v[i];
+            const glm::vec3& q = *v[(i + 1) % 3];
+            t.ea[i] = -(q.y - p.y);
+            t.eb[i] = q.x - p.x;
+            t.ec[i] = (q.y - p.y) * p.x - (q.x - p.x) * p.y;
+        }
+
+        float dx1 = v1.x - v0.x, dy1 = v1.y - v0.y, dz1 = v1.z - v0.z;
+        float dx2 = v2.x - v0.x, dy2 = v2.y - v0.y, dz2 = v2.z - v0.z;
+        t.za = (dz1 * dy2 - dz2 * dy1) / area;
+        t.zb = (dx1 * dz2 - dx2 * dz1) / area;
+        t.zc = v0.z - t.za * v0.x - t.zb * v0.y;
+        tris.push_back(t);
+    }
+
+    void rasterizeTile(int tile) {
+        int tx0 = (tile % kTilesX) * kTile, ty0 = (tile / kTilesX) * kTile;
+        float* depth = levels[0].data();
+
+        for (int y = ty0; y < ty0 + kTile; ++y)
+            std::fill(depth + y * kWidth + tx0, depth + y * kWidth + tx0 + kTile, 1.0f);
+
+        for (int ti : bins[tile]) {
+            const ScreenTri& t = tris[ti];
+            int x0 = std::max(t.minX, tx0) & ~3;    // tiles are multiples of 4 wide
+            int x1 = std::min(t.maxX, tx0 + kTile - 1);
+            int y0 = std::max(t.minY, ty0), y1 = std::min(t.maxY, ty0 + kTile - 1);
+
+            for (int y = y0; y <= y1; ++y) {
+                float py = y + 0.5f;
+                float* row = depth + y * kWidth;
+#if CAFE_SSE
+                __m128 e0y = _mm_set1_ps(t.eb[0] * py + t.ec[0]);
+                __m128 e1y = _mm_set1_ps(t.eb[1] * py + t.ec[1]);
+                __m128 e2y = _mm_set1_ps(t.eb[2] * py + t.ec[2]);
+                __m128 zy = _mm_set1_ps(t.zb * py + t.zc);
+                __m128 a0 = _mm_set1_ps(t.ea[0]), a1 = _mm_set1_ps(t.ea[1]), a2 = _mm_set1_ps(t.ea[2]);
+                __m128 za = _mm_set1_ps(t.za);
+                __m128 zero = _mm_setzero_ps();
+                for (int x = x0; x <= x1; x += 4) {
+                    __m128 px = _mm_add_ps(_mm_set1_ps(x + 0.5f), _mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f));
+                    __m128 in = _mm_and_ps(_mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(a0, px), e0y), zero),
+                                _mm_and_ps(_mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(a1, px), e1y), zero),
+                                           _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(a2, px), e2y), zero)));
+                    if (_mm_movemask_ps(in) == 0) continue;
+                    __m128 z = _mm_add_ps(_mm_mul_ps(za, px), zy);
+                    __m128 d = _mm_loadu_ps(row + x);
+                    __m128 nearer = _mm_min_ps(d, z);
+                    _mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(in, nearer), _mm_andnot_ps(in, d)));
+                }
+#else
+                for (int x = x0; x <= x1; ++x) {
+                    float px = x + 0.5f;
+                    if (t.ea[0] * px + t.eb[0] * py + t.ec[0] < 0.0f) continue;
+                    if (t.ea[1] * px + t.eb[1] * py + t.ec[1] < 0.0f) continue;
+                    if (t.ea[2] * px + t.eb[2] * py + t.ec[2] < 0.0f) continue;
+                    row[x] = std::min(row[x], t.za * px + t.zb * py + t.zc);
+                }
+#endif
+            }
+        }
+    }
+
+    // Each texel keeps the farthest depth of the 2x2 below it
+    void buildHiZ() {
+        for (int l = 1; l < kLevels; ++l) {
+            const float* src = levels[l - 1].data();
+            float* dst = levels[l].data();
+            int sw = levelWidth(l - 1), sh = levelHeight(l - 1);
+            int w = levelWidth(l), h = levelHeight(l);
+            for (int y = 0; y < h; ++y) {
+                for (int x = 0; x < w; ++x) {
+                    int sx = std::min(2 * x + 1, sw - 1), sy = std::min(2 * y + 1, sh - 1);
+                    float a = std::max(src[2 * y * sw + 2 * x], src[2 * y * sw + sx]);
+                    float b = std::max(src[sy * sw + 2 * x], src[sy * sw + sx]);
+                    dst[y * w + x] = std::max(a, b);
+                }
+            }
+        }
+    }
+};
+#endif
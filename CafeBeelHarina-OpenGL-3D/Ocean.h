@@ -0,0 +1,308 @@
+#ifndef OCEAN_H
+#define OCEAN_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "JobSystem.h"
+#include "Simd.h"
+
+// ======================================================
+// Spectral water (Tessendorf) on the CPU
+// A Phillips spectrum h0(k) is drawn once; every frame
+//   H(k, t) = h0(k) e^(iwt) + conj(h0(-k)) e^(-iwt),  w = sqrt(g |k|)
+// is inverse transformed into a kTileSize-metre periodic height field. H is
+// Hermitian, so two real fields share one complex transform:
+//   IFFT(H + i * ikx H) = height + i * slope x,   IFFT(ikz H) = slope z
+// The 2D transforms run as column passes (four SSE lanes, sixteen columns
+// per job) with a transpose between them, on the job system.
+// Results go out as RGBA32F (height, normal) through two PBO / texture
+// pairs used in turn, so a frame never writes the texture the previous
+// one is still sampling.
+// ======================================================
+class Ocean {
+public:
+    static constexpr int kMinResolution = 64;
+    static constexpr int kMaxResolution = 512;
+    static constexpr float kTileSize = 32.0f;       // metres per period
+    static constexpr float kHeightRms = 0.05f;      // metres, a calm river
+    static constexpr float kWindSpeed = 4.0f;       // m/s
+    static constexpr float kGravity = 9.81f;
+
+    int resolution = 0;
+    double simulateMs = 0.0;    // spectrum + transforms + packing, last frame
+
+    bool ready() const { return resolution > 0; }
+    unsigned int texture() const { return textures[front]; }
+    float texelSize() const { return kTileSize / (float)resolution; }
+
+    // Power of two in [kMinResolution, kMaxResolution]
+    static int clampResolution(int n) {
+        int r = kMinResolution;
+        while (r < n && r < kMaxResolution) r *= 2;
+        return r;
+    }
+
+    void create(int n) {
+        release();
+        resolution = clampResolution(n);
+        if (resolution != n) std::cout << "Ocean: resolution " << n << " -> " << resolution << "\n";
+        const int N = resolution;
+        size_t cells = (size_t)N * N;
+        for (std::vector<float>* v : { &h0Re, &h0Im, &h0cRe, &h0cIm, &omega, &aRe, &aIm, &bRe, &bIm, &scratchRe, &scratchIm })
+            v->assign(cells, 0.0f);
+
+        twRe.resize(N / 2);
+        twIm.resize(N / 2);
+        for (int k = 0; k < N / 2; ++k) {
+            double a = 6.283185307179586 * k / N;
+            twRe[k] = (float)std::cos(a);     // e^(+i): inverse transform
+            twIm[k] = (float)std::sin(a);
+        }
+        bitReverse.resize(N);
+        int bits = 0;
+        while ((1 << bits) < N) ++bits;
+        for (int i = 0; i < N; ++i) {
+            int r = 0;
+            for (int b = 0; b < bits; ++b) r |= ((i >> b) & 1) << (bits - 1 - b);
+            bitReverse[i] = r;
+        }
+
+        buildSpectrum();
+
+        glGenTextures(2, textures);
+        glGenBuffers(2, pbos);
+        for (int i = 0; i < 2; ++i) {
+            glBindTexture(GL_TEXTURE_2D, textures[i]);
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, N, N, 0, GL_RGBA, GL_FLOAT, nullptr);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            glGenerateMipmap(GL_TEXTURE_2D);
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbos[i]);
+            glBufferData(GL_PIXEL_UNPACK_BUFFER, (GLsizeiptr)cells * 4 * sizeof(float), nullptr, GL_STREAM_DRAW);
+        }
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        front = 0;
+    }
+
+    // Simulates time t straight into the next PBO and uploads it
+    void update(float t) {
+        if (!ready()) return;
+        const int N = resolution;
+        int back = front ^ 1;
+        auto start = std::chrono::high_resolution_clock::now();
+
+        evaluateSpectrum(t);
+        transform2D(aRe, aIm);
+        transform2D(bRe, bIm);
+
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbos[back]);
+        float* out = (float*)glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, (GLsizeiptr)N * N * 4 * sizeof(float),
+                                              GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+        if (out) pack(out);
+        bool mapped = out && glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER) == GL_TRUE;
+        simulateMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+        if (mapped) {
+            glBindTexture(GL_TEXTURE_2D, textures[back]);
+            glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, N, N, GL_RGBA, GL_FLOAT, (void*)0);
+            glGenerateMipmap(GL_TEXTURE_2D);
+            front = back;
+        }
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    }
+
+    void release() {
+        if (textures[0]) glDeleteTextures(2, textures);
+        if (pbos[0]) glDeleteBuffers(2, pbos);
+        textures[0] = textures[1] = pbos[0] = pbos[1] = 0;
+        resolution = 0;
+    }
+
+private:
+    unsigned int textures[2] = { 0, 0 };
+    unsigned int pbos[2] = { 0, 0 };
+    int front = 0;
+
+    std::vector<float> h0Re, h0Im, h0cRe, h0cIm, omega;     // h0(k), conj(h0(-k)), w(k)
+    std::vector<float> aRe, aIm, bRe, bIm;                  // per-frame transforms
+    std::vector<float> scratchRe, scratchIm;                // transpose target
+    std::vector<float> twRe, twIm;
+    std::vector<int> bitReverse;
+
+    // Wave number of array index i (negative frequencies wrap to the top half)
+    float waveNumber(int i) const {
+        int m = i < resolution / 2 ? i : i - resolution;
+        return 6.2831853f * (float)m / kTileSize;
+    }
+
+    void buildSpectrum() {
+        const int N = resolution;
+        const glm::vec2 wind = glm::normalize(glm::vec2(1.0f, 0.3f));
+        const float largest = kWindSpeed * kWindSpeed / kGravity;   // biggest wave from this wind
+        const float smallest = largest * 0.001f;
+        std::mt19937 rng(7);
+        std::normal_distribution<float> gauss(0.0f, 1.0f);
+
+        double variance = 0.0;
+        for (int z = 0; z < N; ++z)
+            for (int x = 0; x < N; ++x) {
+                size_t i = (size_t)z * N + x;
+                float xi = gauss(rng), yi = gauss(rng);
+                glm::vec2 k(waveNumber(x), waveNumber(z));
+                float len = glm::length(k);
+                // No DC term; Nyquist rows / columns have no -k partner
+                if (len < 1e-6f || x == N / 2 || z == N / 2) continue;
+                float align = glm::dot(k / len, wind);
+                float phillips = std::exp(-1.0f / (len * len * largest * largest)) / (len * len * len * len)
+                               * align * align * std::exp(-len * len * smallest * smallest);
+                float a = std::sqrt(phillips * 0.5f);
+                h0Re[i] = xi * a;
+                h0Im[i] = yi * a;
+                omega[i] = std::sqrt(kGravity * len);
+                variance += 2.0 * (double)phillips;     // E|h0|^2 for k and -k
+            }
+
+        // Scale to the wanted height instead of tuning the Phillips constant
+        float s = variance > 0.0 ? kHeightRms / (float)std::sqrt(variance) : 0.0f;
+        for (size_t i = 0; i < h0Re.size(); ++i) {
+            h0Re[i] *= s;
+            h0Im[i] *= s;
+        }
+        for (int z = 0; z < N; ++z)
+            for (int x = 0; x < N; ++x) {
+                size_t i = (size_t)z * N + x;
+                size_t j = (size_t)((N - z) % N) * N + (N - x) % N;
+                h0cRe[i] = h0Re[j];
+                h0cIm[i] = -h0Im[j];
+            }
+    }
+
+    void evaluateSpectrum(float t) {
+        const int N = resolution;
+        JobSystem::instance().parallelFor(N, std::max(1, N / 16), [&](int z0, int z1) {
+            for (int z = z0; z < z1; ++z) {
+                float kz = waveNumber(z);
+                for (int x = 0; x < N; ++x) {
+                    size_t i = (size_t)z * N + x;
+                    float kx = waveNumber(x);
+                    float c = std::cos(omega[i] * t), s = std::sin(omega[i] * t);
+                    float hr = (h0Re[i] + h0cRe[i]) * c + (h0cIm[i] - h0Im[i]) * s;
+                    float hi = (h0Im[i] + h0cIm[i]) * c + (h0Re[i] - h0cRe[i]) * s;
+                    // H + i * (ikx H) = (1 - kx) H
+                    aRe[i] = (1.0f - kx) * hr;
+                    aIm[i] = (1.0f - kx) * hi;
+                    // ikz H
+                    bRe[i] = -kz * hi;
+                    bIm[i] = kz * hr;
+                }
+            }
+        });
+    }
+
+    // Inverse 2D transform in place: columns, transpose, columns, transpose
+    void transform2D(std::vector<float>& re, std::vector<float>& im) {
+        columnPasses(re.data(), im.data());
+        transpose(re, im);
+        columnPasses(re.data(), im.data());
+        transpose(re, im);
+    }
+
+    static constexpr int kColumnsPerJob = 16;
+
+    // Radix-2 transform of every column; lanes are neighbouring columns
+    void columnPasses(float* re, float* im) const {
+        const int N = resolution;
+        const int groups = N / kColumnsPerJob;
+        JobSystem::instance().parallelFor(groups, 1, [&](int g0, int g1) {
+            for (int g = g0; g < g1; ++g) {
+                int c0 = g * kColumnsPerJob;
+                for (int r = 0; r < N; ++r) {
+                    int rr = bitReverse[r];
+                    if (rr <= r) continue;
+                    std::swap_ranges(re + (size_t)r * N + c0, re + (size_t)r * N + c0 + kColumnsPerJob, re + (size_t)rr * N + c0);
+                    std::swap_ranges(im + (size_t)r * N + c0, im + (size_t)r * N + c0 + kColumnsPerJob, im + (size_t)rr * N + c0);
+                }
+                for (int len = 2; len <= N; len <<= 1) {
+                    int half = len / 2, step = N / len;
+                    for (int i = 0; i < N; i += len)
+                        for (int j = 0; j < half; ++j)
+                            butterfly(re + (size_t)(i + j) * N + c0, im + (size_t)(i + j) * N + c0,
+                                      re + (size_t)(i + j + half) * N + c0, im + (size_t)(i + j + half) * N + c0,
+                                      twRe[j * step], twIm[j * step]);
+                }
+            }
+        });
+    }
+
+    // a, b <- a + w b, a - w b over kColumnsPerJob lanes
+    static void butterfly(float* aR, float* aI, float* bR, float* bI, float wr, float wi) {
+#if CAFE_SSE
+        __m128 vr = _mm_set1_ps(wr), vi = _mm_set1_ps(wi);
+        for (int c = 0; c < kColumnsPerJob; c += 4) {
+            __m128 br = _mm_loadu_ps(bR + c), bi = _mm_loadu_ps(bI + c);
+            __m128 tr = _mm_sub_ps(_mm_mul_ps(br, vr), _mm_mul_ps(bi, vi));
+            __m128 ti = _mm_add_ps(_mm_mul_ps(br, vi), _mm_mul_ps(bi, vr));
+            __m128 ar = _mm_loadu_ps(aR + c), ai = _mm_loadu_ps(aI + c);
+            _mm_storeu_ps(bR + c, _mm_sub_ps(ar, tr));
+            _mm_storeu_ps(bI + c, _mm_sub_ps(ai, ti));
+            _mm_storeu_ps(aR + c, _mm_add_ps(ar, tr));
+            _mm_storeu_ps(aI + c, _mm_add_ps(ai, ti));
+        }
+#else
+        for (int c = 0; c < kColumnsPerJob; ++c) {
+            float tr = bR[c] * wr - bI[c] * wi;
+            float ti = bR[c] * wi + bI[c] * wr;
+            bR[c] = aR[c] - tr;
+            bI[c] = aI[c] - ti;
+            aR[c] += tr;
+            aI[c] += ti;
+        }
+#endif
+    }
+
+    // Blocked, into the scratch arrays, then swapped in
+    void transpose(std::vector<float>& re, std::vector<float>& im) {
+        const int N = resolution;
+        const int B = kColumnsPerJob;
+        JobSystem::instance().parallelFor(N / B, 1, [&](int b0, int b1) {
+            for (int by = b0; by < b1; ++by)
+                for (int bx = 0; bx < N / B; ++bx)
+                    for (int y = by * B; y < by * B + B; ++y)
+                        for (int x = bx * B; x < bx * B + B; ++x) {
+                            scratchRe[(size_t)x * N + y] = re[(size_t)y * N + x];
+                            scratchIm[(size_t)x * N + y] = im[(size_t)y * N + x];
+                        }
+        });
+        re.swap(scratchRe);
+        im.swap(scratchIm);
+    }
+
+    // RGBA = height, normal from the slopes
+    void pack(float* out) const {
+        const int N = resolution;
+        JobSystem::instance().parallelFor(N, std::max(1, N / 16), [&](int z0, int z1) {
+            for (int z = z0; z < z1; ++z)
+                for (int x = 0; x < N; ++x) {
+                    size_t i = (size_t)z * N + x;
+                    glm::vec3 n = glm::normalize(glm::vec3(-aIm[i], 1.0f, -bRe[i]));
+                    float* o = out + i * 4;
+                    o[0] = aRe[i];
+                    o[1] = n.x;
+                    o[2] = n.y;
+                    o[3] = n.z;
+                }
+        });
+    }
+};
+#endif
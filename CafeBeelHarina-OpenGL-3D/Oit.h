@@ -0,0 +1,117 @@
+#ifndef OIT_H
+#define OIT_H
+
+#include <glad/glad.h>
+
+#include <iostream>
+
+#include "Shader.h"
+
+// ======================================================
+// Weighted blended order-independent transparency
+// Glass goes into two targets instead of the frame, in any order:
+//   accum  (RGBA16F): rgb = sum of colour * alpha * weight,
+//                     a   = product of (1 - alpha), the revealage
+//   weight (R16F)   : r   = sum of alpha * weight
+// One blend function serves both (GL 3.3 has no per-target blending):
+// colour channels add, alpha multiplies by (1 - alpha). The composite then
+// lays average colour over the frame with coverage 1 - revealage.
+// Depth is copied from the frame first, so opaque geometry still hides glass.
+// ======================================================
+class OitTarget {
+public:
+    unsigned int fbo = 0, accum = 0, weight = 0, depth = 0;
+    int width = 0, height = 0;
+
+    bool create(int w, int h) {
+        release();
+        width = w;
+        height = h;
+
+        accum = texture(GL_RGBA16F, GL_RGBA, GL_FLOAT);
+        weight = texture(GL_R16F, GL_RED, GL_FLOAT);
+        depth = texture(GL_DEPTH_COMPONENT24, GL_DEPTH_COMPONENT, GL_UNSIGNED_INT);
+
+        glGenFramebuffers(1, &fbo);
+        glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, accum, 0);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, weight, 0);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, depth, 0);
+        const GLenum buffers[2] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
+        glDrawBuffers(2, buffers);
+
+        GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        if (status != GL_FRAMEBUFFER_COMPLETE) {
+            std::cout << "ERROR::OIT::FRAMEBUFFER_INCOMPLETE: 0x" << std::hex << status << std::dec << std::endl;
+            release();
+            return false;
+        }
+        return true;
+    }
+
+    // Takes the current framebuffer's depth and redirects drawing into the
+    // targets with accumulation blending and no depth writes
+    void begin() {
+        glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &target);
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, (unsigned int)target);
+        glBindTexture(GL_TEXTURE_2D, depth);
+        glCopyTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, 0, 0, width, height);
+
+        glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+        const float accumClear[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+        const float weightClear[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+        glClearBufferfv(GL_COLOR, 0, accumClear);
+        glClearBufferfv(GL_COLOR, 1, weightClear);
+
+        glEnable(GL_BLEND);
+        glBlendFuncSeparate(GL_ONE, GL_ONE, GL_ZERO, GL_ONE_MINUS_SRC_ALPHA);
+        glDepthMask(GL_FALSE);
+    }
+
+    // Back to the frame, resolved over it with a fullscreen triangle
+    void composite(Shader& shader, unsigned int fullscreenVao) {
+        glBindFramebuffer(GL_FRAMEBUFFER, (unsigned int)target);
+        glDepthMask(GL_TRUE);
+        glDisable(GL_DEPTH_TEST);
+        glBlendFunc(GL_ONE_MINUS_SRC_ALPHA, GL_SRC_ALPHA);
+
+        shader.use();
+        shader.setInt("uAccum", 0);
+        shader.setInt("uWeight", 1);
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_2D, weight);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, accum);
+        glBindVertexArray(fullscreenVao);
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+        glBindVertexArray(0);
+
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        glEnable(GL_DEPTH_TEST);
+    }
+
+    void release() {
+        if (fbo) glDeleteFramebuffers(1, &fbo);
+        for (unsigned int* t : { &accum, &weight, &depth })
+            if (*t) glDeleteTextures(1, t);
+        fbo = accum = weight = depth = 0;
+        width = height = 0;
+    }
+
+private:
+    GLint target = 0;
+
+    unsigned int texture(GLenum internalFormat, GLenum format, GLenum type) const {
+        unsigned int t;
+        glGenTextures(1, &t);
+        glBindTexture(GL_TEXTURE_2D, t);
+        glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, format, type, nullptr);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        return t;
+    }
+};
+#endif
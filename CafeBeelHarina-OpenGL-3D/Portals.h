@@ -0,0 +1,152 @@
+#ifndef PORTALS_H
+#define PORTALS_H
+
+#include <algorithm>
+#include <vector>
+#include <glm/glm.hpp>
+
+#include "Bounds.h"
+
+// ======================================================
+// Cells and portals
+// Cells are world boxes (a pavilion, the walkway, the open deck); portals
+// are the openings between them. From the camera's cell the walk goes
+// through every portal whose screen rectangle overlaps the current one,
+// narrowing it each step. A cell's result is the union of the rectangles
+// it was reached with; cells never reached show nothing.
+// Rectangles are in NDC: (x0, y0, x1, y1), empty when x0 > x1.
+// ======================================================
+struct PortalView {
+    int cameraCell = -1;                // -1: camera in no cell, portals not used
+    std::vector<glm::vec4> rect;        // per cell
+    int reachable = 0;
+
+    bool sees(int cell) const { return rect[cell].x <= rect[cell].z; }
+};
+
+class CellPortalGraph {
+public:
+    static const int kMaxDepth = 8;
+
+    struct Cell {
+        Aabb bounds;
+        std::vector<int> portals;
+    };
+    struct Portal {
+        int a, b;
+        Aabb rect;                      // flat along one axis
+    };
+
+    std::vector<Cell> cells;
+    std::vector<Portal> portals;
+
+    bool empty() const { return cells.empty(); }
+
+    void clear() {
+        cells.clear();
+        portals.clear();
+    }
+
+    int addCell(const Aabb& bounds) {
+        Cell c;
+        c.bounds = bounds;
+        cells.push_back(c);
+        return (int)cells.size() - 1;
+    }
+
+    void addPortal(int a, int b, const Aabb& rect) {
+        int id = (int)portals.size();
+        portals.push_back({ a, b, rect });
+        cells[a].portals.push_back(id);
+        cells[b].portals.push_back(id);
+    }
+
+    // Smallest cell containing p (cells may nest, e.g. pavilions in the deck)
+    int findCell(const glm::vec3& p) const { return smallest([&](const Aabb& c) { return c.contains(p); }); }
+
+    // Smallest cell holding the whole box; -1 (always frustum-tested) for
+    // things that span cells, like floors and static batches
+    int cellOf(const Aabb& b) const {
+        const float pad = 0.15f;    // glass walls sit on cell borders
+        return smallest([&](const Aabb& c) { return c.contains(b.min, pad) && c.contains(b.max, pad); });
+    }
+
+    void computeView(const glm::mat4& viewProj, const glm::vec3& eye, PortalView& v) const {
+        v.rect.assign(cells.size(), glm::vec4(1.0f, 1.0f, -1.0f, -1.0f));
+        v.reachable = 0;
+        v.cameraCell = findCell(eye);
+        if (v.cameraCell < 0) return;
+
+        std::vector<int> path;
+        walk(v.cameraCell, glm::vec4(-1.0f, -1.0f, 1.0f, 1.0f), viewProj, eye, path, v);
+        for (size_t c = 0; c < cells.size(); ++c) v.reachable += v.sees((int)c);
+    }
+
+private:
+    template <class Pred>
+    int smallest(Pred&& inside) const {
+        int best = -1;
+        float bestVolume = 0.0f;
+        for (int c = 0; c < (int)cells.size(); ++c) {
+            if (!inside(cells[c].bounds)) continue;
+            glm::vec3 d = cells[c].bounds.max - cells[c].bounds.min;
+            float volume = d.x * d.y * d.z;
+            if (best < 0 || volume < bestVolume) {
+                best = c;
+                bestVolume = volume;
+            }
+        }
+        return best;
+    }
+
+    static bool contains(const glm::vec4& outer, const glm::vec4& r) {
+        return outer.x <= outer.z && outer.x <= r.x && outer.y <= r.y && outer.z >= r.z && outer.w >= r.w;
+    }
+
+    void walk(int cell, const glm::vec4& rect, const glm::mat4& vp, const glm::vec3& eye,
+              std::vector<int>& path, PortalView& v) const {
+        glm::vec4& r = v.rect[cell];
+        if (r.x > r.z) r = rect;
+        else r = glm::vec4(std::min(r.x, rect.x), std::min(r.y, rect.y), std::max(r.z, rect.z), std::max(r.w, rect.w));
+        if ((int)path.size() >= kMaxDepth) return;
+
+        path.push_back(cell);
+        for (int pi : cells[cell].portals) {
+            const Portal& p = portals[pi];
+            int next = p.a == cell ? p.b : p.a;
+            if (std::find(path.begin(), path.end(), next) != path.end()) continue;
+
+            glm::vec4 pr;
+            if (!project(p.rect, vp, eye, pr)) continue;
+            pr = glm::vec4(std::max(pr.x, rect.x), std::max(pr.y, rect.y), std::min(pr.z, rect.z), std::min(pr.w, rect.w));
+            if (pr.x > pr.z || pr.y > pr.w) continue;
+            if (contains(v.rect[next], pr)) continue;   // nothing new through here
+            walk(next, pr, vp, eye, path, v);
+        }
+        path.pop_back();
+    }
+
+    // Screen bounds of a portal; false when it is entirely behind the eye.
+    // A portal the eye is standing in (or that crosses the eye plane) covers
+    // the whole screen.
+    static bool project(const Aabb& portal, const glm::mat4& vp, const glm::vec3& eye, glm::vec4& out) {
+        if (portal.contains(eye, 0.2f)) {
+            out = glm::vec4(-1.0f, -1.0f, 1.0f, 1.0f);
+            return true;
+        }
+
+        out = glm::vec4(1e30f, 1e30f, -1e30f, -1e30f);
+        int behind = 0;
+        for (int i = 0; i < 8; ++i) {
+            glm::vec3 p((i & 1) ? portal.max.x : portal.min.x, (i & 2) ? portal.max.y : portal.min.y, (i & 4) ? portal.max.z : portal.min.z);
+            glm::vec4 clip = vp * glm::vec4(p, 1.0f);
+            if (clip.w <= 1e-4f) { ++behind; continue; }
+            glm::vec2 ndc = glm::vec2(clip.x, clip.y) / clip.w;
+            out = glm::vec4(std::min(out.x, ndc.x), std::min(out.y, ndc.y), std::max(out.z, ndc.x), std::max(out.w, ndc.y));
+        }
+        if (behind == 8) return false;
+        if (behind > 0) out = glm::vec4(-1.0f, -1.0f, 1.0f, 1.0f);
+        return true;
+    }
+};
+#endif
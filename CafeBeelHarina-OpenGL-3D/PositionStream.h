@@ -0,0 +1,64 @@
+#ifndef POSITION_STREAM_H
+#define POSITION_STREAM_H
+
+#include <glad/glad.h>
+
+#include <vector>
+
+#include "ConstMesh.h"
+
+// ======================================================
+// Position-only copy of an uploaded interleaved mesh (depth pre-pass)
+// Positions are read back once from the source VBO and packed into their
+// own buffer; an indexed source shares its EBO, so both streams stay in
+// step. Bound to attribute 0 like the full vertex format.
+// ======================================================
+class PositionStream {
+public:
+    unsigned int vao = 0, vbo = 0;
+    int count = 0;              // indices, or vertices when not indexed
+    bool indexed = false;
+
+    // ebo == 0: non-indexed, drawCount is the vertex count
+    void create(unsigned int sourceVbo, unsigned int ebo, int drawCount) {
+        release();
+        GLint bytes = 0;
+        glBindBuffer(GL_ARRAY_BUFFER, sourceVbo);
+        glGetBufferParameteriv(GL_ARRAY_BUFFER, GL_BUFFER_SIZE, &bytes);
+        int vertexCount = bytes / kVertexStrideBytes;
+        std::vector<float> interleaved((size_t)vertexCount * kVertexStride);
+        glGetBufferSubData(GL_ARRAY_BUFFER, 0, (GLsizeiptr)interleaved.size() * sizeof(float), interleaved.data());
+
+        std::vector<float> positions((size_t)vertexCount * 3);
+        for (int v = 0; v < vertexCount; ++v)
+            for (int c = 0; c < 3; ++c) positions[(size_t)v * 3 + c] = interleaved[(size_t)v * kVertexStride + c];
+
+        glGenVertexArrays(1, &vao);
+        glGenBuffers(1, &vbo);
+        glBindVertexArray(vao);
+        glBindBuffer(GL_ARRAY_BUFFER, vbo);
+        glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)positions.size() * sizeof(float), positions.data(), GL_STATIC_DRAW);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
+        glEnableVertexAttribArray(0);
+        if (ebo) glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
+        glBindVertexArray(0);
+
+        count = drawCount;
+        indexed = ebo != 0;
+    }
+
+    void draw() const {
+        glBindVertexArray(vao);
+        if (indexed) glDrawElements(GL_TRIANGLES, count, GL_UNSIGNED_INT, 0);
+        else glDrawArrays(GL_TRIANGLES, 0, count);
+        glBindVertexArray(0);
+    }
+
+    void release() {
+        if (vbo) glDeleteBuffers(1, &vbo);
+        if (vao) glDeleteVertexArrays(1, &vao);
+        vao = vbo = 0;
+        count = 0;
+    }
+};
+#endif
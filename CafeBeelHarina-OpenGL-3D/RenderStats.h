@@ -0,0 +1,157 @@
+#ifndef RENDER_STATS_H
+#define RENDER_STATS_H
+
+#include <glad/glad.h>
+
+#include <cstdint>
+
+// ======================================================
+// Per-frame renderer counters (reset at the start of every frame)
+// ======================================================
+struct RenderStats {
+    int entities = 0;           // live entities in the store
+    int visible = 0;            // passed culling
+    int culled = 0;             // rejected by frustum culling
+    int occluded = 0;           // in the frustum but behind occluders
+    int portalCells = 0;        // cells reached through portals (0: portals not in use)
+    int hlodProxies = 0;        // HLOD proxies drawn in place of table sets / pavilions
+    int impostors = 0;          // impostor quads drawn
+    int waterNodes = 0;         // water patches (one instanced draw)
+    int gpuSkippedSets = 0;     // table sets the GPU skipped (results of earlier frames)
+    int64_t gpuSkippedTriangles = 0;
+    int drawCalls = 0;
+    int64_t triangles = 0;
+    double overdraw = 0.0;      // samples passed per window pixel, a few frames old (0 under G)
+    double heatmapAvg = 0.0;    // overdraw heatmap (H) only: fragments per pixel this frame
+    double heatmapMax = 0.0;
+
+    double cpuUpdateMs = 0.0;   // transform update + culling + draw-list build
+    double cpuOcclusionMs = 0.0;    // software occlusion (part of cpuUpdateMs)
+    double cpuImpostorMs = 0.0; // impostor selection (part of cpuUpdateMs)
+    double cpuSubmitMs = 0.0;   // GL calls for the scene
+    double cpuOceanMs = 0.0;    // FFT water simulation + packing (not in the above)
+
+    // Bulb lights (Clustered.h)
+    int lights = 0;
+    double lightsPerCluster = 0.0;  // average list length
+    double cpuClusterMs = 0.0;      // light assignment + upload (part of cpuUpdateMs)
+
+    // Planar reflection (not in any of the above)
+    int reflectionDrawCalls = 0;
+    int64_t reflectionTriangles = 0;
+    double cpuReflectionMs = 0.0;   // selection + GL calls
+    double gpuReflectionMs = 0.0;   // a few frames old
+
+    void reset() { *this = RenderStats(); }
+
+    void countDraw(int64_t tris) {
+        ++drawCalls;
+        triangles += tris;
+    }
+};
+
+// ======================================================
+// GPU query ring
+// A small ring of queries so reading a result never stalls: the value
+// returned by last() is a few frames old.
+// ======================================================
+class GpuQueryRing {
+public:
+    static const int kLatency = 3;
+
+    explicit GpuQueryRing(GLenum target) : target(target) {}
+
+    void init() {
+        glGenQueries(kLatency, queries);
+        for (int i = 0; i < kLatency; ++i) pending[i] = false;
+    }
+
+    void release() {
+        if (queries[0]) glDeleteQueries(kLatency, queries);
+        queries[0] = 0;
+    }
+
+    void begin() { glBeginQuery(target, queries[current]); }
+
+    void end() {
+        glEndQuery(target);
+        pending[current] = true;
+        current = (current + 1) % kLatency;
+
+        // Oldest query is the one we are about to reuse next
+        if (pending[current]) {
+            GLint ready = 0;
+            glGetQueryObjectiv(queries[current], GL_QUERY_RESULT_AVAILABLE, &ready);
+            if (ready) glGetQueryObjectui64v(queries[current], GL_QUERY_RESULT, &value);
+            pending[current] = false;
+        }
+    }
+
+    GLuint64 last() const { return value; }
+
+private:
+    GLenum target;
+    unsigned int queries[kLatency] = {};
+    bool pending[kLatency] = {};
+    int current = 0;
+    GLuint64 value = 0;
+};
+
+// GPU time of the bracketed commands (GL_TIME_ELAPSED)
+class GpuTimer : public GpuQueryRing {
+public:
+    GpuTimer() : GpuQueryRing(GL_TIME_ELAPSED) {}
+    double lastMs() const { return (double)last() / 1.0e6; }
+};
+
+// GPU time between two timestamps (GL_TIMESTAMP). Unlike GpuTimer it can
+// sit inside another timer's bracket, e.g. one pass of a timed frame.
+class GpuStampTimer {
+public:
+    static const int kLatency = GpuQueryRing::kLatency;
+
+    void init() { glGenQueries(2 * kLatency, queries); }
+
+    void release() {
+        if (queries[0]) glDeleteQueries(2 * kLatency, queries);
+        queries[0] = 0;
+    }
+
+    void begin() { glQueryCounter(queries[2 * current], GL_TIMESTAMP); }
+
+    void end() {
+        glQueryCounter(queries[2 * current + 1], GL_TIMESTAMP);
+        pending[current] = true;
+        current = (current + 1) % kLatency;
+
+        if (pending[current]) {
+            GLint ready = 0;
+            glGetQueryObjectiv(queries[2 * current + 1], GL_QUERY_RESULT_AVAILABLE, &ready);
+            if (ready) {
+                GLuint64 start = 0, stop = 0;
+                glGetQueryObjectui64v(queries[2 * current], GL_QUERY_RESULT, &start);
+                glGetQueryObjectui64v(queries[2 * current + 1], GL_QUERY_RESULT, &stop);
+                value = stop - start;
+            }
+            pending[current] = false;
+        }
+    }
+
+    double lastMs() const { return (double)value / 1.0e6; }
+
+private:
+    unsigned int queries[2 * kLatency] = {};
+    bool pending[kLatency] = {};
+    int current = 0;
+    GLuint64 value = 0;
+};
+
+// Overdraw counter (GL_SAMPLES_PASSED): fragments that passed the depth
+// test, i.e. were shaded and written, per window pixel. Only one occlusion
+// query can be active, so it cannot bracket the per-set queries (G).
+class OverdrawCounter : public GpuQueryRing {
+public:
+    OverdrawCounter() : GpuQueryRing(GL_SAMPLES_PASSED) {}
+    double lastPerPixel(int pixels) const { return pixels > 0 ? (double)last() / pixels : 0.0; }
+};
+#endif
@@ -0,0 +1,693 @@
+#ifndef SCENE_FILE_H
+#define SCENE_FILE_H
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "Ecs.h"
+#include "Mesh.h"
+#include "MappedFile.h"
+
+// ======================================================
+// Scene description
+//
+// Text form (.scene), one statement per line, '#' starts a comment:
+//   include  <file>                  (relative to the including file)
+//   mesh     <name> <cube|sphere|cylinder|cone|table-model>
+//   material <name> r g b a [none|wood|water|canopy]
+//   prefab   <name>                  ... end
+//     node   <name> <parent|-> <ops>
+//     part   <parent|-> <mesh> <material> <ops> [flags]
+//   instance <prefab> x y z [yaw]
+//   object   <mesh> <material> <ops> [flags]
+//   batch    <material> [flags]      ... end
+//     <mesh> <ops>
+//   cell     <name> x0 y0 z0 x1 y1 z1              (visibility cell, world box)
+//   portal   <cell> <cell> x0 y0 z0 x1 y1 z1       (opening between two cells,
+//                                                   a box flat along one axis)
+//
+// ops are applied left to right like glm calls:
+//   t x y z | r deg ax ay az | s x y z | yaw  (the instance's yaw about +Y)
+// flags: occluder, hidden, light. Alpha < 1 makes a material glass
+// (ENT_TRANSPARENT): blended after the opaque parts, so solid ones keep 1.
+//
+// Compiled form (.cscn) is the same data flattened: prefabs expanded into
+// nodes (parents before children), static batches pre-transformed into one
+// vertex/index blob. It is mapped and read in place.
+// ======================================================
+enum SceneMesh { MESH_CUBE, MESH_SPHERE, MESH_CYLINDER, MESH_CONE, MESH_TABLE_MODEL, MESH_BATCH /* + batch index */ };
+enum SceneTexture { SCENE_TEX_NONE, SCENE_TEX_WOOD, SCENE_TEX_WATER, SCENE_TEX_CANOPY };
+
+const char kSceneFileMagic[4] = { 'C', 'B', 'S', 'C' };
+const uint32_t kSceneFileVersion = 2;     // 2: cells and portals
+const uint32_t kSceneFileAlign = 16;
+
+struct SceneFileHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t materialCount;
+    uint32_t nodeCount;
+
+    uint32_t objectCount;
+    uint32_t batchCount;
+    uint32_t batchVertexCount;
+    uint32_t batchIndexCount;
+
+    uint64_t materialOffset;
+    uint64_t nodeOffset;
+    uint64_t objectOffset;
+    uint64_t batchOffset;
+    uint64_t vertexOffset;
+    uint64_t indexOffset;
+
+    uint32_t cellCount;
+    uint32_t portalCount;
+    uint64_t cellOffset;
+    uint64_t portalOffset;
+    uint64_t reserved;
+};
+
+struct SceneMaterial {
+    float color[4];
+    uint32_t texture;           // SceneTexture
+    uint32_t pad[3];
+};
+
+struct SceneNode {
+    int32_t parent;             // -1 = root; always lower than this node's index
+    uint32_t pad[3];
+    float local[16];            // column-major
+};
+
+struct SceneObject {
+    int32_t node;
+    uint32_t mesh;              // SceneMesh
+    uint32_t material;
+    uint32_t flags;             // EntityFlags
+    int32_t group;              // instance index, -1 for loose objects
+    uint32_t pad[3];
+};
+
+struct SceneBatch {
+    uint32_t material;
+    uint32_t flags;
+    int32_t baseVertex;
+    uint32_t firstIndex;
+    uint32_t indexCount;
+    uint32_t vertexCount;
+    uint32_t pad[2];
+    float boundsMin[4];
+    float boundsMax[4];
+};
+
+struct SceneCell {
+    float boundsMin[4];
+    float boundsMax[4];
+};
+
+struct ScenePortal {
+    int32_t cellA;
+    int32_t cellB;
+    uint32_t pad[2];
+    float rectMin[4];           // opening, flat along one axis
+    float rectMax[4];
+};
+
+static_assert(sizeof(SceneFileHeader) % kSceneFileAlign == 0, "header must keep tables aligned");
+static_assert(sizeof(SceneMaterial) % kSceneFileAlign == 0 && sizeof(SceneNode) % kSceneFileAlign == 0 &&
+              sizeof(SceneObject) % kSceneFileAlign == 0 && sizeof(SceneBatch) % kSceneFileAlign == 0 &&
+              sizeof(SceneCell) % kSceneFileAlign == 0 && sizeof(ScenePortal) % kSceneFileAlign == 0,
+              "table entries must keep tables aligned");
+
+// Read-only view, backed either by a SceneDesc or by a mapped .cscn
+struct SceneData {
+    const SceneMaterial* materials = nullptr;   int materialCount = 0;
+    const SceneNode* nodes = nullptr;           int nodeCount = 0;
+    const SceneObject* objects = nullptr;       int objectCount = 0;
+    const SceneBatch* batches = nullptr;        int batchCount = 0;
+    const float* batchVertices = nullptr;       int batchVertexCount = 0;
+    const unsigned int* batchIndices = nullptr; int batchIndexCount = 0;
+    const SceneCell* cells = nullptr;           int cellCount = 0;
+    const ScenePortal* portals = nullptr;       int portalCount = 0;
+};
+
+// Compiled scene held in memory
+struct SceneDesc {
+    std::vector<SceneMaterial> materials;
+    std::vector<SceneNode> nodes;
+    std::vector<SceneObject> objects;
+    std::vector<SceneBatch> batches;
+    std::vector<float> batchVertices;
+    std::vector<unsigned int> batchIndices;
+    std::vector<SceneCell> cells;
+    std::vector<ScenePortal> portals;
+
+    SceneData view() const {
+        SceneData d;
+        d.materials = materials.data();           d.materialCount = (int)materials.size();
+        d.nodes = nodes.data();                   d.nodeCount = (int)nodes.size();
+        d.objects = objects.data();               d.objectCount = (int)objects.size();
+        d.batches = batches.data();               d.batchCount = (int)batches.size();
+        d.batchVertices = batchVertices.data();   d.batchVertexCount = (int)(batchVertices.size() / kVertexStride);
+        d.batchIndices = batchIndices.data();     d.batchIndexCount = (int)batchIndices.size();
+        d.cells = cells.data();                   d.cellCount = (int)cells.size();
+        d.portals = portals.data();               d.portalCount = (int)portals.size();
+        return d;
+    }
+};
+
+// Local geometry of a built-in mesh, needed to pre-transform static batches
+using SceneMeshSource = std::function<bool(SceneMesh, MeshData&)>;
+
+namespace scenefile {
+
+inline bool meshKindFromName(const std::string& s, SceneMesh& out) {
+    static const char* names[] = { "cube", "sphere", "cylinder", "cone", "table-model" };
+    for (int i = 0; i < 5; ++i)
+        if (s == names[i]) { out = (SceneMesh)i; return true; }
+    return false;
+}
+
+inline bool textureFromName(const std::string& s, uint32_t& out) {
+    static const char* names[] = { "none", "wood", "water", "canopy" };
+    for (int i = 0; i < 4; ++i)
+        if (s == names[i]) { out = (uint32_t)i; return true; }
+    return false;
+}
+
+inline uint64_t align(uint64_t v) { return (v + kSceneFileAlign - 1) & ~(uint64_t)(kSceneFileAlign - 1); }
+
+inline bool readSceneText(const std::string& path, std::string& out) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return false;
+    std::stringstream ss;
+    ss << in.rdbuf();
+    out = ss.str();
+    return true;
+}
+
+inline std::string sceneDirectory(const std::string& path) {
+    size_t slash = path.find_last_of("/\\");
+    return slash == std::string::npos ? std::string() : path.substr(0, slash);
+}
+
+class Compiler {
+public:
+    Compiler(SceneDesc& out, const SceneMeshSource& meshSource) : desc(out), meshes(meshSource) {}
+
+    // baseDir resolves include paths; name only labels errors
+    bool compile(const std::string& text, const std::string& baseDir, const std::string& name, std::string& error, int depth = 0) {
+        std::istringstream in(text);
+        std::string line;
+        int lineNo = 0;
+        while (std::getline(in, line)) {
+            ++lineNo;
+            size_t hash = line.find('#');
+            if (hash != std::string::npos) line.erase(hash);
+
+            std::vector<std::string> tok = split(line);
+            if (tok.empty()) continue;
+
+            bool ok;
+            if (tok[0] == "include") ok = include(tok, baseDir, error, depth);
+            else ok = statement(tok);
+            if (!ok) {
+                if (error.empty()) error = name + ":" + std::to_string(lineNo) + ": " + err;
+                return false;
+            }
+        }
+        if (openPrefab || openBatch) {
+            error = name + ": missing 'end' at end of file";
+            return false;
+        }
+        return true;
+    }
+
+private:
+    struct Prefab {
+        std::vector<std::vector<std::string>> lines;
+    };
+
+    SceneDesc& desc;
+    const SceneMeshSource& meshes;
+    std::map<std::string, SceneMesh> meshNames;
+    std::map<std::string, uint32_t> materialNames;
+    std::map<std::string, Prefab> prefabs;
+    std::map<std::string, int> cellNames;
+    Prefab* openPrefab = nullptr;
+    SceneBatch* openBatch = nullptr;
+    int instanceCount = 0;
+    std::string err;
+
+    static std::vector<std::string> split(const std::string& s) {
+        std::vector<std::string> t;
+        std::istringstream ss(s);
+        std::string w;
+        while (ss >> w) t.push_back(w);
+        return t;
+    }
+
+    bool fail(const std::string& msg) { err = msg; return false; }
+
+    bool number(const std::vector<std::string>& t, size_t i, float& out) {
+        if (i >= t.size()) return fail("expected a number");
+        char* end = nullptr;
+        out = strtof(t[i].c_str(), &end);
+        if (end == t[i].c_str() || *end) return fail("not a number: " + t[i]);
+        return true;
+    }
+
+    // Applies ops and flags from t[first..]
+    bool transform(const std::vector<std::string>& t, size_t first, float yaw, glm::mat4& m, uint32_t* flags) {
+        m = glm::mat4(1.0f);
+        for (size_t i = first; i < t.size();) {
+            const std::string& op = t[i];
+            float v[4];
+            if (op == "t" || op == "s") {
+                if (!number(t, i + 1, v[0]) || !number(t, i + 2, v[1]) || !number(t, i + 3, v[2])) return false;
+                m = op == "t" ? glm::translate(m, glm::vec3(v[0], v[1], v[2])) : glm::scale(m, glm::vec3(v[0], v[1], v[2]));
+                i += 4;
+            }
+            else if (op == "r") {
+                for (int k = 0; k < 4; ++k)
+                    if (!number(t, i + 1 + k, v[k])) return false;
+                m = glm::rotate(m, glm::radians(v[0]), glm::vec3(v[1], v[2], v[3]));
+                i += 5;
+            }
+            else if (op == "yaw") {
+                m = glm::rotate(m, glm::radians(yaw), glm::vec3(0, 1, 0));
+                i += 1;
+            }
+            else if (flags && op == "occluder") { *flags |= ENT_OCCLUDER; i += 1; }
+            else if (flags && op == "hidden") { *flags |= ENT_HIDDEN; i += 1; }
+            else if (flags && op == "light") { *flags |= ENT_LIGHT; i += 1; }
+            else return fail("unknown transform op or flag: " + op);
+        }
+        return true;
+    }
+
+    // x0 y0 z0 x1 y1 z1 from t[first..]
+    bool box(const std::vector<std::string>& t, size_t first, float mn[4], float mx[4]) {
+        for (int k = 0; k < 3; ++k)
+            if (!number(t, first + k, mn[k]) || !number(t, first + 3 + k, mx[k])) return false;
+        for (int k = 0; k < 3; ++k)
+            if (mn[k] > mx[k]) return fail("box min is above max");
+        mn[3] = mx[3] = 0.0f;
+        return true;
+    }
+
+    bool lookupMesh(const std::string& name, SceneMesh& out) {
+        auto it = meshNames.find(name);
+        if (it == meshNames.end()) return fail("unknown mesh: " + name);
+        out = it->second;
+        return true;
+    }
+
+    bool lookupMaterial(const std::string& name, uint32_t& out) {
+        auto it = materialNames.find(name);
+        if (it == materialNames.end()) return fail("unknown material: " + name);
+        out = it->second;
+        return true;
+    }
+
+    int addNode(int parent, const glm::mat4& local) {
+        SceneNode n = {};
+        n.parent = parent;
+        memcpy(n.local, &local[0][0], sizeof(n.local));
+        desc.nodes.push_back(n);
+        return (int)desc.nodes.size() - 1;
+    }
+
+    uint32_t materialFlags(uint32_t material) const {
+        return desc.materials[material].color[3] < 1.0f ? ENT_TRANSPARENT : 0u;
+    }
+
+    bool addObject(int node, SceneMesh mesh, uint32_t material, uint32_t flags, int group) {
+        SceneObject o = {};
+        o.node = node;
+        o.mesh = mesh;
+        o.material = material;
+        o.flags = flags | ENT_STATIC | materialFlags(material);
+        o.group = group;
+        desc.objects.push_back(o);
+        return true;
+    }
+
+    // include <file>: definitions and layout from another text scene
+    bool include(const std::vector<std::string>& t, const std::string& baseDir, std::string& error, int depth) {
+        if (t.size() != 2) return fail("usage: include <file>");
+        if (openPrefab || openBatch) return fail("include inside prefab or batch");
+        if (depth >= 8) return fail("includes nested too deeply");
+
+        std::string path = baseDir.empty() ? t[1] : baseDir + "/" + t[1];
+        std::string text;
+        if (!readSceneText(path, text)) return fail("cannot open " + path);
+        return compile(text, sceneDirectory(path), t[1], error, depth + 1);
+    }
+
+    bool statement(const std::vector<std::string>& t) {
+        const std::string& kw = t[0];
+
+        if (kw == "end") {
+            if (openPrefab) openPrefab = nullptr;
+            else if (openBatch) {
+                if (openBatch->indexCount == 0) return fail("empty batch");
+                openBatch = nullptr;
+            }
+            else return fail("'end' without prefab or batch");
+            return true;
+        }
+        if (openPrefab) {
+            if (kw != "node" && kw != "part") return fail("only node / part allowed inside a prefab");
+            openPrefab->lines.push_back(t);
+            return true;
+        }
+        if (openBatch) return batchEntry(t);
+
+        if (kw == "mesh") {
+            SceneMesh kind;
+            if (t.size() != 3 || !meshKindFromName(t[2], kind)) return fail("usage: mesh <name> <cube|sphere|cylinder|cone|table-model>");
+            meshNames[t[1]] = kind;
+            return true;
+        }
+        if (kw == "material") {
+            SceneMaterial m = {};
+            if (t.size() < 6 || t.size() > 7) return fail("usage: material <name> r g b a [texture]");
+            for (int k = 0; k < 4; ++k)
+                if (!number(t, 2 + k, m.color[k])) return false;
+            if (t.size() == 7 && !textureFromName(t[6], m.texture)) return fail("unknown texture: " + t[6]);
+            materialNames[t[1]] = (uint32_t)desc.materials.size();
+            desc.materials.push_back(m);
+            return true;
+        }
+        if (kw == "prefab") {
+            if (t.size() != 2) return fail("usage: prefab <name>");
+            openPrefab = &prefabs[t[1]];
+            openPrefab->lines.clear();
+            return true;
+        }
+        if (kw == "instance") return instance(t);
+        if (kw == "object") {
+            SceneMesh mesh;
+            uint32_t material, flags = 0;
+            glm::mat4 m;
+            if (t.size() < 3) return fail("usage: object <mesh> <material> <ops> [flags]");
+            if (!lookupMesh(t[1], mesh) || !lookupMaterial(t[2], material) || !transform(t, 3, 0.0f, m, &flags)) return false;
+            return addObject(addNode(-1, m), mesh, material, flags, -1);
+        }
+        if (kw == "batch") {
+            SceneBatch b = {};
+            glm::mat4 unused;
+            if (t.size() < 2) return fail("usage: batch <material> [flags]");
+            if (!lookupMaterial(t[1], b.material) || !transform(t, 2, 0.0f, unused, &b.flags)) return false;
+            b.flags |= ENT_STATIC | materialFlags(b.material);
+            b.baseVertex = (int32_t)(desc.batchVertices.size() / kVertexStride);
+            b.firstIndex = (uint32_t)desc.batchIndices.size();
+            desc.batches.push_back(b);
+            openBatch = &desc.batches.back();
+            return true;
+        }
+        if (kw == "cell") {
+            SceneCell c = {};
+            if (t.size() != 8) return fail("usage: cell <name> x0 y0 z0 x1 y1 z1");
+            if (cellNames.count(t[1])) return fail("duplicate cell: " + t[1]);
+            if (!box(t, 2, c.boundsMin, c.boundsMax)) return false;
+            cellNames[t[1]] = (int)desc.cells.size();
+            desc.cells.push_back(c);
+            return true;
+        }
+        if (kw == "portal") {
+            ScenePortal p = {};
+            if (t.size() != 9) return fail("usage: portal <cell> <cell> x0 y0 z0 x1 y1 z1");
+            auto a = cellNames.find(t[1]), b = cellNames.find(t[2]);
+            if (a == cellNames.end()) return fail("unknown cell: " + t[1]);
+            if (b == cellNames.end()) return fail("unknown cell: " + t[2]);
+            if (a->second == b->second) return fail("portal joins a cell to itself");
+            if (!box(t, 3, p.rectMin, p.rectMax)) return false;
+            p.cellA = a->second;
+            p.cellB = b->second;
+            desc.portals.push_back(p);
+            return true;
+        }
+        return fail("unknown statement: " + kw);
+    }
+
+    bool instance(const std::vector<std::string>& t) {
+        if (t.size() < 5 || t.size() > 6) return fail("usage: instance <prefab> x y z [yaw]");
+        auto it = prefabs.find(t[1]);
+        if (it == prefabs.end()) return fail("unknown prefab: " + t[1]);
+
+        float x, y, z, yaw = 0.0f;
+        if (!number(t, 2, x) || !number(t, 3, y) || !number(t, 4, z)) return false;
+        if (t.size() == 6 && !number(t, 5, yaw)) return false;
+
+        int group = instanceCount++;
+        int root = addNode(-1, glm::translate(glm::mat4(1.0f), glm::vec3(x, y, z)));
+        std::map<std::string, int> local;
+
+        for (const auto& pl : it->second.lines) {
+            if (pl.size() < 3) return fail("prefab " + t[1] + ": incomplete " + pl[0]);
+
+            const std::string& parentName = pl[pl[0] == "node" ? 2 : 1];
+            int parent = root;
+            if (parentName != "-") {
+                auto p = local.find(parentName);
+                if (p == local.end()) return fail("prefab " + t[1] + ": unknown parent node " + parentName);
+                parent = p->second;
+            }
+
+            glm::mat4 m;
+            if (pl[0] == "node") {
+                if (!transform(pl, 3, yaw, m, nullptr)) return false;
+                local[pl[1]] = addNode(parent, m);
+            }
+            else {
+                SceneMesh mesh;
+                uint32_t material, flags = 0;
+                if (pl.size() < 4) return fail("prefab " + t[1] + ": usage: part <parent> <mesh> <material> <ops>");
+                if (!lookupMesh(pl[2], mesh) || !lookupMaterial(pl[3], material) || !transform(pl, 4, yaw, m, &flags)) return false;
+                addObject(addNode(parent, m), mesh, material, flags, group);
+            }
+        }
+        return true;
+    }
+
+    // Bakes one transformed mesh into the open batch
+    bool batchEntry(const std::vector<std::string>& t) {
+        SceneMesh mesh;
+        glm::mat4 m;
+        MeshData data;
+        if (!lookupMesh(t[0], mesh) || !transform(t, 1, 0.0f, m, nullptr)) return false;
+        if (mesh == MESH_TABLE_MODEL || !meshes || !meshes(mesh, data)) return fail("mesh cannot be batched: " + t[0]);
+
+        glm::mat3 normalMat = glm::transpose(glm::inverse(glm::mat3(m)));
+        SceneBatch& b = *openBatch;
+        uint32_t first = b.vertexCount;
+        int count = data.vertexCount();
+
+        for (int v = 0; v < count; ++v) {
+            const float* src = &data.vertices[(size_t)v * kVertexStride];
+            glm::vec3 p = glm::vec3(m * glm::vec4(src[0], src[1], src[2], 1.0f));
+            glm::vec3 n = glm::normalize(normalMat * glm::vec3(src[3], src[4], src[5]));
+            float out[kVertexStride] = { p.x, p.y, p.z, n.x, n.y, n.z, src[6], src[7] };
+            desc.batchVertices.insert(desc.batchVertices.end(), out, out + kVertexStride);
+
+            for (int k = 0; k < 3; ++k) {
+                bool firstVertex = b.vertexCount == 0 && v == 0;
+                b.boundsMin[k] = firstVertex ? p[k] : std::min(b.boundsMin[k], p[k]);
+                b.boundsMax[k] = firstVertex ? p[k] : std::max(b.boundsMax[k], p[k]);
+            }
+        }
+
+        // Batches are always indexed (relative to baseVertex)
+        if (data.indices.empty())
+            for (int v = 0; v < count; ++v) desc.batchIndices.push_back(first + (uint32_t)v);
+        else
+            for (unsigned int i : data.indices) desc.batchIndices.push_back(first + i);
+
+        b.vertexCount += (uint32_t)count;
+        b.indexCount = (uint32_t)desc.batchIndices.size() - b.firstIndex;
+        return true;
+    }
+};
+
+} // namespace scenefile
+
+// ------------------------------
+// Text -> SceneDesc
+// ------------------------------
+// baseDir resolves include statements (empty = working directory)
+inline bool compileSceneText(const std::string& text, const std::string& baseDir, const SceneMeshSource& meshSource,
+                             SceneDesc& out, std::string& error)
+{
+    out = SceneDesc();
+    error.clear();
+    scenefile::Compiler c(out, meshSource);
+    return c.compile(text, baseDir, "<text>", error);
+}
+
+inline bool compileSceneFile(const std::string& path, const SceneMeshSource& meshSource, SceneDesc& out)
+{
+    std::string text, error;
+    if (!scenefile::readSceneText(path, text)) {
+        std::cout << "ERROR::SCENE::CANNOT_OPEN: " << path << std::endl;
+        return false;
+    }
+
+    out = SceneDesc();
+    scenefile::Compiler c(out, meshSource);
+    if (!c.compile(text, scenefile::sceneDirectory(path), path, error)) {
+        std::cout << "ERROR::SCENE::PARSE: " << error << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// ------------------------------
+// SceneDesc -> .cscn
+// ------------------------------
+inline bool writeSceneBinary(const std::string& path, const SceneDesc& d)
+{
+    SceneFileHeader h = {};
+    memcpy(h.magic, kSceneFileMagic, 4);
+    h.version = kSceneFileVersion;
+    h.materialCount = (uint32_t)d.materials.size();
+    h.nodeCount = (uint32_t)d.nodes.size();
+    h.objectCount = (uint32_t)d.objects.size();
+    h.batchCount = (uint32_t)d.batches.size();
+    h.batchVertexCount = (uint32_t)(d.batchVertices.size() / kVertexStride);
+    h.batchIndexCount = (uint32_t)d.batchIndices.size();
+    h.cellCount = (uint32_t)d.cells.size();
+    h.portalCount = (uint32_t)d.portals.size();
+
+    h.materialOffset = sizeof(SceneFileHeader);
+    h.nodeOffset = h.materialOffset + d.materials.size() * sizeof(SceneMaterial);
+    h.objectOffset = h.nodeOffset + d.nodes.size() * sizeof(SceneNode);
+    h.batchOffset = h.objectOffset + d.objects.size() * sizeof(SceneObject);
+    h.cellOffset = h.batchOffset + d.batches.size() * sizeof(SceneBatch);
+    h.portalOffset = h.cellOffset + d.cells.size() * sizeof(SceneCell);
+    h.vertexOffset = h.portalOffset + d.portals.size() * sizeof(ScenePortal);
+    h.indexOffset = scenefile::align(h.vertexOffset + d.batchVertices.size() * sizeof(float));
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        std::cout << "ERROR::SCENE::CANNOT_WRITE: " << path << std::endl;
+        return false;
+    }
+
+    static const char zeros[kSceneFileAlign] = {};
+    out.write((const char*)&h, sizeof(h));
+    out.write((const char*)d.materials.data(), d.materials.size() * sizeof(SceneMaterial));
+    out.write((const char*)d.nodes.data(), d.nodes.size() * sizeof(SceneNode));
+    out.write((const char*)d.objects.data(), d.objects.size() * sizeof(SceneObject));
+    out.write((const char*)d.batches.data(), d.batches.size() * sizeof(SceneBatch));
+    out.write((const char*)d.cells.data(), d.cells.size() * sizeof(SceneCell));
+    out.write((const char*)d.portals.data(), d.portals.size() * sizeof(ScenePortal));
+    out.write((const char*)d.batchVertices.data(), d.batchVertices.size() * sizeof(float));
+    out.write(zeros, (std::streamsize)(h.indexOffset - (uint64_t)out.tellp()));
+    out.write((const char*)d.batchIndices.data(), d.batchIndices.size() * sizeof(unsigned int));
+    return (bool)out;
+}
+
+// ======================================================
+// Loader: maps a .cscn and exposes its tables in place
+// ======================================================
+class SceneFileView {
+public:
+    static bool isBinary(const std::string& path) {
+        std::ifstream in(path, std::ios::binary);
+        char magic[4] = {};
+        return in.read(magic, 4) && memcmp(magic, kSceneFileMagic, 4) == 0;
+    }
+
+    bool open(const std::string& path) {
+        if (!file.open(path)) return false;
+
+        size_t size = file.size();
+        if (size < sizeof(SceneFileHeader)) return fail(path, "TRUNCATED");
+
+        hdr = (const SceneFileHeader*)file.data();
+        if (memcmp(hdr->magic, kSceneFileMagic, 4) != 0) return fail(path, "BAD_MAGIC");
+        if (hdr->version != kSceneFileVersion) return fail(path, "BAD_VERSION");
+
+        // Tables inside the file, aligned for their element type; offsets come
+        // from the file, so subtract from size rather than add to them
+        auto fits = [size](uint64_t offset, uint64_t bytes, size_t align) {
+            return offset % align == 0 && offset <= size && bytes <= size - offset;
+        };
+        if (!fits(hdr->materialOffset, (uint64_t)hdr->materialCount * sizeof(SceneMaterial), alignof(SceneMaterial)) ||
+            !fits(hdr->nodeOffset, (uint64_t)hdr->nodeCount * sizeof(SceneNode), alignof(SceneNode)) ||
+            !fits(hdr->objectOffset, (uint64_t)hdr->objectCount * sizeof(SceneObject), alignof(SceneObject)) ||
+            !fits(hdr->batchOffset, (uint64_t)hdr->batchCount * sizeof(SceneBatch), alignof(SceneBatch)) ||
+            !fits(hdr->cellOffset, (uint64_t)hdr->cellCount * sizeof(SceneCell), alignof(SceneCell)) ||
+            !fits(hdr->portalOffset, (uint64_t)hdr->portalCount * sizeof(ScenePortal), alignof(ScenePortal)) ||
+            !fits(hdr->vertexOffset, (uint64_t)hdr->batchVertexCount * kVertexStrideBytes, alignof(float)) ||
+            !fits(hdr->indexOffset, (uint64_t)hdr->batchIndexCount * sizeof(uint32_t), alignof(uint32_t)))
+            return fail(path, "BAD_LAYOUT");
+
+        return validate() ? true : fail(path, "BAD_REFERENCE");
+    }
+
+    void close() { file.close(); hdr = nullptr; }
+
+    SceneData view() const {
+        const unsigned char* base = file.data();
+        SceneData d;
+        d.materials = (const SceneMaterial*)(base + hdr->materialOffset);   d.materialCount = (int)hdr->materialCount;
+        d.nodes = (const SceneNode*)(base + hdr->nodeOffset);               d.nodeCount = (int)hdr->nodeCount;
+        d.objects = (const SceneObject*)(base + hdr->objectOffset);         d.objectCount = (int)hdr->objectCount;
+        d.batches = (const SceneBatch*)(base + hdr->batchOffset);           d.batchCount = (int)hdr->batchCount;
+        d.batchVertices = (const float*)(base + hdr->vertexOffset);         d.batchVertexCount = (int)hdr->batchVertexCount;
+        d.batchIndices = (const unsigned int*)(base + hdr->indexOffset);    d.batchIndexCount = (int)hdr->batchIndexCount;
+        d.cells = (const SceneCell*)(base + hdr->cellOffset);               d.cellCount = (int)hdr->cellCount;
+        d.portals = (const ScenePortal*)(base + hdr->portalOffset);         d.portalCount = (int)hdr->portalCount;
+        return d;
+    }
+
+private:
+    // Indices are trusted by the instantiation code, so check them once here
+    bool validate() const {
+        SceneData d = view();
+        for (int i = 0; i < d.nodeCount; ++i)
+            if (d.nodes[i].parent >= i || d.nodes[i].parent < -1) return false;
+        for (int i = 0; i < d.objectCount; ++i) {
+            const SceneObject& o = d.objects[i];
+            if (o.node < 0 || o.node >= d.nodeCount || o.material >= (uint32_t)d.materialCount || o.mesh >= MESH_BATCH) return false;
+            // group indexes and sizes per-set arrays: -1, or below the object count
+            if (o.group < -1 || o.group >= d.objectCount) return false;
+        }
+        for (int i = 0; i < d.batchCount; ++i) {
+            const SceneBatch& b = d.batches[i];
+            if (b.material >= (uint32_t)d.materialCount || b.baseVertex < 0 ||
+                (uint64_t)b.baseVertex + b.vertexCount > (uint64_t)d.batchVertexCount ||
+                (uint64_t)b.firstIndex + b.indexCount > (uint64_t)d.batchIndexCount) return false;
+            for (uint32_t k = 0; k < b.indexCount; ++k)
+                if (d.batchIndices[b.firstIndex + k] >= b.vertexCount) return false;
+        }
+        for (int i = 0; i < d.portalCount; ++i) {
+            const ScenePortal& p = d.portals[i];
+            if (p.cellA < 0 || p.cellA >= d.cellCount || p.cellB < 0 || p.cellB >= d.cellCount || p.cellA == p.cellB) return false;
+        }
+        return true;
+    }
+
+    bool fail(const std::string& path, const char* why) {
+        std::cout << "ERROR::SCENE::" << why << ": " << path << std::endl;
+        close();
+        return false;
+    }
+
+    MappedFile file;
+    const SceneFileHeader* hdr = nullptr;
+};
+#endif
@@ -0,0 +1,139 @@
+#ifndef SCENE_GENERATOR_H
+#define SCENE_GENERATOR_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iomanip>
+#include <sstream>
+#include <string>
+
+// ======================================================
+// Procedural cafe layout (--generate <frames> <sets> <seed>)
+// Tiles canopy frames on a grid behind the walkway, each holding a grid of
+// table_set instances with seeded jitter and yaw. The result is scene text
+// that includes cafe_assets.scene, so it goes through the normal scene
+// compiler. The same arguments always produce the same layout.
+// Each frame is a visibility cell with portals (sides, top) to one deck cell
+// around them all, as in cafe.scene.
+// ======================================================
+
+// splitmix64: identical sequence on every platform / standard library
+struct LayoutRandom {
+    uint64_t state;
+
+    explicit LayoutRandom(uint64_t seed) : state(seed) {}
+
+    uint32_t next() {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return (uint32_t)((z ^ (z >> 31)) >> 32);
+    }
+
+    float range(float lo, float hi) { return lo + (hi - lo) * (float)(next() / 4294967296.0); }
+};
+
+struct CafeLayoutInfo {
+    int frames = 0;
+    int tableSets = 0;
+    float minX = 0, maxX = 0, minZ = 0, maxZ = 0;   // footprint
+};
+
+inline std::string generateCafeLayout(int frameCount, int setsPerFrame, uint32_t seed,
+                                      CafeLayoutInfo* info = nullptr, const std::string& assets = "cafe_assets.scene")
+{
+    const float floorY = 0.3f;
+    const float pitchX = 5.0f, pitchZ = 4.8f;      // table set footprint incl. chairs
+    const float margin = 0.6f, gap = 3.0f;
+
+    if (frameCount < 1) frameCount = 1;
+    if (setsPerFrame < 0) setsPerFrame = 0;
+
+    int setCols = std::max(1, (int)std::ceil(std::sqrt((double)setsPerFrame)));
+    int setRows = std::max(1, (setsPerFrame + setCols - 1) / setCols);
+    float fW = setCols * pitchX * 0.5f + margin;
+    float fD = setRows * pitchZ * 0.5f + margin;
+
+    int frameCols = (int)std::ceil(std::sqrt((double)frameCount));
+    float stepX = 2.0f * fW + gap, stepZ = 2.0f * fD + gap;
+    float startX = -0.5f * (frameCols - 1) * stepX;
+    float startZ = -5.0f - fD;
+
+    LayoutRandom rng(seed);
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(3);
+    out << "# generated: " << frameCount << " frames x " << setsPerFrame << " table sets, seed " << seed << "\n";
+    out << "include " << assets << "\n\n";
+
+    // Walkway from the default camera position
+    out << "object box deck_wood t 0 0.3 12.5 s 3 0.4 19 occluder\n";
+
+    CafeLayoutInfo li;
+    li.minX = li.maxX = 0.0f;
+    li.minZ = startZ;
+    li.maxZ = 22.0f;
+
+    for (int f = 0; f < frameCount; ++f) {
+        float cx = startX + (f % frameCols) * stepX;
+        float cz = startZ - (f / frameCols) * stepZ;
+        li.minX = std::min(li.minX, cx - fW);
+        li.maxX = std::max(li.maxX, cx + fW);
+        li.minZ = std::min(li.minZ, cz - fD);
+
+        out << "\n# frame " << f << "\n";
+        out << "object box floor_top t " << cx << " " << floorY << " " << cz
+            << " s " << 2.0f * fW + 1.0f << " 0.4 " << 2.0f * fD + 1.0f << " occluder\n";
+
+        out << "batch frame\n";
+        for (int k = 0; k < 4; ++k)
+            out << "  box t " << cx + (k & 1 ? fW : -fW) << " " << floorY + 2.5f << " " << cz + (k & 2 ? fD : -fD) << " s 0.2 5 0.2\n";
+        out << "  box t " << cx << " " << floorY + 4.9f << " " << cz - fD << " s " << fW * 2.1f << " 0.15 0.15\n";
+        out << "  box t " << cx << " " << floorY + 4.9f << " " << cz + fD << " s " << fW * 2.1f << " 0.15 0.15\n";
+        out << "  box t " << cx - fW << " " << floorY + 4.9f << " " << cz << " s 0.15 0.15 " << fD * 2.1f << "\n";
+        out << "  box t " << cx + fW << " " << floorY + 4.9f << " " << cz << " s 0.15 0.15 " << fD * 2.1f << "\n";
+        out << "end\n";
+
+        // Bulbs stay separate entities (the shared sphere mesh, one draw each)
+        for (int i = 0; i < 4; ++i) {
+            float x = cx - fW + i * (fW * 2.0f) / 3.0f;
+            out << "object ball bulb_warm t " << x << " " << floorY + 4.82f << " " << cz - fD + 0.1f << " s 0.25 0.25 0.25 light\n";
+            out << "object ball bulb_pale t " << x << " " << floorY + 4.82f << " " << cz + fD - 0.1f << " s 0.25 0.25 0.25 light\n";
+        }
+
+        if (rng.next() & 1)
+            out << "object box glass t " << cx << " " << floorY + 2.5f << " " << cz - fD << " s " << fW * 2.0f << " 4.8 0.04\n";
+
+        for (int s = 0; s < setsPerFrame; ++s) {
+            float x = cx - fW + margin + ((s % setCols) + 0.5f) * pitchX + rng.range(-0.25f, 0.25f);
+            float z = cz - fD + margin + ((s / setCols) + 0.5f) * pitchZ + rng.range(-0.25f, 0.25f);
+            out << "instance table_set " << x << " " << floorY << " " << z << " " << rng.range(-8.0f, 8.0f) << "\n";
+        }
+    }
+
+    out << "\n# cells and portals\n";
+    out << "cell walkway -1.55 0.5 3 1.55 8 22\n";
+    out << "cell deck " << li.minX - 1.0f << " 0 " << li.minZ - 1.0f << " " << li.maxX + 1.0f << " 8 3\n";
+    out << "portal walkway deck -1.55 0.5 3 -1.55 8 22\n";
+    out << "portal walkway deck 1.55 0.5 3 1.55 8 22\n";
+    out << "portal walkway deck -1.55 0.5 3 1.55 8 3\n";
+    for (int f = 0; f < frameCount; ++f) {
+        float cx = startX + (f % frameCols) * stepX;
+        float cz = startZ - (f / frameCols) * stepZ;
+        float x0 = cx - fW, x1 = cx + fW, z0 = cz - fD, z1 = cz + fD;
+        float y0 = floorY + 0.2f, y1 = floorY + 5.2f;
+        out << "cell f" << f << " " << x0 << " " << y0 << " " << z0 << " " << x1 << " " << y1 << " " << z1 << "\n";
+        const float sides[5][6] = {
+            { x0, y0, z0, x0, y1, z1 }, { x1, y0, z0, x1, y1, z1 },
+            { x0, y0, z0, x1, y1, z0 }, { x0, y0, z1, x1, y1, z1 },
+            { x0, y1, z0, x1, y1, z1 } };
+        for (const float* r : sides)
+            out << "portal f" << f << " deck " << r[0] << " " << r[1] << " " << r[2] << " " << r[3] << " " << r[4] << " " << r[5] << "\n";
+    }
+
+    li.frames = frameCount;
+    li.tableSets = frameCount * setsPerFrame;
+    if (info) *info = li;
+    return out.str();
+}
+#endif
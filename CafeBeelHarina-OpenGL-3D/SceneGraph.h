@@ -0,0 +1,75 @@
+#ifndef SCENE_GRAPH_H
+#define SCENE_GRAPH_H
+
+#include <vector>
+#include <glm/glm.hpp>
+
+// ======================================================
+// Retained transform hierarchy
+// Nodes are stored flat and a parent is always created before its children,
+// so one forward pass over the arrays updates the whole tree. World matrices
+// are cached; update() only recomputes nodes whose local transform was
+// marked dirty and their descendants, and is a no-op for a static scene.
+// ======================================================
+class SceneGraph {
+public:
+    int addNode(int parent, const glm::mat4& local) {
+        int id = (int)locals.size();
+        parents.push_back(parent);
+        locals.push_back(local);
+        worlds.push_back(parent >= 0 ? worlds[parent] * local : local);
+        dirty.push_back(0);
+        changed.push_back(0);
+        return id;
+    }
+
+    void setLocal(int node, const glm::mat4& local) {
+        locals[node] = local;
+        dirty[node] = 1;
+        anyDirty = true;
+    }
+
+    const glm::mat4& local(int node) const { return locals[node]; }
+    const glm::mat4& world(int node) const { return worlds[node]; }
+    int parent(int node) const { return parents[node]; }
+    int size() const { return (int)locals.size(); }
+
+    // Returns how many world matrices were recomputed
+    int update() {
+        if (!anyDirty) return 0;
+
+        int recomputed = 0;
+        for (size_t i = 0; i < locals.size(); ++i) {
+            int p = parents[i];
+            bool parentChanged = p >= 0 && changed[p];
+            if (dirty[i] || parentChanged) {
+                worlds[i] = p >= 0 ? worlds[p] * locals[i] : locals[i];
+                changed[i] = 1;
+                ++recomputed;
+            }
+            else changed[i] = 0;
+            dirty[i] = 0;
+        }
+        anyDirty = false;
+        return recomputed;
+    }
+
+    void clear() { *this = SceneGraph(); }
+
+    size_t memoryBytes() const {
+        return parents.capacity() * sizeof(int) + (locals.capacity() + worlds.capacity()) * sizeof(glm::mat4)
+            + dirty.capacity() + changed.capacity();
+    }
+
+    // Nodes recomputed by the last update() (valid until the next one)
+    bool wasUpdated(int node) const { return changed[node] != 0; }
+
+private:
+    std::vector<int> parents;
+    std::vector<glm::mat4> locals;
+    std::vector<glm::mat4> worlds;
+    std::vector<unsigned char> dirty;
+    std::vector<unsigned char> changed;
+    bool anyDirty = false;
+};
+#endif
@@ -0,0 +1,16 @@
+#ifndef SIMD_H
+#define SIMD_H
+
+// ======================================================
+// SSE availability
+// x64 always has SSE2; 32-bit MSVC builds need /arch:SSE2 (the default
+// since VS2012). Code using the intrinsics keeps a scalar path for the rest.
+// ======================================================
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CAFE_SSE 1
+#include <emmintrin.h>
+#else
+#define CAFE_SSE 0
+#endif
+
+#endif
@@ -0,0 +1,152 @@
+#ifndef WATER_GRID_H
+#define WATER_GRID_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <cmath>
+#include <vector>
+
+#include "Bounds.h"
+
+// ======================================================
+// Water surface as a CDLOD quadtree around the camera
+// Every node is the same kPatchQuads x kPatchQuads patch, scaled to the
+// node's size, so one instanced draw covers the selection. A node of level
+// L (size kLeafSize * 2^L) splits while it is within range(L - 1) of the
+// eye, range(L) = kRangeScale * size(L). Roots are a kRoots x kRoots block
+// snapped to the top-level size, so the selection, and with it the
+// triangle count, is bounded wherever the camera goes.
+// Over the last part of its range (kMorphStart .. 1) a patch's odd
+// vertices slide onto the next level's grid; at the edge with a coarser
+// neighbour they are fully there, so the rings meet without cracks.
+// ======================================================
+class WaterGrid {
+public:
+    static constexpr int kPatchQuads = 8;       // even: odd vertices morph onto even ones
+    static constexpr float kLeafSize = 4.0f;    // metres
+    static constexpr int kLevels = 6;           // node sizes 4 .. 128 m
+    static constexpr int kRoots = 4;            // per side
+    static constexpr float kRangeScale = 4.0f;
+    static constexpr float kMorphStart = 0.875f;
+    static constexpr float kWaveMargin = 0.25f; // vertical slack for the displacement
+
+    struct Node {
+        glm::vec4 data;     // x, z of the corner, size, level
+    };
+
+    std::vector<Node> nodes;
+    glm::vec3 eye = glm::vec3(0.0f);    // of the last selection (morph distances)
+    float height = 0.0f;
+
+    static float nodeSize(int level) { return kLeafSize * (float)(1 << level); }
+    static float range(int level) { return kRangeScale * nodeSize(level); }
+
+    // (start, end) distances of the morph to the next level
+    static glm::vec2 morph(int level) { return glm::vec2(kMorphStart * range(level), range(level)); }
+
+    void initGL() {
+        const int n = kPatchQuads + 1;
+        std::vector<float> grid;
+        grid.reserve((size_t)n * n * 2);
+        for (int z = 0; z < n; ++z)
+            for (int x = 0; x < n; ++x) {
+                grid.push_back((float)x);
+                grid.push_back((float)z);
+            }
+        std::vector<unsigned int> indices;
+        indices.reserve((size_t)kPatchQuads * kPatchQuads * 6);
+        for (int z = 0; z < kPatchQuads; ++z)
+            for (int x = 0; x < kPatchQuads; ++x) {
+                unsigned int i = (unsigned int)(z * n + x);
+                unsigned int tri[6] = { i, i + n, i + 1, i + 1, i + n, i + n + 1 };
+                indices.insert(indices.end(), tri, tri + 6);
+            }
+        indexCount = (int)indices.size();
+
+        glGenVertexArrays(1, &vao);
+        glGenBuffers(1, &gridVbo);
+        glGenBuffers(1, &ebo);
+        glGenBuffers(1, &instanceVbo);
+        glBindVertexArray(vao);
+        glBindBuffer(GL_ARRAY_BUFFER, gridVbo);
+        glBufferData(GL_ARRAY_BUFFER, grid.size() * sizeof(float), grid.data(), GL_STATIC_DRAW);
+        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+        glEnableVertexAttribArray(0);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
+
+        glBindBuffer(GL_ARRAY_BUFFER, instanceVbo);
+        glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(Node), (void*)0);
+        glEnableVertexAttribArray(1);
+        glVertexAttribDivisor(1, 1);
+        glBindVertexArray(0);
+    }
+
+    // Nodes around the eye that touch the frustum
+    int select(const glm::vec3& from, const Frustum& frustum, float surfaceHeight) {
+        nodes.clear();
+        height = surfaceHeight;
+        eye = from;
+        float top = nodeSize(kLevels - 1);
+        float x0 = (std::floor(from.x / top + 0.5f) - kRoots / 2) * top;
+        float z0 = (std::floor(from.z / top + 0.5f) - kRoots / 2) * top;
+        for (int j = 0; j < kRoots; ++j)
+            for (int i = 0; i < kRoots; ++i)
+                selectNode(frustum, x0 + i * top, z0 + j * top, kLevels - 1);
+        return (int)nodes.size();
+    }
+
+    int triangleCount() const { return (int)nodes.size() * kPatchQuads * kPatchQuads * 2; }
+
+    // Instanced patches; the water shader must be in use
+    int draw() {
+        if (nodes.empty()) return 0;
+        glBindBuffer(GL_ARRAY_BUFFER, instanceVbo);
+        glBufferData(GL_ARRAY_BUFFER, nodes.size() * sizeof(Node), nodes.data(), GL_STREAM_DRAW);
+        glBindVertexArray(vao);
+        glDrawElementsInstanced(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, 0, (GLsizei)nodes.size());
+        glBindVertexArray(0);
+        return triangleCount();
+    }
+
+    void release() {
+        if (vao) glDeleteVertexArrays(1, &vao);
+        for (unsigned int* b : { &gridVbo, &ebo, &instanceVbo })
+            if (*b) glDeleteBuffers(1, b);
+        vao = gridVbo = ebo = instanceVbo = 0;
+        nodes.clear();
+    }
+
+private:
+    unsigned int vao = 0, gridVbo = 0, ebo = 0, instanceVbo = 0;
+    int indexCount = 0;
+
+    Aabb nodeBox(float x, float z, float size) const {
+        Aabb b;
+        b.min = glm::vec3(x, height - kWaveMargin, z);
+        b.max = glm::vec3(x + size, height + kWaveMargin, z + size);
+        return b;
+    }
+
+    static bool inRange(const Aabb& b, const glm::vec3& p, float r) {
+        glm::vec3 d = glm::max(glm::max(b.min - p, p - b.max), glm::vec3(0.0f));
+        return glm::dot(d, d) <= r * r;
+    }
+
+    void selectNode(const Frustum& frustum, float x, float z, int level) {
+        float size = nodeSize(level);
+        Aabb box = nodeBox(x, z, size);
+        if (!frustum.intersects(box)) return;
+        if (level > 0 && inRange(box, eye, range(level - 1))) {
+            float half = size * 0.5f;
+            selectNode(frustum, x, z, level - 1);
+            selectNode(frustum, x + half, z, level - 1);
+            selectNode(frustum, x, z + half, level - 1);
+            selectNode(frustum, x + half, z + half, level - 1);
+            return;
+        }
+        nodes.push_back({ glm::vec4(x, z, size, (float)level) });
+    }
+};
+#endif
@@ -0,0 +1,214 @@
+#ifndef WAVES_H
+#define WAVES_H
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include "JobSystem.h"
+#include "Shader.h"
+#include "Simd.h"
+
+// ======================================================
+// Gerstner waves shared by water.vs and the CPU
+// One parameter set drives both: apply() uploads it, sample() evaluates
+// the same sums for query points (things floating on the river). For a
+// grid point x0 and wave i (direction D, k = 2 pi / wavelength):
+//   theta = k D.x0 + w t + phase,  a = amplitude * fade(|x0 - eye|)
+//   P     = (x0.x + Q a D.x cos, a sin, x0.z + Q a D.z cos)   summed over i
+//   N     = (-D.x k a cos, 1 - Q k a sin, -D.z k a cos)      summed over i
+// Each wave fades out between fadeNear and fadeFar wavelengths from the
+// eye, where the CDLOD cells get too coarse to carry it. A query asks for
+// the surface above a world point, so x0 is found by fixed-point
+// iteration on the horizontal offset.
+// ======================================================
+struct GerstnerWave {
+    glm::vec2 dir;          // unit, xz
+    float amplitude;        // metres
+    float wavelength;       // metres
+    float speed;            // angular frequency w, rad/s
+    float steepness;        // Q, 0 = sine .. 1 = sharp crests
+    float phase;
+};
+
+struct WaveSet {
+    static constexpr int kMaxWaves = 8;
+    static constexpr int kInverseSteps = 3;
+
+    std::vector<GerstnerWave> waves;
+    float fadeNear = 6.0f, fadeFar = 10.0f;     // wavelengths from the eye
+
+    // The old slab's two sines (now with crests) plus two short diagonals
+    static WaveSet river() {
+        WaveSet w;
+        w.waves = {
+            { glm::vec2(1.0f, 0.0f), 0.05f, 3.14159f, 2.0f, 0.5f, 0.0f },
+            { glm::vec2(0.0f, 1.0f), 0.05f, 3.14159f, 1.5f, 0.5f, 0.0f },
+            { glm::normalize(glm::vec2(0.7f, 0.7f)), 0.015f, 1.3f, 3.1f, 0.6f, 1.7f },
+            { glm::normalize(glm::vec2(-0.6f, 0.8f)), 0.01f, 0.9f, 3.8f, 0.6f, 4.2f },
+        };
+        return w;
+    }
+
+    float maxHeight() const {
+        float h = 0.0f;
+        for (const GerstnerWave& g : waves) h += g.amplitude;
+        return h;
+    }
+
+    // water.vs: uWaveCount, uWaveA[i] = (dir, amplitude, steepness),
+    // uWaveB[i] = (k, w, phase, wavelength), uWaveFade
+    void apply(const Shader& shader) const {
+        int n = std::min((int)waves.size(), kMaxWaves);
+        shader.setInt("uWaveCount", n);
+        shader.setV2("uWaveFade", glm::vec2(fadeNear, fadeFar));
+        for (int i = 0; i < n; ++i) {
+            const GerstnerWave& g = waves[i];
+            std::string idx = "[" + std::to_string(i) + "]";
+            shader.setV4("uWaveA" + idx, glm::vec4(g.dir, g.amplitude, g.steepness));
+            shader.setV4("uWaveB" + idx, glm::vec4(6.2831853f / g.wavelength, g.speed, g.phase, g.wavelength));
+        }
+    }
+
+    // Surface height and normal above world points (x[i], z[i]), structure
+    // of arrays; eye is the water shader's uEye.xz. Large batches are split
+    // over the job system.
+    void sample(const float* x, const float* z, int count, float t, const glm::vec2& eye,
+                float* height, float* nx, float* ny, float* nz) const {
+        auto run = [&](int begin, int end) { sampleRange(x, z, begin, end, t, eye, height, nx, ny, nz); };
+        if (count >= 4096) JobSystem::instance().parallelFor(count, 1024, run);
+        else run(0, count);
+    }
+
+    float heightAt(float x, float z, float t, const glm::vec2& eye) const {
+        float h, nx, ny, nz;
+        sampleRange(&x, &z, 0, 1, t, eye, &h, &nx, &ny, &nz);
+        return h;
+    }
+
+private:
+    static float smoothstep(float e0, float e1, float v) {
+        float s = std::min(std::max((v - e0) / (e1 - e0), 0.0f), 1.0f);
+        return s * s * (3.0f - 2.0f * s);
+    }
+
+#if CAFE_SSE
+    // sin and cos of four angles: quadrant from round(x * 2 / pi), the rest
+    // by Taylor series on [-pi/4, pi/4] (below float precision there)
+    static void sincos4(__m128 x, __m128& s, __m128& c) {
+        __m128i q = _mm_cvtps_epi32(_mm_mul_ps(x, _mm_set1_ps(0.63661977f)));
+        __m128 qf = _mm_cvtepi32_ps(q);
+        __m128 r = _mm_sub_ps(x, _mm_mul_ps(qf, _mm_set1_ps(1.5703125f)));     // pi / 2 in two parts
+        r = _mm_sub_ps(r, _mm_mul_ps(qf, _mm_set1_ps(4.8382679e-4f)));
+        __m128 r2 = _mm_mul_ps(r, r);
+
+        __m128 ps = _mm_set1_ps(2.7557319e-6f);
+        ps = _mm_add_ps(_mm_mul_ps(ps, r2), _mm_set1_ps(-1.9841270e-4f));
+        ps = _mm_add_ps(_mm_mul_ps(ps, r2), _mm_set1_ps(8.3333333e-3f));
+        ps = _mm_add_ps(_mm_mul_ps(ps, r2), _mm_set1_ps(-1.6666667e-1f));
+        ps = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(ps, r2), r), r);
+
+        __m128 pc = _mm_set1_ps(2.4801587e-5f);
+        pc = _mm_add_ps(_mm_mul_ps(pc, r2), _mm_set1_ps(-1.3888889e-3f));
+        pc = _mm_add_ps(_mm_mul_ps(pc, r2), _mm_set1_ps(4.1666667e-2f));
+        pc = _mm_add_ps(_mm_mul_ps(pc, r2), _mm_set1_ps(-0.5f));
+        pc = _mm_add_ps(_mm_mul_ps(pc, r2), _mm_set1_ps(1.0f));
+
+        // Odd quadrants swap sin and cos; sin flips in 2, 3, cos in 1, 2
+        __m128 swap = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(q, _mm_set1_epi32(1)), _mm_set1_epi32(1)));
+        __m128 sv = _mm_or_ps(_mm_and_ps(swap, pc), _mm_andnot_ps(swap, ps));
+        __m128 cv = _mm_or_ps(_mm_and_ps(swap, ps), _mm_andnot_ps(swap, pc));
+        __m128i sinSign = _mm_slli_epi32(_mm_and_si128(q, _mm_set1_epi32(2)), 30);
+        __m128i cosSign = _mm_slli_epi32(_mm_and_si128(_mm_add_epi32(q, _mm_set1_epi32(1)), _mm_set1_epi32(2)), 30);
+        s = _mm_xor_ps(sv, _mm_castsi128_ps(sinSign));
+        c = _mm_xor_ps(cv, _mm_castsi128_ps(cosSign));
+    }
+
+    static __m128 smoothstep4(__m128 e0, __m128 e1, __m128 v) {
+        __m128 s = _mm_div_ps(_mm_sub_ps(v, e0), _mm_sub_ps(e1, e0));
+        s = _mm_min_ps(_mm_max_ps(s, _mm_setzero_ps()), _mm_set1_ps(1.0f));
+        return _mm_mul_ps(_mm_mul_ps(s, s), _mm_sub_ps(_mm_set1_ps(3.0f), _mm_add_ps(s, s)));
+    }
+#endif
+
+    void sampleRange(const float* x, const float* z, int begin, int end, float t, const glm::vec2& eye,
+                     float* height, float* nx, float* ny, float* nz) const {
+        const int n = std::min((int)waves.size(), kMaxWaves);
+        int i = begin;
+#if CAFE_SSE
+        for (; i + 4 <= end; i += 4) {
+            const __m128 px = _mm_loadu_ps(x + i), pz = _mm_loadu_ps(z + i);
+            const __m128 ex = _mm_set1_ps(eye.x), ez = _mm_set1_ps(eye.y);
+            __m128 x0 = px, z0 = pz;
+            __m128 h = _mm_setzero_ps(), sx = _mm_setzero_ps(), sz = _mm_setzero_ps(), sy = _mm_setzero_ps();
+            for (int step = 0; step <= kInverseSteps; ++step) {
+                __m128 dx = _mm_sub_ps(x0, ex), dz = _mm_sub_ps(z0, ez);
+                __m128 dist = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dz, dz)));
+                __m128 offX = _mm_setzero_ps(), offZ = _mm_setzero_ps();
+                h = sx = sz = sy = _mm_setzero_ps();
+                for (int w = 0; w < n; ++w) {
+                    const GerstnerWave& g = waves[w];
+                    float k = 6.2831853f / g.wavelength;
+                    __m128 a = _mm_mul_ps(_mm_set1_ps(g.amplitude), _mm_sub_ps(_mm_set1_ps(1.0f),
+                        smoothstep4(_mm_set1_ps(g.wavelength * fadeNear), _mm_set1_ps(g.wavelength * fadeFar), dist)));
+                    __m128 theta = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(k),
+                        _mm_add_ps(_mm_mul_ps(_mm_set1_ps(g.dir.x), x0), _mm_mul_ps(_mm_set1_ps(g.dir.y), z0))),
+                        _mm_set1_ps(g.speed * t + g.phase));
+                    __m128 s, c;
+                    sincos4(theta, s, c);
+                    __m128 qac = _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(g.steepness), a), c);
+                    offX = _mm_add_ps(offX, _mm_mul_ps(qac, _mm_set1_ps(g.dir.x)));
+                    offZ = _mm_add_ps(offZ, _mm_mul_ps(qac, _mm_set1_ps(g.dir.y)));
+                    h = _mm_add_ps(h, _mm_mul_ps(a, s));
+                    __m128 kac = _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(k), a), c);
+                    sx = _mm_add_ps(sx, _mm_mul_ps(kac, _mm_set1_ps(g.dir.x)));
+                    sz = _mm_add_ps(sz, _mm_mul_ps(kac, _mm_set1_ps(g.dir.y)));
+                    sy = _mm_add_ps(sy, _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(g.steepness * k), a), s));
+                }
+                if (step < kInverseSteps) {
+                    x0 = _mm_sub_ps(px, offX);
+                    z0 = _mm_sub_ps(pz, offZ);
+                }
+            }
+            __m128 vx = _mm_sub_ps(_mm_setzero_ps(), sx), vy = _mm_sub_ps(_mm_set1_ps(1.0f), sy), vz = _mm_sub_ps(_mm_setzero_ps(), sz);
+            __m128 inv = _mm_div_ps(_mm_set1_ps(1.0f),
+                _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(vx, vx), _mm_mul_ps(vy, vy)), _mm_mul_ps(vz, vz))));
+            _mm_storeu_ps(height + i, h);
+            _mm_storeu_ps(nx + i, _mm_mul_ps(vx, inv));
+            _mm_storeu_ps(ny + i, _mm_mul_ps(vy, inv));
+            _mm_storeu_ps(nz + i, _mm_mul_ps(vz, inv));
+        }
+#endif
+        for (; i < end; ++i) {
+            glm::vec2 p(x[i], z[i]), p0 = p;
+            float h = 0.0f;
+            glm::vec3 slope(0.0f);
+            for (int step = 0; step <= kInverseSteps; ++step) {
+                float dist = glm::length(p0 - eye);
+                glm::vec2 off(0.0f);
+                h = 0.0f;
+                slope = glm::vec3(0.0f);
+                for (int w = 0; w < n; ++w) {
+                    const GerstnerWave& g = waves[w];
+                    float k = 6.2831853f / g.wavelength;
+                    float a = g.amplitude * (1.0f - smoothstep(g.wavelength * fadeNear, g.wavelength * fadeFar, dist));
+                    float theta = k * glm::dot(g.dir, p0) + (g.speed * t + g.phase);
+                    float s = std::sin(theta), c = std::cos(theta);
+                    off += g.steepness * a * c * g.dir;
+                    h += a * s;
+                    slope += glm::vec3(k * a * c * g.dir.x, g.steepness * k * a * s, k * a * c * g.dir.y);
+                }
+                if (step < kInverseSteps) p0 = p - off;
+            }
+            glm::vec3 nrm = glm::normalize(glm::vec3(-slope.x, 1.0f - slope.y, -slope.z));
+            height[i] = h;
+            nx[i] = nrm.x;
+            ny[i] = nrm.y;
+            nz[i] = nrm.z;
+        }
+    }
+};
+#endif
@@ -0,0 +1,17 @@
+#version 330 core
+
+// Depth pre-pass: positions only. gl_Position is invariant and computed
+// exactly as in vertex_shader.vs, so the main pass can test with GL_EQUAL.
+layout (location = 0) in vec3 aPos;
+
+uniform mat4 model;
+uniform mat4 view;
+uniform mat4 projection;
+
+invariant gl_Position;
+
+void main()
+{
+    vec4 worldPos = model * vec4(aPos, 1.0);
+    gl_Position = projection * view * worldPos;
+}
@@ -0,0 +1,18 @@
+#version 330 core
+
+// Reduces the frame's depth to the low-res transparent target: farthest
+// depth of each uScale x uScale footprint, so glass seen past an edge is
+// still drawn (upsample.fs keeps it off the nearer object)
+uniform sampler2D uDepth;
+uniform int uScale;
+
+void main()
+{
+    ivec2 last = textureSize(uDepth, 0) - 1;
+    ivec2 base = ivec2(gl_FragCoord.xy) * uScale;
+    float z = 0.0;
+    for (int j = 0; j < uScale; ++j)
+        for (int i = 0; i < uScale; ++i)
+            z = max(z, texelFetch(uDepth, min(base + ivec2(i, j), last), 0).r);
+    gl_FragDepth = z;
+}
@@ -1,8 +1,11 @@
 #version 330 core
-out vec4 FragColor;
+layout (location = 0) out vec4 FragColor;
+layout (location = 1) out vec4 OitWeight;   // OIT pass only (see Oit.h)
 
 in vec2 TexCoord;
 in vec3 FragPos;
+in vec3 Normal;        // world, bulb lights only
+in vec2 LightmapUV;    // x < 0: not lightmapped
 in vec4 VertexColor;   // used when uComputeMode == 0
 
 uniform vec4 baseColor;
@@ -17,8 +20,102 @@ uniform bool uBlendWithColor;    // multiply texture with baseColor
 uniform int  uComputeMode;       // 0 = vertex computed, 1 = fragment computed
 uniform sampler2D uTex0;
 
+// ---- impostors ----
+uniform float uDitherFade;       // crossfade to an impostor: share of pixels dropped
+uniform bool uBakePass;          // rendering into the impostor atlas: no distance fog
+
+// ---- overdraw heatmap ----
+uniform bool uOverdrawPass;      // every fragment adds 1 to a float target
+
+// ---- FFT water (water.vs) ----
+uniform bool uOcean;
+uniform sampler2D uOceanMap;     // gba = normal
+uniform float uOceanTile;
+uniform vec3 uEye;
+
+// ---- planar reflection (main.cpp, drawReflection) ----
+uniform bool uReflection;
+uniform sampler2D uReflectionMap;   // half resolution, same framing as the screen
+uniform vec2 uViewportSize;
+
+// ---- bulb lights (Clustered.h) ----
+uniform bool uClustered;
+uniform mat4 view;
+uniform mat4 projection;
+uniform ivec3 uClusterDims;         // tiles x, tiles y, slices
+uniform vec2 uClusterDepth;         // slice = log(view depth) * x + y
+uniform usamplerBuffer uClusterGrid;    // per cluster: first index, count
+uniform usamplerBuffer uLightIndices;
+uniform samplerBuffer uLightData;       // per light: position + radius, colour + intensity
+
+// ---- lightmap (Lightmap.h): sqrt(light / range) per layer ----
+uniform bool uLightmap;
+uniform sampler2D uLightmapSky;
+uniform sampler2D uLightmapBulbs;
+uniform vec2 uLightmapRange;        // sky, bulbs (0: bulbs off)
+
+// ---- weighted blended OIT ----
+uniform bool uOitPass;           // glass into the accumulation / weight targets
+
+// Depth weight (McGuire & Bavoil): near layers count more; the clamp keeps
+// the RGBA16F sums in range
+float oitWeight(float alpha)
+{
+    float d = 1.0 - gl_FragCoord.z * 0.9;
+    return clamp(pow(min(1.0, alpha * 10.0) + 0.01, 3.0) * 1e8 * d * d * d, 1e-2, 3e3);
+}
+
+// 4x4 ordered dither threshold in (0, 1); impostor.fs keeps the complement
+float bayer4(vec2 p)
+{
+    const float m[16] = float[16](0.0, 8.0, 2.0, 10.0, 12.0, 4.0, 14.0, 6.0,
+                                  3.0, 11.0, 1.0, 9.0, 15.0, 7.0, 13.0, 5.0);
+    ivec2 i = ivec2(mod(p, 4.0));
+    return (m[i.y * 4 + i.x] + 0.5) / 16.0;
+}
+
+// Bulbs reaching this fragment. The cluster comes from the clip position,
+// not gl_FragCoord, so passes at other resolutions find the same one.
+vec3 clusteredLight(vec3 albedo)
+{
+    vec4 clip = projection * view * vec4(FragPos, 1.0);
+    ivec2 tile = clamp(ivec2((clip.xy / clip.w * 0.5 + 0.5) * vec2(uClusterDims.xy)), ivec2(0), uClusterDims.xy - 1);
+    int slice = clamp(int(log(clip.w) * uClusterDepth.x + uClusterDepth.y), 0, uClusterDims.z - 1);
+    uvec2 list = texelFetch(uClusterGrid, (slice * uClusterDims.y + tile.y) * uClusterDims.x + tile.x).xy;
+
+    // Two-sided: the normal faces whichever side is being seen
+    vec3 n = normalize(Normal);
+    if (dot(n, uEye - FragPos) < 0.0) n = -n;
+
+    vec3 sum = vec3(0.0);
+    for (uint i = 0u; i < list.y; ++i) {
+        int light = int(texelFetch(uLightIndices, int(list.x + i)).r);
+        vec4 pr = texelFetch(uLightData, 2 * light);
+        vec4 ci = texelFetch(uLightData, 2 * light + 1);
+        vec3 l = pr.xyz - FragPos;
+        float d = length(l);
+        if (d >= pr.w) continue;
+        float falloff = 1.0 - d / pr.w;
+        sum += ci.rgb * ci.a * falloff * falloff * max(dot(n, l / d), 0.0);
+    }
+    return albedo * sum;
+}
+
+vec3 bakedLight()
+{
+    vec3 sky = texture(uLightmapSky, LightmapUV).rgb;
+    vec3 bulbs = texture(uLightmapBulbs, LightmapUV).rgb;
+    return sky * sky * uLightmapRange.x + bulbs * bulbs * uLightmapRange.y;
+}
+
 void main()
 {
+    if (uDitherFade > 0.0 && bayer4(gl_FragCoord.xy) < uDitherFade) discard;
+    if (uOverdrawPass) {
+        FragColor = vec4(1.0);
+        return;
+    }
+
     float dist = abs(FragPos.z);
 
     // -------------------------
@@ -41,8 +138,31 @@ void main()
     {
         vec3 result = baseColor.rgb;
 
-        float wave = sin(FragPos.z * 1.8 + time * 1.5) * 0.5 + 0.5;
-        result = mix(result, result * 1.12, wave * 0.15);
+        vec3 n = uOcean ? normalize(texture(uOceanMap, FragPos.xz / uOceanTile).gba) : vec3(0.0, 1.0, 0.0);
+        vec3 v = normalize(uEye - FragPos);
+        float fresnel = 0.02 + 0.98 * pow(1.0 - max(dot(n, v), 0.0), 5.0);
+
+        if (uReflection) {
+            // Mirrored scene at this pixel, pushed around by the surface
+            vec2 ripple = uOcean ? n.xz * 0.08
+                                 : 0.006 * vec2(sin(FragPos.x * 3.1 + time * 2.0), sin(FragPos.z * 2.7 + time * 1.6));
+            vec3 mirrored = texture(uReflectionMap, gl_FragCoord.xy / uViewportSize + ripple).rgb;
+            result = mix(result, mirrored, clamp(0.3 + fresnel, 0.0, 0.8));
+        }
+        else if (uOcean) {
+            // Sky reflection by Fresnel
+            result = mix(result, vec3(0.55, 0.75, 0.95), fresnel);
+        }
+
+        if (uOcean) {
+            // sun glint
+            vec3 sun = normalize(vec3(0.3, 0.8, -0.5));
+            result += vec3(1.0, 0.95, 0.85) * pow(max(dot(reflect(-v, n), sun), 0.0), 200.0);
+        }
+        else {
+            float wave = sin(FragPos.z * 1.8 + time * 1.5) * 0.5 + 0.5;
+            result = mix(result, result * 1.12, wave * 0.15);
+        }
 
         if (FragPos.z < -45.0) {
             float horizonFactor = clamp((abs(FragPos.z) - 45.0) / 30.0, 0.0, 1.0);
@@ -88,6 +208,13 @@ void main()
     // 4) Object fog + distance darkening (keep your look)
     // -------------------------
     vec3 result = finalCol.rgb;
+    if (uBakePass) {
+        FragColor = finalCol;
+        return;
+    }
+
+    if (uLightmap && LightmapUV.x >= 0.0) result *= bakedLight();
+    else if (uClustered) result += clusteredLight(finalCol.rgb);
 
     float darkness = clamp((dist - 10.0) / 70.0, 0.0, 0.35);
     result *= (1.0 - darkness);
@@ -102,5 +229,12 @@ void main()
         result = mix(result, vec3(0.5, 0.7, 1.0), 0.25);
     }
 
+    if (uOitPass) {
+        float w = finalCol.a * oitWeight(finalCol.a);
+        FragColor = vec4(result * w, finalCol.a);
+        OitWeight = vec4(w);
+        return;
+    }
+
     FragColor = vec4(result, finalCol.a);
 }
\ No newline at end of file
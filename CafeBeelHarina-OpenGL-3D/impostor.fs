@@ -0,0 +1,46 @@
+#version 330 core
+out vec4 FragColor;
+
+in vec3 TexCoord;
+in vec3 FragPos;
+flat in float Fade;
+
+uniform sampler2DArray uAtlas;
+uniform bool uOverdrawPass;     // count fragments (see fragment_shader.fs)
+
+// same pattern as fragment_shader.fs: together the two cover every pixel once
+float bayer4(vec2 p)
+{
+    const float m[16] = float[16](0.0, 8.0, 2.0, 10.0, 12.0, 4.0, 14.0, 6.0,
+                                  3.0, 11.0, 1.0, 9.0, 15.0, 7.0, 13.0, 5.0);
+    ivec2 i = ivec2(mod(p, 4.0));
+    return (m[i.y * 4 + i.x] + 0.5) / 16.0;
+}
+
+void main()
+{
+    if (bayer4(gl_FragCoord.xy) >= Fade) discard;
+
+    vec4 c = texture(uAtlas, TexCoord);
+    if (c.a < 0.5) discard;
+    if (uOverdrawPass) {
+        FragColor = vec4(1.0);
+        return;
+    }
+
+    // distance darkening and fog as for regular objects
+    vec3 result = c.rgb;
+    float dist = abs(FragPos.z);
+    float darkness = clamp((dist - 10.0) / 70.0, 0.0, 0.35);
+    result *= (1.0 - darkness);
+
+    if (dist > 55.0) {
+        float fog = clamp((dist - 55.0) / 25.0, 0.0, 1.0);
+        result = mix(result, vec3(0.48, 0.68, 0.92), fog * 0.7);
+    }
+    if (abs(FragPos.z) > 74.5) {
+        result = mix(result, vec3(0.5, 0.7, 1.0), 0.25);
+    }
+
+    FragColor = vec4(result, 1.0);
+}
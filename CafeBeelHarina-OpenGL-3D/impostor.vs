@@ -0,0 +1,25 @@
+#version 330 core
+
+// Camera-facing quad per far table set (see Impostors.h)
+layout (location = 0) in vec2 aCorner;          // -1..1
+layout (location = 1) in vec4 iCenterRadius;
+layout (location = 2) in vec4 iRightLayer;      // w: atlas layer
+layout (location = 3) in vec4 iUpFade;          // w: crossfade
+layout (location = 4) in vec2 iFrameUv;         // lower-left of the frame
+
+out vec3 TexCoord;
+out vec3 FragPos;
+flat out float Fade;
+
+uniform mat4 view;
+uniform mat4 projection;
+uniform float uFrameScale;      // 1 / frames per atlas side
+
+void main()
+{
+    vec3 pos = iCenterRadius.xyz + (aCorner.x * iRightLayer.xyz + aCorner.y * iUpFade.xyz) * iCenterRadius.w;
+    FragPos = pos;
+    TexCoord = vec3(iFrameUv + (aCorner * 0.5 + 0.5) * uFrameScale, iRightLayer.w);
+    Fade = iUpFade.w;
+    gl_Position = projection * view * vec4(pos, 1.0);
+}
@@ -20,11 +20,39 @@
 #include "Camera.h"
 #include "Sphere.h"
 #include "Cylinder.h"
+#include "ConstMesh.h"
+#include "MeshFile.h"
+#include "MeshPool.h"
+#include "MeshSimplify.h"
+#include "PositionStream.h"
+#include "ModelImport.h"
+#include "Oit.h"
+#include "LowResTransparency.h"
+#include "SceneGraph.h"
+#include "Ecs.h"
+#include "SceneFile.h"
+#include "SceneGenerator.h"
+#include "GpuOcclusion.h"
+#include "Portals.h"
+#include "Hlod.h"
+#include "Framebuffer.h"
+#include "Impostors.h"
+#include "WaterGrid.h"
+#include "Ocean.h"
+#include "Waves.h"
+#include "Clustered.h"
+#include "Lightmap.h"
+#include "RenderStats.h"
 #include "stb_image.h"
 
+#include <fstream>
 #include <iostream>
 #include <vector>
+#include <string>
+#include <future>
+#include <chrono>
 #include <cmath>
+#include <sstream>
 
 // ------------------------------
 // Function Prototypes
@@ -33,6 +61,7 @@ void framebuffer_size_callback(GLFWwindow* window, int width, int height);
 void mouse_callback(GLFWwindow* window, double xpos, double ypos);
 void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
 void processInput(GLFWwindow* window);
+void useImportedTableModel(const ImportedModel& m);
 
 // Texture utils
 unsigned int loadTexture(char const* path,
@@ -66,7 +95,7 @@ float deltaTime = 0.0f;
 float lastFrame = 0.0f;
 
 // Scene State
-bool emissiveOn = true;   // kept (for future)
+bool emissiveOn = true;   // 4: canopy bulbs light the scene (Clustered.h)
 bool isWireframe = false;
 
 // Texture Mapping State (wrap/filter keys already exist)
@@ -124,7 +153,7 @@ static void bindTex0(Shader& shader, unsigned int texID, int unit = 0)
 // ======================================================
 // Cube Vertices (pos, normal, uv)
 // ======================================================
-float cubeVertices[] = {
+constexpr float cubeVertices[] = {
     // positions          // normals           // tex coords
     -0.5f, -0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  0.0f, 0.0f,
      0.5f, -0.5f, -0.5f,  0.0f,  0.0f, -1.0f,  1.0f, 0.0f,
@@ -168,6 +197,12 @@ float cubeVertices[] = {
     -0.5f,  0.5f,  0.5f,  0.0f,  1.0f,  0.0f,  0.0f, 0.0f,
     -0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f,  0.0f, 1.0f
 };
+static_assert(sizeof(cubeVertices) == 36 * kVertexStrideBytes, "cube table must be 36 interleaved vertices");
+
+// Built-in curvy primitives, generated at compile time (see ConstMesh.h)
+using SphereMesh = ConstSphere<32, 16>;
+using PlanterMesh = ConstCylinder<16, 1>;
+using ConeMesh = ConstCone<40>;
 
 // ======================================================
 // Simple Cone (curvy object)
@@ -198,19 +233,24 @@ struct SimpleCone {
             push(tip, glm::vec2(((float)i + 0.5f) / segments, 1.0f));
         }
 
-        vertexCount = (int)(v.size() / 8);
+        upload(v.data(), (int)(v.size() / kVertexStride));
+    }
+
+    // Upload prebuilt data (e.g. ConstCone<>) as-is
+    void upload(const float* data, int count) {
+        vertexCount = count;
 
         glGenVertexArrays(1, &VAO);
         glGenBuffers(1, &VBO);
         glBindVertexArray(VAO);
         glBindBuffer(GL_ARRAY_BUFFER, VBO);
-        glBufferData(GL_ARRAY_BUFFER, v.size() * sizeof(float), v.data(), GL_STATIC_DRAW);
+        glBufferData(GL_ARRAY_BUFFER, vertexCount * kVertexStrideBytes, data, GL_STATIC_DRAW);
 
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, kVertexStrideBytes, (void*)0);
         glEnableVertexAttribArray(0);
-        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, kVertexStrideBytes, (void*)(3 * sizeof(float)));
         glEnableVertexAttribArray(1);
-        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
+        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, kVertexStrideBytes, (void*)(6 * sizeof(float)));
         glEnableVertexAttribArray(2);
 
         glBindVertexArray(0);
@@ -225,6 +265,68 @@ struct SimpleCone {
 
 SimpleCone gCone; // global cone
 
+// ======================================================
+// Imported Models (--table-model <file.obj|.gltf|.glb>)
+// Parsed on worker threads, uploaded into one shared MeshPool
+// ======================================================
+MeshPool gModelPool;
+std::future<ImportedModel> gTableModelJob;
+PooledMesh gTableModelMesh;
+std::vector<ModelPart> gTableModelParts;
+bool gTableModelReady = false;
+
+// Called once per frame; uploads the table model as soon as its worker is done
+void pollModelImports()
+{
+    if (!gTableModelJob.valid() || gTableModelJob.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+        return;
+
+    ImportedModel m = gTableModelJob.get();
+    if (!m.ok) {
+        std::cout << "Model import failed: " << m.path << " (" << m.error << ")\n";
+        return;
+    }
+
+    gTableModelMesh = gModelPool.add(m.mesh);
+    gTableModelParts = m.parts;
+    gTableModelReady = true;
+    useImportedTableModel(m);
+    std::cout << "Imported " << m.path << ": " << m.mesh.vertexCount() << " vertices, "
+              << m.mesh.triangleCount() << " triangles, " << m.parts.size() << " parts\n";
+}
+
+// ======================================================
+// Offline Mesh Bake (--bake-meshes <dir>)
+// Writes the built-in primitives, with a small LOD chain, as .cbm files
+// ======================================================
+bool bakeBuiltinMeshes(const std::string& dir)
+{
+    bool ok = true;
+
+    ok &= writeMeshFile(dir + "/cube.cbm",
+        { MeshData::fromArrays(cubeVertices, 36) },
+        { 0.0f });
+
+    ok &= writeMeshFile(dir + "/sphere.cbm", {
+            MeshData::fromArrays(SphereMesh::vertices.data(), SphereMesh::kVertexCount, SphereMesh::indices.data(), SphereMesh::kIndexCount),
+            MeshData::fromArrays(ConstSphere<16, 8>::vertices.data(), ConstSphere<16, 8>::kVertexCount, ConstSphere<16, 8>::indices.data(), ConstSphere<16, 8>::kIndexCount),
+            MeshData::fromArrays(ConstSphere<8, 4>::vertices.data(), ConstSphere<8, 4>::kVertexCount, ConstSphere<8, 4>::indices.data(), ConstSphere<8, 4>::kIndexCount) },
+        { 0.10f, 0.03f, 0.0f });
+
+    ok &= writeMeshFile(dir + "/planter.cbm", {
+            MeshData::fromArrays(PlanterMesh::vertices.data(), PlanterMesh::kVertexCount, PlanterMesh::indices.data(), PlanterMesh::kIndexCount),
+            MeshData::fromArrays(ConstCylinder<8>::vertices.data(), ConstCylinder<8>::kVertexCount, ConstCylinder<8>::indices.data(), ConstCylinder<8>::kIndexCount) },
+        { 0.05f, 0.0f });
+
+    ok &= writeMeshFile(dir + "/cone.cbm", {
+            MeshData::fromArrays(ConeMesh::vertices.data(), ConeMesh::kVertexCount),
+            MeshData::fromArrays(ConstCone<12>::vertices.data(), ConstCone<12>::kVertexCount) },
+        { 0.05f, 0.0f });
+
+    std::cout << (ok ? "Baked built-in meshes to " : "Mesh bake failed for ") << dir << "\n";
+    return ok;
+}
+
 // ======================================================
 // Draw Cube (TEXTURE ENABLED)
 // ======================================================
@@ -256,182 +358,485 @@ void drawCube(Shader& shader, unsigned int vao,
 }
 
 // ======================================================
-// Cafe Objects (Realistic Curvy Objects)
+// Scene Entities
+// The static cafe is loaded from a scene file (cafe.scene, or its compiled
+// .cscn form) into gEntities; sky and water keep their own special-cased draws.
 // ======================================================
-void drawMug(Shader& shader, Cylinder& cylinder, glm::vec3 pos, float radius, float height, glm::vec4 color, unsigned int texID = 0) {
-    // Body - height is along the cylinder's local Z axis (before rotation)
-    glm::mat4 model = glm::mat4(1.0f);
-    model = glm::translate(model, pos);
-    model = glm::rotate(model, glm::radians(90.0f), glm::vec3(1, 0, 0)); // Z-axis to Y-axis
-    model = glm::scale(model, glm::vec3(radius, radius, height));
-    shader.setMat4("model", model);
-    shader.setV4("baseColor", color);
-    
-    applyTexModeToShader(shader);
-    if (texID != 0 && gTexMode != TEX_OFF) bindTex0(shader, texID, 0);
-    else shader.setBool("uUseTexture", false);
-    
-    cylinder.draw();
-
-    // Handle (small vertical cylinder segment on the side)
-    model = glm::mat4(1.0f);
-    model = glm::translate(model, pos + glm::vec3(radius * 0.9f, 0, 0));
-    model = glm::rotate(model, glm::radians(90.0f), glm::vec3(1, 0, 0));
-    model = glm::scale(model, glm::vec3(radius * 0.25f, radius * 0.25f, height * 0.7f));
-    shader.setMat4("model", model);
-    shader.setV4("baseColor", color * 0.8f);
-    shader.setBool("uUseTexture", false); 
-    cylinder.draw();
+Aabb meshLocalBounds(SceneMesh mesh)
+{
+    Aabb b;
+    switch (mesh) {
+    case MESH_CUBE:     b.min = glm::vec3(-0.5f);               b.max = glm::vec3(0.5f); break;
+    case MESH_SPHERE:   b.min = glm::vec3(-1.0f);               b.max = glm::vec3(1.0f); break;
+    case MESH_CYLINDER: b.min = glm::vec3(-1.0f, -1.0f, -0.5f); b.max = glm::vec3(1.0f, 1.0f, 0.5f); break;
+    case MESH_CONE:     b.min = glm::vec3(-1.0f, 0.0f, -1.0f);  b.max = glm::vec3(1.0f, 1.0f, 1.0f); break;
+    default: break;     // table model: filled in when the import finishes; batches carry their own
+    }
+    return b;
 }
 
-void drawCup(Shader& shader, Cylinder& cylinder, glm::vec3 pos, float radius, float height, glm::vec4 color, unsigned int texID = 0) {
-    // Body
-    glm::mat4 model = glm::mat4(1.0f);
-    model = glm::translate(model, pos);
-    model = glm::rotate(model, glm::radians(90.0f), glm::vec3(1, 0, 0));
-    model = glm::scale(model, glm::vec3(radius, radius, height));
-    shader.setMat4("model", model);
-    shader.setV4("baseColor", color);
-
-    applyTexModeToShader(shader);
-    if (texID != 0 && gTexMode != TEX_OFF) bindTex0(shader, texID, 0);
-    else shader.setBool("uUseTexture", false);
-
-    cylinder.draw();
+// Local geometry of the built-in meshes, used when compiling static batches
+bool builtinMeshData(SceneMesh mesh, MeshData& out)
+{
+    switch (mesh) {
+    case MESH_CUBE:     out = MeshData::fromArrays(cubeVertices, 36); return true;
+    case MESH_SPHERE:   out = MeshData::fromArrays(SphereMesh::vertices.data(), SphereMesh::kVertexCount, SphereMesh::indices.data(), SphereMesh::kIndexCount); return true;
+    case MESH_CYLINDER: out = MeshData::fromArrays(PlanterMesh::vertices.data(), PlanterMesh::kVertexCount, PlanterMesh::indices.data(), PlanterMesh::kIndexCount); return true;
+    case MESH_CONE:     out = MeshData::fromArrays(ConeMesh::vertices.data(), ConeMesh::kVertexCount); return true;
+    default:            return false;
+    }
 }
 
-// Outline helper
-void drawCubeWithOutline(Shader& shader, unsigned int vao,
-    glm::vec3 pos, glm::vec3 scale,
-    glm::vec4 color, float outlineThickness = 0.05f)
+unsigned int sceneTextureID(uint32_t slot)
 {
-    glm::vec4 outlineColor = glm::vec4(0.05f, 0.05f, 0.07f, 1.0f);
-    drawCube(shader, vao, pos, scale + glm::vec3(outlineThickness), outlineColor, 0);
-    drawCube(shader, vao, pos, scale, color, 0);
+    switch (slot) {
+    case SCENE_TEX_WOOD:   return woodTexture;
+    case SCENE_TEX_WATER:  return waterTexture;
+    case SCENE_TEX_CANOPY: return canopyTexture;
+    default:               return 0;
+    }
 }
 
-// ======================================================
-// Stylized Table Set (textured)
-// ======================================================
-void drawStylizedTableSet(Shader& shader, Sphere& sphere, Cylinder& cylinder, unsigned int vao, glm::vec3 offset, float zDist)
+SceneGraph gScene;
+EntityStore gEntities;
+DrawList gDrawList;
+RenderStats gStats;
+
+// Static batches: pre-transformed geometry, one draw per batch
+MeshPool gStaticBatchPool;
+std::vector<PooledMesh> gStaticBatches;
+
+// BVH over gEntities.bounds: rebuilt after a (re)load, refit when boxes change
+Bvh gBvh;
+bool gBvhRebuild = true;
+bool gBvhRefit = false;
+bool gUseBvh = true;                // B: BVH vs linear culling
+std::vector<int> gVisibleEntities;  // last BVH cull result
+
+// Software occlusion (U): floors flagged `occluder` hide what is behind them
+OcclusionCuller gOcclusion;
+bool gOcclusionOn = true;
+
+// Cells and portals from the scene file (V)
+CellPortalGraph gCells;
+PortalView gPortalView;
+bool gPortalsOn = true;
+
+// GPU occlusion queries per table set (G)
+OcclusionQueries gSetQueries;
+bool gGpuOcclusionOn = false;
+bool gSetBoundsDirty = true;
+
+int gPickedGroup = -1;              // table set under the crosshair (E)
+bool gPickRequested = false;
+
+// HLOD proxies for far table sets and pavilions (L)
+Hlod gHlod;
+bool gHlodOn = true;
+bool gHlodBuilt = false;
+unsigned int gHlodAtlas[3] = { 0, 0, 0 };   // material colours as seen with texture off / simple / blended
+
+// Impostors for far table sets (I); replace HLOD while on
+Impostors gImpostors;
+bool gImpostorsOn = false;
+bool gImpostorsDirty = true;        // regroup and rebake: new scene, texture mode change
+Shader* gImpostorShader = nullptr;
+
+// Fullscreen passes (heatmap, OIT composite): an empty VAO, the triangle
+// comes from gl_VertexID in fullscreen.vs
+unsigned int gFullscreenVAO = 0;
+
+// Draw order (Y): opaque front to back with blending off, then glass back to
+// front without depth writes. Off: one blended pass, sky first, glass in
+// creation order. The overdraw counter reports samples per pixel either way.
+bool gDepthOrderOn = true;
+OverdrawCounter gOverdraw;
+
+// Stats report (X): overdraw, GPU occlusion, reflection, light and water
+// costs printed every 2 s. Off by default; --bench writes them to its CSV.
+bool gStatsReportOn = false;
+
+// Overdraw heatmap (H): the frame is counted into a float target instead
+// (every fragment passing the depth test adds 1), then shown colour-ramped
+Framebuffer gHeatmapTarget;
+bool gHeatmapOn = false;
+Shader* gHeatmapShader = nullptr;
+std::vector<float> gHeatmapCounts;
+
+// Depth pre-pass (Z): opaque entities first lay down depth from position-only
+// streams with a trivial shader; the full shader then runs only where
+// GL_EQUAL passes. Not used with the per-set queries (G).
+bool gDepthPrepassOn = false;
+Shader* gDepthShader = nullptr;
+PositionStream gCubeDepth, gSphereDepth, gCylinderDepth, gConeDepth;
+
+// Order-independent transparency (O): glass is accumulated in any order and
+// composited once (Oit.h). Not in the heatmap, which counts glass layers.
+bool gOitOn = false;
+bool gOitThisFrame = false;
+OitTarget gOit;
+Shader* gOitShader = nullptr;
+
+// Transparent resolution (T): glass at 1/gTransparentScale of the window,
+// put back with a depth-aware upsample (LowResTransparency.h). Blended
+// glass only; OIT and the heatmap stay at full resolution.
+int gTransparentScale = 1;
+bool gLowResThisFrame = false;
+LowResTransparency gLowRes;
+Shader* gDepthDownShader = nullptr;
+Shader* gUpsampleShader = nullptr;
+
+// Water: CDLOD patches around the camera (WaterGrid.h), selected once per
+// frame against the view frustum
+WaterGrid gWater;
+Shader* gWaterShader = nullptr;
+const float kWaterHeight = -2.45f;
+
+// Gerstner waves of the CDLOD water; WaveSet::sample gives floating
+// objects the same surface on the CPU
+WaveSet gWaves = WaveSet::river();
+
+// Spectral water (N): FFT height field simulated on the CPU every frame
+// (Ocean.h) instead of the two sines; resolution from --ocean, 64..512
+bool gOceanOn = false;
+int gOceanResolution = 128;
+Ocean gOcean;
+
+// Planar reflection (Q): opaque entities and sky mirrored about the water
+// into a half-resolution target, sampled by the water shader
+bool gReflectionOn = true;
+Framebuffer gReflectionTarget;
+GpuStampTimer gReflectionTimer;
+std::vector<int> gReflectionList;
+const float kReflectionLodBias = 0.5f;      // HLOD sees the objects at half their size
+const float kReflectionMinPixels = 6.0f;    // smaller ones (in the half-res target) are left out
+
+// Bulb lights (4): entities flagged `light` become point lights, assigned
+// to view clusters on the CPU each frame and summed per fragment. Only the
+// main passes are lit; reflection, bakes and the HLOD atlas are not.
+ClusteredLights gLights;
+std::vector<int> gLightEntities;
+const float kBulbRadius = 6.0f;
+const float kBulbIntensity = 1.5f;
+const int kClusterUnit = 5;     // units 5..7
+
+// Lightmap (K): sky and bulb light path traced once into an atlas for the
+// static boxes (Lightmap.h); those skip the bulb loop while it is on
+bool gLightmapOn = false;
+bool gLightmapDirty = true;         // rebake: new scene, table sets swapped
+bool gLightmapThisFrame = false;
+Lightmap gLightmap;
+const int kLightmapUnit = 8;        // units 8, 9
+const glm::vec4 kNoLightmap[6] = {};
+
+// Creates graph nodes, entities and batch buffers. Works the same on a
+// freshly compiled SceneDesc and on a mapped .cscn (read in place).
+void instantiateScene(const SceneData& d)
 {
-    float depthScale = 1.0f - glm::clamp((zDist + 5.0f) / 100.0f, 0.0f, 0.15f);
+    gBvhRebuild = true;
+    int nodeBase = gScene.size();
+    for (int i = 0; i < d.nodeCount; ++i) {
+        const SceneNode& n = d.nodes[i];
+        gScene.addNode(n.parent < 0 ? -1 : nodeBase + n.parent, glm::make_mat4(n.local));
+    }
 
-    glm::vec4 tableColor = glm::vec4(0.70f, 0.48f, 0.25f, 1.0f);
-    glm::vec4 chairColor = glm::vec4(0.20f, 0.14f, 0.10f, 1.0f);
+    for (int i = 0; i < d.objectCount; ++i) {
+        const SceneObject& o = d.objects[i];
+        const SceneMaterial& m = d.materials[o.material];
+        int node = nodeBase + o.node;
+        int e = gEntities.create(gScene.world(node), meshLocalBounds((SceneMesh)o.mesh), (int)o.mesh,
+            glm::make_vec4(m.color), sceneTextureID(m.texture), o.flags, node, o.group);
+        if (o.flags & ENT_LIGHT) gLightEntities.push_back(e);
+    }
 
-    float rot = 5.0f * sin(offset.x * 0.5f + offset.z * 0.3f);
-    float vH = 0.2f;
+    int cellBase = (int)gCells.cells.size();
+    for (int i = 0; i < d.cellCount; ++i) {
+        Aabb b;
+        b.min = glm::make_vec3(d.cells[i].boundsMin);
+        b.max = glm::make_vec3(d.cells[i].boundsMax);
+        gCells.addCell(b);
+    }
+    for (int i = 0; i < d.portalCount; ++i) {
+        const ScenePortal& p = d.portals[i];
+        Aabb r;
+        r.min = glm::make_vec3(p.rectMin);
+        r.max = glm::make_vec3(p.rectMax);
+        gCells.addPortal(cellBase + p.cellA, cellBase + p.cellB, r);
+    }
 
-    auto drawPart = [&](glm::vec3 pos, glm::vec3 scale, glm::vec4 color, unsigned int texID) {
-        glm::mat4 model = glm::mat4(1.0f);
-        model = glm::translate(model, offset);
-        model = glm::rotate(model, glm::radians(rot), glm::vec3(0, 1, 0));
-        model = glm::translate(model, pos + glm::vec3(0, vH, 0));
-        model = glm::scale(model, scale * depthScale);
+    if (d.batchCount == 0) return;
+    if (!gStaticBatchPool.vao) gStaticBatchPool.init(d.batchVertexCount, d.batchIndexCount);
 
-        shader.setMat4("model", model);
-        shader.setV4("baseColor", color);
+    for (int i = 0; i < d.batchCount; ++i) {
+        const SceneBatch& b = d.batches[i];
+        const SceneMaterial& m = d.materials[b.material];
 
-        applyTexModeToShader(shader);
-        if (texID != 0 && gTexMode != TEX_OFF) bindTex0(shader, texID, 0);
-        else shader.setBool("uUseTexture", false);
+        Aabb bounds;
+        bounds.min = glm::make_vec3(b.boundsMin);
+        bounds.max = glm::make_vec3(b.boundsMax);
 
-        glBindVertexArray(vao);
-        glDrawArrays(GL_TRIANGLES, 0, 36);
-    };
+        gEntities.create(glm::mat4(1.0f), bounds, MESH_BATCH + (int)gStaticBatches.size(),
+            glm::make_vec4(m.color), sceneTextureID(m.texture), b.flags);
+        gStaticBatches.push_back(gStaticBatchPool.add(d.batchVertices + (size_t)b.baseVertex * kVertexStride, (int)b.vertexCount,
+            d.batchIndices + b.firstIndex, (int)b.indexCount));
+    }
+}
 
-    // Table (wood texture)
-    drawPart(glm::vec3(0, 0.62f, 0), glm::vec3(2.4f, 0.12f, 1.4f), tableColor, woodTexture);
-    drawPart(glm::vec3(0, 0.58f, 0), glm::vec3(2.42f, 0.08f, 1.42f), tableColor * 0.88f, woodTexture);
+// Imported table model replaces every table set's parts (also after a scene reload)
+Aabb gTableModelBounds;
 
-    // Mugs/Cups on table (Table top surface is at Y=0.88)
-    // Mug (Sit on surface: item height 0.5 -> center at 0.88 + 0.25 = 1.13)
-    drawMug(shader, cylinder, offset + glm::vec3(-0.6f, 1.13f, 0.3f), 0.18f * depthScale, 0.5f * depthScale, glm::vec4(1.0f, 0.95f, 0.9f, 1.0f), waterTexture);
-    // Cup (Sit on surface: item height 0.4 -> center at 0.88 + 0.20 = 1.08)
-    drawCup(shader, cylinder, offset + glm::vec3(0.6f, 1.08f, -0.3f), 0.20f * depthScale, 0.4f * depthScale, glm::vec4(0.5f, 0.8f, 1.0f, 1.0f), waterTexture);
+void showImportedTableModel()
+{
+    for (int e = 0; e < gEntities.size(); ++e) {
+        if (gEntities.group[e] < 0) continue;
+        if (gEntities.mesh[e] == MESH_TABLE_MODEL) {
+            gEntities.setLocalBounds(e, gTableModelBounds);
+            gEntities.flags[e] &= ~ENT_HIDDEN;
+        }
+        else gEntities.flags[e] |= ENT_HIDDEN;
+    }
+    gBvhRefit = true;
+    gImpostorsDirty = true;
+    gLightmapDirty = true;
+}
 
-    // Small "Curvy" Objects (Sphere + Cone as buns/vases)
-    applyTexModeToShader(shader);
-    if (gTexMode != TEX_OFF) bindTex0(shader, waterTexture, 0); 
-    else shader.setBool("uUseTexture", false);
-
-    // Small Sphere (Bun/Fruit - radius 0.15 -> center at 0.88 + 0.15 = 1.03)
-    glm::mat4 sM = glm::mat4(1.0f);
-    sM = glm::translate(sM, offset + glm::vec3(-0.2f, 1.03f, -0.2f));
-    sM = glm::scale(sM, glm::vec3(0.15f * depthScale));
-    shader.setMat4("model", sM);
-    shader.setV4("baseColor", glm::vec4(0.9f, 0.7f, 0.3f, 1.0f));
-    sphere.draw();
-
-    // Small Tapered Object (Cone as a small vase - height 0.4 -> center at 0.88 + 0.2 = 1.08)
-    sM = glm::mat4(1.0f);
-    sM = glm::translate(sM, offset + glm::vec3(0.2f, 1.08f, 0.5f));
-    sM = glm::scale(sM, glm::vec3(0.12f, 0.4f, 0.12f) * depthScale);
-    shader.setMat4("model", sM);
-    shader.setV4("baseColor", glm::vec4(0.8f, 0.4f, 0.2f, 1.0f));
-    gCone.draw();
-
-    // Legs
-    drawPart(glm::vec3(-0.9f, 0.3f, -0.5f), glm::vec3(0.12f, 0.8f, 0.12f), tableColor * 0.9f, woodTexture);
-    drawPart(glm::vec3(0.9f, 0.3f, -0.5f), glm::vec3(0.12f, 0.8f, 0.12f), tableColor * 0.9f, woodTexture);
-    drawPart(glm::vec3(-0.9f, 0.3f, 0.5f), glm::vec3(0.12f, 0.8f, 0.12f), tableColor * 0.9f, woodTexture);
-    drawPart(glm::vec3(0.9f, 0.3f, 0.5f), glm::vec3(0.12f, 0.8f, 0.12f), tableColor * 0.9f, woodTexture);
-
-    // Chairs (wood texture too)
-    glm::vec3 chairPos[] = {
-        glm::vec3(0.0f, 0.0f, 1.6f),
-        glm::vec3(0.0f, 0.0f, -1.6f),
-        glm::vec3(1.7f, 0.0f, 0.0f),
-        glm::vec3(-1.7f, 0.0f, 0.0f)
-    };
-    float chairRots[] = { 0.0f, 180.0f, 90.0f, -90.0f };
+void useImportedTableModel(const ImportedModel& m)
+{
+    gTableModelBounds.min = m.boundsMin;
+    gTableModelBounds.max = m.boundsMax;
+    showImportedTableModel();
+}
 
-    for (int i = 0; i < 4; ++i) {
-        float chairRot = chairRots[i];
+// Text scenes are compiled on load; binary ones are mapped and uploaded in place
+bool loadScene(const std::string& path)
+{
+    if (SceneFileView::isBinary(path)) {
+        SceneFileView view;
+        if (!view.open(path)) return false;
+        instantiateScene(view.view());
+    }
+    else {
+        SceneDesc desc;
+        if (!compileSceneFile(path, builtinMeshData, desc)) return false;
+        instantiateScene(desc.view());
+    }
 
-        auto drawChairPart = [&](glm::vec3 p, glm::vec3 s, glm::vec4 c, unsigned int texID) {
-            glm::mat4 model = glm::mat4(1.0f);
-            model = glm::translate(model, offset);
-            model = glm::rotate(model, glm::radians(rot), glm::vec3(0, 1, 0));
-            model = glm::translate(model, chairPos[i] + glm::vec3(0, vH, 0));
-            model = glm::rotate(model, glm::radians(chairRot), glm::vec3(0, 1, 0));
-            model = glm::translate(model, p);
-            model = glm::scale(model, s * depthScale);
+    if (gTableModelReady) showImportedTableModel();
+    return true;
+}
 
-            shader.setMat4("model", model);
-            shader.setV4("baseColor", c);
+// --generate <frames> <sets> <seed>
+bool loadGeneratedScene(int frames, int setsPerFrame, uint32_t seed, CafeLayoutInfo* info = nullptr)
+{
+    SceneDesc desc;
+    std::string error;
+    if (!compileSceneText(generateCafeLayout(frames, setsPerFrame, seed, info), "", builtinMeshData, desc, error)) {
+        std::cout << "ERROR::SCENE::GENERATE: " << error << std::endl;
+        return false;
+    }
+    instantiateScene(desc.view());
+    if (gTableModelReady) showImportedTableModel();
+    return true;
+}
 
-            applyTexModeToShader(shader);
-            if (texID != 0 && gTexMode != TEX_OFF) bindTex0(shader, texID, 0);
-            else shader.setBool("uUseTexture", false);
+// Drops every entity, node and static batch
+void resetScene()
+{
+    gScene.clear();
+    gEntities.clear();
+    gStaticBatches.clear();
+    gStaticBatchPool.release();
+    gBvh.clear();
+    gVisibleEntities.clear();
+    gBvhRebuild = true;
+    gSetQueries.release();
+    gCells.clear();
+    gPickedGroup = -1;
+    gHlod.clear();
+    gHlodBuilt = false;
+    glDeleteTextures(3, gHlodAtlas);
+    gHlodAtlas[0] = gHlodAtlas[1] = gHlodAtlas[2] = 0;
+    gImpostors.clear();
+    gImpostorsDirty = true;
+    gLightEntities.clear();
+    gLightmap.release();
+    gLightmapDirty = true;
+}
 
-            glBindVertexArray(vao);
-            glDrawArrays(GL_TRIANGLES, 0, 36);
-        };
+bool compileScene(const std::string& textPath, const std::string& outPath)
+{
+    SceneDesc desc;
+    bool ok = compileSceneFile(textPath, builtinMeshData, desc) && writeSceneBinary(outPath, desc);
+    std::cout << (ok ? "Compiled scene to " : "Scene compile failed for ") << outPath << "\n";
+    if (ok)
+        std::cout << desc.nodes.size() << " nodes, " << desc.objects.size() << " objects, " << desc.batches.size() << " static batches\n";
+    return ok;
+}
 
-        drawChairPart(glm::vec3(0, 0.42f, 0), glm::vec3(1.1f, 0.15f, 1.1f), chairColor, woodTexture);
-        drawChairPart(glm::vec3(0, 1.0f, 0.5f), glm::vec3(1.1f, 1.0f, 0.1f), chairColor, woodTexture);
+// ======================================================
+// Offline LOD Generation (--simplify <scene|model> <dir>)
+// Every static batch of a scene, or an imported OBJ / glTF model, gets a
+// simplified LOD chain written as <dir>/<name>.cbm. Meshes are simplified
+// in parallel; a model's material parts are kept apart like UV seams.
+// A level is used down to the screen size where the next one's error
+// stays under a pixel at 1080p.
+// ======================================================
+bool simplifyToLods(const std::string& inPath, const std::string& outDir)
+{
+    size_t slash = inPath.find_last_of("/\\");
+    std::string stem = inPath.substr(slash == std::string::npos ? 0 : slash + 1);
+    stem = stem.substr(0, stem.find_last_of('.'));
+
+    std::vector<MeshData> meshes;
+    std::vector<std::vector<int>> regions;
+    std::vector<std::string> names;
+
+    SceneFileView view;
+    SceneDesc desc;
+    if (SceneFileView::isBinary(inPath) || modelimport::lowerExtension(inPath) == "scene") {
+        SceneData d;
+        if (SceneFileView::isBinary(inPath)) {
+            if (!view.open(inPath)) return false;
+            d = view.view();
+        }
+        else {
+            if (!compileSceneFile(inPath, builtinMeshData, desc)) return false;
+            d = desc.view();
+        }
+        for (int i = 0; i < d.batchCount; ++i) {
+            const SceneBatch& b = d.batches[i];
+            meshes.push_back(MeshData::fromArrays(d.batchVertices + (size_t)b.baseVertex * kVertexStride, (int)b.vertexCount,
+                d.batchIndices + b.firstIndex, (int)b.indexCount));
+            regions.emplace_back(meshes.back().triangleCount(), 0);
+            names.push_back(stem + "_batch" + std::to_string(i));
+        }
+    }
+    else {
+        ImportedModel m = importModel(inPath);
+        if (!m.ok) {
+            std::cout << "ERROR::SIMPLIFY::IMPORT: " << inPath << ": " << m.error << std::endl;
+            return false;
+        }
+        std::vector<int> partOf(m.mesh.triangleCount(), 0);
+        for (size_t p = 0; p < m.parts.size(); ++p)
+            for (unsigned int t = m.parts[p].firstIndex / 3; t < (m.parts[p].firstIndex + m.parts[p].indexCount) / 3; ++t)
+                partOf[t] = (int)p;
+        meshes.push_back(std::move(m.mesh));
+        regions.push_back(std::move(partOf));
+        names.push_back(stem);
+    }
+    if (meshes.empty()) {
+        std::cout << "Nothing to simplify in " << inPath << "\n";
+        return false;
+    }
 
-        drawChairPart(glm::vec3(-0.4f, 0.2f, -0.4f), glm::vec3(0.15f, 0.4f, 0.15f), chairColor * 0.85f, woodTexture);
-        drawChairPart(glm::vec3(0.4f, 0.2f, -0.4f), glm::vec3(0.15f, 0.4f, 0.15f), chairColor * 0.85f, woodTexture);
-        drawChairPart(glm::vec3(-0.4f, 0.2f, 0.4f), glm::vec3(0.15f, 0.4f, 0.15f), chairColor * 0.85f, woodTexture);
-        drawChairPart(glm::vec3(0.4f, 0.2f, 0.4f), glm::vec3(0.15f, 0.4f, 0.15f), chairColor * 0.85f, woodTexture);
+    auto start = std::chrono::high_resolution_clock::now();
+    std::vector<std::vector<float>> errors;
+    std::vector<std::vector<MeshData>> chains = buildLodChains(meshes, 4, 0.5f, 0.05f, &errors, &regions);
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+    bool ok = true;
+    for (size_t i = 0; i < chains.size(); ++i) {
+        std::vector<float> screenSizes;
+        std::cout << names[i] << ":";
+        for (size_t l = 0; l < chains[i].size(); ++l) {
+            float next = l + 1 < chains[i].size() ? errors[i][l + 1] : 0.0f;
+            screenSizes.push_back(next > 0.0f ? std::min(1.0f, 2.0f / (1080.0f * next)) : 0.0f);
+            std::cout << " " << chains[i][l].triangleCount() << " tris";
+            if (l > 0) std::cout << " (error " << errors[i][l] << ")";
+        }
+        std::cout << "\n";
+        ok &= writeMeshFile(outDir + "/" + names[i] + ".cbm", chains[i], screenSizes);
     }
+    std::cout << "Simplified " << meshes.size() << " meshes in " << ms << " ms\n";
+    return ok;
 }
 
 // ======================================================
-// Full Scene
+// Entity Submission
 // ======================================================
-void drawRiversideScene(Shader& shader, Sphere& sphere, Cylinder& cylinder, unsigned int cubeVAO, float time)
+void drawEntities(Shader& shader, const std::vector<int>& list, Sphere& sphere, Cylinder& cylinder, unsigned int cubeVAO)
 {
-    glm::mat4 model;
+    const EntityStore& s = gEntities;
+    for (int e : list) {
+        // picked table set is drawn warmer
+        bool picked = gPickedGroup >= 0 && s.group[e] == gPickedGroup;
+        auto tint = [&](glm::vec4 c) { return picked ? glm::vec4(glm::mix(glm::vec3(c), glm::vec3(1.0f, 0.8f, 0.35f), 0.4f), c.a) : c; };
+
+        shader.setMat4("model", s.world[e]);
+        shader.setV4("baseColor", tint(s.color[e]));
+        shader.setFloat("uDitherFade", gImpostors.fadeOf(s.group[e]));
+        if (gLightmapThisFrame) {
+            const glm::vec4* rects = gLightmap.rectsOf(e);
+            glUniform4fv(glGetUniformLocation(shader.ID, "uLightmapRects"), 6, glm::value_ptr((rects ? rects : kNoLightmap)[0]));
+        }
 
-    shader.setBool("isDeck", false);
-    shader.setBool("isSky", false);
-    shader.setBool("isWater", false);
+        applyTexModeToShader(shader);
+        if (s.flags[e] & ENT_BAKED) {
+            // HLOD proxy: the atlas already holds the look of the current mode
+            shader.setBool("uUseTexture", true);
+            shader.setBool("uBlendWithColor", false);
+            bindTex0(shader, gHlodAtlas[gTexMode == TEX_OFF ? 0 : gTexMode == TEX_SIMPLE ? 1 : 2], 0);
+        }
+        else if (s.texture[e] != 0 && gTexMode != TEX_OFF) bindTex0(shader, s.texture[e], 0);
+        else shader.setBool("uUseTexture", false);
+
+        switch (s.mesh[e]) {
+        case MESH_CUBE:
+            glBindVertexArray(cubeVAO);
+            glDrawArrays(GL_TRIANGLES, 0, 36);
+            gStats.countDraw(12);
+            break;
+        case MESH_SPHERE:   sphere.draw();   gStats.countDraw(sphere.indexCount / 3); break;
+        case MESH_CYLINDER: cylinder.draw(); gStats.countDraw(cylinder.indexCount / 3); break;
+        case MESH_CONE:     gCone.draw();    gStats.countDraw(gCone.vertexCount / 3); break;
+        case MESH_TABLE_MODEL:
+            // one pooled mesh, a draw per material
+            gModelPool.bind();
+            for (const ModelPart& part : gTableModelParts) {
+                shader.setV4("baseColor", tint(part.color));
+                gModelPool.drawRange(gTableModelMesh.baseVertex, gTableModelMesh.firstIndex + part.firstIndex, part.indexCount);
+                gStats.countDraw(part.indexCount / 3);
+            }
+            glBindVertexArray(0);
+            break;
+        default: {
+            const PooledMesh& batch = gStaticBatches[s.mesh[e] - MESH_BATCH];
+            gStaticBatchPool.bind();
+            gStaticBatchPool.draw(batch);
+            glBindVertexArray(0);
+            gStats.countDraw(batch.indexCount / 3);
+            break;
+        }
+        }
+    }
+}
 
-    // ---------- SKY ----------
+// This frame's impostor quads, one instanced draw (uniforms set by drawRiversideScene)
+void drawImpostors(Shader& shader)
+{
+    if (gImpostors.instances.empty()) return;
+    gImpostorShader->use();
+    int quads = gImpostors.draw();
+    gStats.countDraw(2 * quads);
+    shader.use();
+}
+
+// ======================================================
+// Render Passes
+// Sky and water are opaque and behind everything, so in depth order they
+// close the opaque pass instead of opening the frame.
+// ======================================================
+// Camera matrix as last set on the scene shader
+glm::mat4 sceneMatrix(const Shader& shader, const char* name)
+{
+    glm::mat4 m;
+    glGetUniformfv(shader.ID, glGetUniformLocation(shader.ID, name), glm::value_ptr(m));
+    return m;
+}
+
+void drawSky(Shader& shader, unsigned int cubeVAO)
+{
     shader.setBool("isSky", true);
     shader.setBool("uUseTexture", false);    // IMPORTANT: don't texture sky
     shader.setInt("uComputeMode", 1);
@@ -439,152 +844,1027 @@ void drawRiversideScene(Shader& shader, Sphere& sphere, Cylinder& cylinder, unsi
     shader.setV4("skyBottom", glm::vec4(0.52f, 0.76f, 0.95f, 1.0f));
     drawCube(shader, cubeVAO, glm::vec3(0, 30, -85), glm::vec3(400, 300, 1), glm::vec4(1.0f), 0);
     shader.setBool("isSky", false);
+    gStats.countDraw(12);
+}
+
+void drawSkyAndWater(Shader& shader, unsigned int cubeVAO, float time)
+{
+    drawSky(shader, cubeVAO);
 
     // ---------- WATER ----------
-    shader.setBool("isWater", true);
-    shader.setBool("uUseTexture", false);    // IMPORTANT: don't texture water in this look
-    shader.setInt("uComputeMode", 1);
-    shader.setFloat("time", time);
-    shader.setV4("waterDeep", glm::vec4(0.03f, 0.14f, 0.34f, 1.0f));
-    shader.setV4("waterHorizon", glm::vec4(0.18f, 0.40f, 0.72f, 1.0f));
+    // CDLOD patches selected at the start of the frame
+    if (gWater.nodes.empty()) return;
+    Shader& water = *gWaterShader;
+    water.use();
+    water.setMat4("view", sceneMatrix(shader, "view"));
+    water.setMat4("projection", sceneMatrix(shader, "projection"));
+    water.setV3("uEye", gWater.eye);
+    water.setFloat("uHeight", gWater.height);
+    water.setFloat("uGridSize", (float)WaterGrid::kPatchQuads);
+    for (int l = 0; l < WaterGrid::kLevels; ++l)
+        water.setV2("uMorph[" + std::to_string(l) + "]", WaterGrid::morph(l));
+    water.setFloat("time", time);
+    water.setBool("isWater", true);
+    water.setInt("uComputeMode", 1);
+    water.setV4("baseColor", glm::vec4(0.03f, 0.14f, 0.34f, 1.0f));
+    water.setBool("uOverdrawPass", gHeatmapOn);
+    water.setBool("uOcean", gOcean.ready());
+    gWaves.apply(water);
+    bool reflection = gReflectionOn && !gHeatmapOn && gReflectionTarget.fbo;
+    water.setBool("uReflection", reflection);
+    if (reflection) {
+        GLint viewport[4];
+        glGetIntegerv(GL_VIEWPORT, viewport);
+        water.setInt("uReflectionMap", 4);
+        water.setV2("uViewportSize", glm::vec2((float)viewport[2], (float)viewport[3]));
+        glActiveTexture(GL_TEXTURE4);
+        glBindTexture(GL_TEXTURE_2D, gReflectionTarget.color);
+        glActiveTexture(GL_TEXTURE0);
+    }
+    if (gOcean.ready()) {
+        water.setInt("uOceanMap", 3);
+        water.setFloat("uOceanTile", Ocean::kTileSize);
+        water.setFloat("uOceanTexel", gOcean.texelSize());
+        glActiveTexture(GL_TEXTURE3);
+        glBindTexture(GL_TEXTURE_2D, gOcean.texture());
+        glActiveTexture(GL_TEXTURE0);
+    }
+    gStats.countDraw(gWater.draw());
+    shader.use();
+}
+
+void beginOpaquePass()
+{
+    if (gDepthOrderOn && !gHeatmapOn) glDisable(GL_BLEND);   // the heatmap adds up by blending
+}
 
-    model = glm::mat4(1.0f);
-    model = glm::translate(model, glm::vec3(0.0f, -2.5f, 0.0f));
-    model = glm::scale(model, glm::vec3(260.0f, 0.1f, 260.0f));
+void beginTransparentPass(Shader& shader)
+{
+    if (gOitThisFrame) {
+        gOit.begin();
+        shader.setBool("uOitPass", true);
+        return;
+    }
+    if (gLowResThisFrame) {
+        gLowRes.begin(*gDepthDownShader, gFullscreenVAO);
+        shader.use();
+        return;
+    }
+    glEnable(GL_BLEND);
+    if (gDepthOrderOn) glDepthMask(GL_FALSE);
+}
+
+void endTransparentPass(Shader& shader)
+{
+    if (gOitThisFrame) {
+        shader.setBool("uOitPass", false);
+        gOit.composite(*gOitShader, gFullscreenVAO);
+        shader.use();
+    }
+    if (gLowResThisFrame) {
+        // near / far back out of the perspective matrix
+        glm::mat4 p = sceneMatrix(shader, "projection");
+        gLowRes.composite(*gUpsampleShader, gFullscreenVAO, p[3][2] / (p[2][2] - 1.0f), p[3][2] / (p[2][2] + 1.0f));
+        shader.use();
+    }
+    glDepthMask(GL_TRUE);
+}
+
+// Depth for `list` from the position streams. Entities still crossfading
+// to an impostor keep their dithered pixels open: they go to `rest` and
+// are drawn normally afterwards.
+void drawDepthPrepass(Shader& shader, const std::vector<int>& list, std::vector<int>& covered, std::vector<int>& rest)
+{
+    const EntityStore& s = gEntities;
+    covered.clear();
+    rest.clear();
+    for (int e : list) (gImpostors.fadeOf(s.group[e]) > 0.0f ? rest : covered).push_back(e);
+
+    // Same matrices as the scene shader, so both compute identical positions
+    gDepthShader->use();
+    gDepthShader->setMat4("view", sceneMatrix(shader, "view"));
+    gDepthShader->setMat4("projection", sceneMatrix(shader, "projection"));
+    glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+
+    for (int e : covered) {
+        gDepthShader->setMat4("model", s.world[e]);
+        switch (s.mesh[e]) {
+        case MESH_CUBE:     gCubeDepth.draw();     gStats.countDraw(12); break;
+        case MESH_SPHERE:   gSphereDepth.draw();   gStats.countDraw(gSphereDepth.count / 3); break;
+        case MESH_CYLINDER: gCylinderDepth.draw(); gStats.countDraw(gCylinderDepth.count / 3); break;
+        case MESH_CONE:     gConeDepth.draw();     gStats.countDraw(gConeDepth.count / 3); break;
+        case MESH_TABLE_MODEL:
+            gModelPool.bindDepth();
+            for (const ModelPart& part : gTableModelParts) {
+                gModelPool.drawRange(gTableModelMesh.baseVertex, gTableModelMesh.firstIndex + part.firstIndex, part.indexCount);
+                gStats.countDraw(part.indexCount / 3);
+            }
+            glBindVertexArray(0);
+            break;
+        default: {
+            const PooledMesh& batch = gStaticBatches[s.mesh[e] - MESH_BATCH];
+            gStaticBatchPool.bindDepth();
+            gStaticBatchPool.draw(batch);
+            glBindVertexArray(0);
+            gStats.countDraw(batch.indexCount / 3);
+            break;
+        }
+        }
+    }
+
+    glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+    shader.use();
+}
+
+// The opaque draw list, behind a depth pre-pass when it is on
+void drawOpaqueEntities(Shader& shader, Sphere& sphere, Cylinder& cylinder, unsigned int cubeVAO)
+{
+    if (!gDepthPrepassOn) {
+        drawEntities(shader, gDrawList.opaque, sphere, cylinder, cubeVAO);
+        return;
+    }
+
+    std::vector<int> covered, rest;
+    drawDepthPrepass(shader, gDrawList.opaque, covered, rest);
+    glDepthFunc(GL_EQUAL);
+    glDepthMask(GL_FALSE);
+    drawEntities(shader, covered, sphere, cylinder, cubeVAO);
+    glDepthMask(GL_TRUE);
+    glDepthFunc(GL_LESS);
+    drawEntities(shader, rest, sphere, cylinder, cubeVAO);
+}
+
+// ======================================================
+// Table Sets Under GPU Occlusion Queries (G)
+// Everything else is drawn first so the floors are already in the depth
+// buffer, then the sets one by one; see GpuOcclusion.h for the per-set
+// modes. Boxes are drawn with color and depth writes off.
+// ======================================================
+void updateTableSetBounds()
+{
+    int sets = 0;
+    for (int g : gEntities.group) sets = std::max(sets, g + 1);
+    if (gSetQueries.size() != sets) gSetQueries.resize(sets);
+
+    std::vector<bool> seen(sets, false);
+    for (int e = 0; e < gEntities.size(); ++e) {
+        int g = gEntities.group[e];
+        if (g < 0 || (gEntities.flags[e] & ENT_HIDDEN)) continue;
+        if (!seen[g]) gSetQueries.bounds[g] = gEntities.bounds[e];
+        else gSetQueries.bounds[g].expand(gEntities.bounds[e]);
+        seen[g] = true;
+    }
+    gSetBoundsDirty = false;
+}
+
+void drawSetBox(Shader& shader, unsigned int cubeVAO, const Aabb& b)
+{
+    glm::mat4 model = glm::translate(glm::mat4(1.0f), b.center());
+    model = glm::scale(model, b.max - b.min);
     shader.setMat4("model", model);
-    shader.setV4("baseColor", glm::vec4(0.03f, 0.14f, 0.34f, 1.0f));
     glBindVertexArray(cubeVAO);
     glDrawArrays(GL_TRIANGLES, 0, 36);
-    shader.setBool("isWater", false);
-
-    // ---------- FLOOR / WOOD ----------
-    glm::vec4 floorTop = glm::vec4(0.82f, 0.68f, 0.45f, 1.0f);
-    glm::vec4 floorSide = glm::vec4(0.60f, 0.48f, 0.30f, 1.0f);
-    glm::vec4 deckWood = glm::vec4(0.68f, 0.45f, 0.22f, 1.0f);
+    gStats.countDraw(12);
+}
 
-    float floorH = 0.4f;
-    float floorY = 0.3f;
+void setBoxPass(bool on)
+{
+    GLboolean write = on ? GL_FALSE : GL_TRUE;
+    glColorMask(write, write, write, write);
+    glDepthMask(write);
+}
 
-    // Entrance wooden walkway (textured)
-    drawCube(shader, cubeVAO, glm::vec3(0, floorY, 12.5f), glm::vec3(3.0f, floorH, 19.0f), deckWood, woodTexture);
-    drawCube(shader, cubeVAO, glm::vec3(0, floorY - 0.3f, 12.5f), glm::vec3(3.1f, 0.2f, 19.0f), deckWood * 0.6f, woodTexture);
+void drawWithSetQueries(Shader& shader, Sphere& sphere, Cylinder& cylinder, unsigned int cubeVAO, const glm::vec3& eye, float time)
+{
+    if (gSetBoundsDirty) updateTableSetBounds();
+    OcclusionQueries& q = gSetQueries;
+    q.poll(gStats.gpuSkippedSets, gStats.gpuSkippedTriangles);
+
+    const std::vector<int>& group = gEntities.group;
+    std::vector<int>& opaque = gDrawList.opaque;
+    auto setsBegin = std::stable_partition(opaque.begin(), opaque.end(), [&](int e) { return group[e] < 0; });
+    std::stable_sort(setsBegin, opaque.end(), [&](int a, int b) { return group[a] < group[b]; });
+    std::vector<int> setParts(setsBegin, opaque.end());
+    opaque.erase(setsBegin, opaque.end());
+
+    drawEntities(shader, opaque, sphere, cylinder, cubeVAO);
+
+    std::vector<int> run, drawnThenTest;
+    for (size_t i = 0; i < setParts.size();) {
+        int g = group[setParts[i]];
+        run.clear();
+        while (i < setParts.size() && group[setParts[i]] == g) run.push_back(setParts[i++]);
+
+        const Aabb& b = q.bounds[g];
+        bool inside = b.contains(eye, 0.3f);    // pad > near plane
+        if (inside) q.forceVisible(g);
+
+        switch (inside ? OcclusionQueries::DRAW : q.mode(g)) {
+        case OcclusionQueries::DRAW:
+            drawEntities(shader, run, sphere, cylinder, cubeVAO);
+            break;
+        case OcclusionQueries::DRAW_THEN_TEST:
+            drawEntities(shader, run, sphere, cylinder, cubeVAO);
+            drawnThenTest.push_back(g);
+            break;
+        case OcclusionQueries::TEST_THEN_CONDITIONAL: {
+            setBoxPass(true);
+            q.beginTest(g, true);
+            drawSetBox(shader, cubeVAO, b);
+            q.endTest(g);
+            setBoxPass(false);
+
+            int64_t before = gStats.triangles;
+            q.beginConditional(g);
+            drawEntities(shader, run, sphere, cylinder, cubeVAO);
+            q.endConditional();
+            q.addConditionalTriangles(g, gStats.triangles - before);
+            break;
+        }
+        }
+    }
 
-    // Main dining floor (textured)
-    drawCube(shader, cubeVAO, glm::vec3(0, floorY, -5.0f), glm::vec3(39.0f, floorH, 16.0f), floorTop, woodTexture);
-    drawCube(shader, cubeVAO, glm::vec3(0, floorY - 0.3f, -5.0f), glm::vec3(39.1f, 0.2f, 16.0f), floorSide, woodTexture);
+    if (gDepthOrderOn) drawSkyAndWater(shader, cubeVAO, time);
 
-    // Back floor
-    drawCube(shader, cubeVAO, glm::vec3(0, floorY, -20.0f), glm::vec3(18.0f, floorH, 14.0f), floorTop, woodTexture);
+    // Re-test what was drawn, against the finished opaque depth
+    if (!drawnThenTest.empty()) {
+        setBoxPass(true);
+        for (int g : drawnThenTest) {
+            q.beginTest(g, false);
+            drawSetBox(shader, cubeVAO, q.bounds[g]);
+            q.endTest(g);
+        }
+        setBoxPass(false);
+    }
 
-    // ---------- Canopy frames ----------
-    glm::vec3 frameCenters[] = {
-        glm::vec3(-10.5f, floorY, -5.0f),
-        glm::vec3(0.0f, floorY, -20.0f),
-        glm::vec3(10.5f, floorY, -5.0f)
-    };
+    drawImpostors(shader);
+
+    // Glass parts follow their set's decision, keeping the list order
+    beginTransparentPass(shader);
+    const std::vector<int>& glass = gDrawList.transparent;
+    for (size_t i = 0; i < glass.size();) {
+        int g = group[glass[i]];
+        run.clear();
+        while (i < glass.size() && group[glass[i]] == g) run.push_back(glass[i++]);
+
+        bool wrap = g >= 0 && q.conditionalThisFrame(g);
+        int64_t before = gStats.triangles;
+        if (wrap) q.beginConditional(g);
+        drawEntities(shader, run, sphere, cylinder, cubeVAO);
+        if (wrap) {
+            q.endConditional();
+            q.addConditionalTriangles(g, gStats.triangles - before);
+        }
+    }
+    endTransparentPass(shader);
+}
 
-    glm::vec4 frameColor = glm::vec4(0.18f, 0.19f, 0.22f, 1.0f);
-    glm::vec4 glassColor = glm::vec4(0.72f, 0.86f, 1.0f, 0.18f);
+// ======================================================
+// HLOD Proxies (L)
+// Built once per load, before the BVH: proxy meshes go into the static
+// batch pool as extra entities, switched in and out by Hlod::select().
+// ======================================================
 
-    for (int p = 0; p < 3; ++p) {
-        glm::vec3 offset = frameCenters[p];
-        float fW = (p == 1) ? 6.5f : 9.0f;
-        float fD = (p == 1) ? 5.5f : 6.8f;
+// Mean colour of a mipmapped texture: its 1x1 level
+glm::vec4 textureAverageColor(unsigned int tex)
+{
+    glBindTexture(GL_TEXTURE_2D, tex);
+    int w = 1, h = 1, level = 0;
+    glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_WIDTH, &w);
+    glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_HEIGHT, &h);
+    while (w > 1 || h > 1) {
+        w = std::max(1, w / 2);
+        h = std::max(1, h / 2);
+        ++level;
+    }
+    float texel[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+    glGetTexImage(GL_TEXTURE_2D, level, GL_RGBA, GL_FLOAT, texel);
+    return glm::make_vec4(texel);
+}
 
-        glm::vec3 corners[] = {
-            offset + glm::vec3(-fW, 2.5f, -fD), offset + glm::vec3(fW, 2.5f, -fD),
-            offset + glm::vec3(-fW, 2.5f, fD),  offset + glm::vec3(fW, 2.5f, fD)
+// One texel per material and texture mode, alpha forced to 1 (proxies are opaque)
+void buildHlodAtlas()
+{
+    int n = std::max(1, (int)gHlod.materials.size());
+    std::vector<unsigned char> texels[3];
+    for (std::vector<unsigned char>& t : texels) t.assign((size_t)n * 4, 255);
+
+    for (size_t i = 0; i < gHlod.materials.size(); ++i) {
+        const Hlod::Material& m = gHlod.materials[i];
+        glm::vec4 avg = m.texture ? textureAverageColor(m.texture) : glm::vec4(1.0f);
+        glm::vec3 looks[3] = {
+            glm::vec3(m.color),
+            m.texture ? glm::vec3(avg) : glm::vec3(m.color),
+            glm::vec3(avg) * glm::vec3(m.color)
         };
+        for (int k = 0; k < 3; ++k)
+            for (int c = 0; c < 3; ++c)
+                texels[k][i * 4 + c] = (unsigned char)(glm::clamp(looks[k][c], 0.0f, 1.0f) * 255.0f + 0.5f);
+    }
 
-        for (int i = 0; i < 4; ++i)
-            drawCube(shader, cubeVAO, corners[i], glm::vec3(0.2f, 5.0f, 0.2f), frameColor, 0);
+    glDeleteTextures(3, gHlodAtlas);
+    glGenTextures(3, gHlodAtlas);
+    for (int k = 0; k < 3; ++k) {
+        glBindTexture(GL_TEXTURE_2D, gHlodAtlas[k]);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, n, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, texels[k].data());
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    }
+}
 
-        float bT = 0.15f;
-        drawCube(shader, cubeVAO, offset + glm::vec3(0, 4.9f, -fD), glm::vec3(fW * 2.1f, bT, bT), frameColor, 0);
-        drawCube(shader, cubeVAO, offset + glm::vec3(0, 4.9f,  fD), glm::vec3(fW * 2.1f, bT, bT), frameColor, 0);
-        drawCube(shader, cubeVAO, offset + glm::vec3(-fW, 4.9f, 0), glm::vec3(bT, bT, fD * 2.1f), frameColor, 0);
-        drawCube(shader, cubeVAO, offset + glm::vec3( fW, 4.9f, 0), glm::vec3(bT, bT, fD * 2.1f), frameColor, 0);
+void buildHlod()
+{
+    gHlodBuilt = true;
+    gHlod.build(gEntities, MESH_TABLE_MODEL, [](const Aabb& b) { return gCells.cellOf(b); });
+    if (gHlod.empty()) return;
+    if (!gStaticBatchPool.vao) gStaticBatchPool.init();
+
+    int proxies = 0;
+    for (std::vector<Hlod::Cluster>* list : { &gHlod.sets, &gHlod.pavilions })
+        for (Hlod::Cluster& c : *list) {
+            if (c.mesh.indices.empty()) continue;
+            Aabb bounds;
+            c.mesh.computeBounds(bounds.min, bounds.max);
+            c.proxy = gEntities.create(glm::mat4(1.0f), bounds, MESH_BATCH + (int)gStaticBatches.size(),
+                glm::vec4(1.0f), 0, ENT_STATIC | ENT_BAKED | ENT_REPLACED);
+            gStaticBatches.push_back(gStaticBatchPool.add(c.mesh));
+            c.mesh = MeshData();
+            ++proxies;
+        }
+    buildHlodAtlas();
+    std::cout << "HLOD: " << proxies << " proxies for " << gHlod.sets.size() << " table sets, "
+              << gHlod.materials.size() << " atlas materials\n";
+}
 
-        // Bulbs (no texture)
-        for (int i = 0; i < 4; ++i) {
-            float x = -fW + (i * (fW * 2.0f) / 3.0f);
+// ======================================================
+// Impostor Bake (I)
+// Every group is drawn from each atlas direction into one tile of an
+// offscreen target with an orthographic camera, in the frame node's space,
+// then copied into its atlas layer. Fog is skipped; the quads add their own.
+// ======================================================
+void bakeImpostors(Shader& shader, Sphere& sphere, Cylinder& cylinder, unsigned int cubeVAO)
+{
+    gImpostorsDirty = false;
+    gImpostors.clear();
+    if (gTableModelReady) {
+        std::cout << "Impostors: not baked, table sets are drawn with the imported model\n";
+        return;
+    }
+    auto start = std::chrono::high_resolution_clock::now();
+    gImpostors.build(gEntities, gScene, MESH_TABLE_MODEL);
+    if (gImpostors.empty()) return;
+
+    const int atlasSize = Impostors::kAtlasSize, frameSize = Impostors::kFrameSize;
+    Framebuffer target;
+    if (!target.create(atlasSize, atlasSize)) return;
+    gImpostors.allocateAtlas();
+
+    int picked = gPickedGroup;
+    gPickedGroup = -1;
+    shader.use();
+    shader.setBool("uBakePass", true);
+    glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+    glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+    target.bind();
+    glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+
+    for (int g = 0; g < (int)gImpostors.groups.size(); ++g) {
+        const Impostors::SetInfo& set = gImpostors.sets[gImpostors.groups[g].set];
+        std::vector<int> opaque, glass;
+        for (int e : set.parts) {
+            if (gEntities.flags[e] & ENT_HIDDEN) continue;
+            ((gEntities.flags[e] & ENT_TRANSPARENT) ? glass : opaque).push_back(e);
+        }
+        glm::mat4 toFrame = glm::inverse(set.frame);
 
-            shader.setBool("uUseTexture", false);
-            shader.setInt("uComputeMode", 1);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        for (int fy = 0; fy < Impostors::kFrames; ++fy)
+            for (int fx = 0; fx < Impostors::kFrames; ++fx) {
+                glm::mat4 view, projection;
+                gImpostors.frameView(g, fx, fy, view, projection);
+                glViewport(fx * frameSize, fy * frameSize, frameSize, frameSize);
+                shader.setMat4("view", view * toFrame);
+                shader.setMat4("projection", projection);
+                drawEntities(shader, opaque, sphere, cylinder, cubeVAO);
+                drawEntities(shader, glass, sphere, cylinder, cubeVAO);
+            }
+
+        glBindTexture(GL_TEXTURE_2D_ARRAY, gImpostors.atlas);
+        glCopyTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, g, 0, 0, atlasSize, atlasSize);
+    }
+    glBindTexture(GL_TEXTURE_2D_ARRAY, gImpostors.atlas);
+    glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+    glFinish();
 
-            glm::mat4 modelBulb = glm::mat4(1.0f);
-            modelBulb = glm::translate(modelBulb, offset + glm::vec3(x, 4.82f, -fD + 0.1f));
-            modelBulb = glm::scale(modelBulb, glm::vec3(0.25f));
-            shader.setMat4("model", modelBulb);
-            shader.setV4("baseColor", glm::vec4(1.0f, 0.88f, 0.55f, 1.0f));
-            sphere.draw();
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glPolygonMode(GL_FRONT_AND_BACK, isWireframe ? GL_LINE : GL_FILL);
+    shader.setBool("uBakePass", false);
+    gPickedGroup = picked;
+    target.release();
+
+    gImpostors.baked = true;
+    gImpostors.bakeMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+    std::cout << "Impostors: baked " << gImpostors.groups.size() << " groups for " << gImpostors.sets.size()
+              << " table sets in " << gImpostors.bakeMs << " ms\n";
+}
 
-            modelBulb = glm::mat4(1.0f);
-            modelBulb = glm::translate(modelBulb, offset + glm::vec3(x, 4.82f, fD - 0.1f));
-            modelBulb = glm::scale(modelBulb, glm::vec3(0.25f));
-            shader.setMat4("model", modelBulb);
-            shader.setV4("baseColor", glm::vec4(0.98f, 0.95f, 0.55f, 1.0f));
-            sphere.draw();
-        }
+// ======================================================
+// Bulb Lights And Lightmap Bake (4, K)
+// The same lights feed the per-frame clusters and the bake: every visible
+// `light` entity at its centre, in its material colour.
+// ======================================================
+void collectBulbLights(std::vector<PointLight>& out)
+{
+    out.clear();
+    for (int e : gLightEntities) {
+        if (gEntities.flags[e] & ENT_HIDDEN) continue;
+        out.push_back({ glm::vec3(gEntities.world[e][3]), kBulbRadius, glm::vec3(gEntities.color[e]), kBulbIntensity });
+    }
+}
 
-        // Furniture (textured wood)
-        if (p == 1) {
-            drawStylizedTableSet(shader, sphere, cylinder, cubeVAO, offset + glm::vec3(-3.2f, 0, 0), offset.z);
-            drawStylizedTableSet(shader, sphere, cylinder, cubeVAO, offset + glm::vec3( 3.2f, 0, 0), offset.z);
-        }
-        else {
-            drawStylizedTableSet(shader, sphere, cylinder, cubeVAO, offset + glm::vec3(-3.8f, 0, -3.2f), offset.z);
-            drawStylizedTableSet(shader, sphere, cylinder, cubeVAO, offset + glm::vec3( 3.8f, 0, -3.2f), offset.z);
-            drawStylizedTableSet(shader, sphere, cylinder, cubeVAO, offset + glm::vec3(-3.8f, 0,  3.2f), offset.z);
-            drawStylizedTableSet(shader, sphere, cylinder, cubeVAO, offset + glm::vec3( 3.8f, 0,  3.2f), offset.z);
-        }
+// Needs the BVH of the current entities
+void bakeLightmap()
+{
+    gLightmapDirty = false;
+    std::vector<PointLight> bulbs;
+    collectBulbLights(bulbs);
+    if (!gLightmap.bake(gEntities, gBvh, bulbs, MESH_CUBE, MESH_BATCH)) {
+        std::cout << "Lightmap: nothing to bake\n";
+        return;
+    }
+    std::cout << "Lightmap: " << gLightmap.charts << " boxes, " << gLightmap.texels << " texels at " << gLightmap.density
+              << " per metre, " << Lightmap::kSamples << " paths each, baked in " << gLightmap.bakeMs << " ms on "
+              << JobSystem::instance().workerCount() + 1 << " threads, " << gLightmap.gpuBytes / 1024 << " KB "
+              << (gLightmap.compressed ? "DXT1" : "RGB8 (no S3TC)") << "\n";
+}
+
+// ======================================================
+// Planar Reflection (Q)
+// The camera mirrored about the water plane renders opaque entities and
+// the sky into a half-resolution target. An oblique near plane (Lengyel)
+// clips everything under the water without a user clip plane; the cull
+// uses the mirrored frustum with the water as its near plane, HLOD picks
+// proxies as if the objects were kReflectionLodBias their size, and
+// anything under kReflectionMinPixels is skipped. Glass and impostors are
+// not reflected. Its draws are counted apart from the frame's.
+// ======================================================
+// Replaces the near plane of projection p with view-space plane c
+glm::mat4 obliqueProjection(glm::mat4 p, const glm::vec4& c)
+{
+    glm::vec4 q((glm::sign(c.x) + p[2][0]) / p[0][0], (glm::sign(c.y) + p[2][1]) / p[1][1], -1.0f, (1.0f + p[2][2]) / p[3][2]);
+    glm::vec4 m = c * (2.0f / glm::dot(c, q));
+    for (int i = 0; i < 4; ++i) p[i][2] = m[i] - p[i][3];
+    return p;
+}
+
+void drawReflection(Shader& shader, Sphere& sphere, Cylinder& cylinder, unsigned int cubeVAO,
+                    const glm::vec3& eye, float pixelScale)
+{
+    auto start = std::chrono::high_resolution_clock::now();
+    GLint viewport[4], target = 0;
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &target);
+    int width = std::max(1, viewport[2] / 2), height = std::max(1, viewport[3] / 2);
+    if ((gReflectionTarget.width != width || gReflectionTarget.height != height) && !gReflectionTarget.create(width, height)) {
+        gReflectionOn = false;
+        return;
+    }
+
+    glm::mat4 view = sceneMatrix(shader, "view");
+    glm::mat4 projection = sceneMatrix(shader, "projection");
+    glm::mat4 mirror = glm::scale(glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 2.0f * kWaterHeight, 0.0f)), glm::vec3(1.0f, -1.0f, 1.0f));
+    glm::mat4 mirrorView = view * mirror;
+    glm::vec3 mirrorEye(eye.x, 2.0f * kWaterHeight - eye.y, eye.z);
+    glm::vec4 plane(0.0f, 1.0f, 0.0f, -kWaterHeight);     // world; above the water is positive
+    glm::mat4 mirrorProjection = obliqueProjection(projection, glm::transpose(glm::inverse(mirrorView)) * plane);
+
+    Frustum frustum = Frustum::fromMatrix(projection * mirrorView);
+    frustum.planes[4] = plane;
+    float scale = pixelScale * 0.5f;
+    std::vector<char> selection = gHlod.saveSelection();
+    gHlod.select(gEntities, mirrorEye, scale * kReflectionLodBias, gHlodOn);
+    gReflectionList.clear();
+    const EntityStore& s = gEntities;
+    gBvh.queryFrustum(frustum, [&](int e) {
+        if (s.flags[e] & (ENT_SKIP | ENT_TRANSPARENT)) return;
+        float radius = glm::length(s.bounds[e].extent());
+        float dist = glm::length(s.bounds[e].center() - mirrorEye);
+        if (dist > radius && radius * scale / dist < kReflectionMinPixels) return;
+        gReflectionList.push_back(e);
+    });
+    std::sort(gReflectionList.begin(), gReflectionList.end());
+    gHlod.restoreSelection(selection);
+
+    int draws = gStats.drawCalls;
+    int64_t triangles = gStats.triangles;
+    gReflectionTimer.begin();
+    gReflectionTarget.bind();
+    glClearColor(0.55f, 0.75f, 0.95f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    GLboolean blend = glIsEnabled(GL_BLEND);
+    glDisable(GL_BLEND);
+    shader.setMat4("view", mirrorView);
+    shader.setMat4("projection", mirrorProjection);
+    drawEntities(shader, gReflectionList, sphere, cylinder, cubeVAO);
+    drawSky(shader, cubeVAO);
+    shader.setMat4("view", view);
+    shader.setMat4("projection", projection);
+    if (blend) glEnable(GL_BLEND);
+    glBindFramebuffer(GL_FRAMEBUFFER, (unsigned int)target);
+    glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+    gReflectionTimer.end();
+
+    gStats.reflectionDrawCalls = gStats.drawCalls - draws;
+    gStats.reflectionTriangles = gStats.triangles - triangles;
+    gStats.drawCalls = draws;
+    gStats.triangles = triangles;
+    gStats.gpuReflectionMs = gReflectionTimer.lastMs();
+    gStats.cpuReflectionMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+}
+
+// ======================================================
+// Full Scene
+// ======================================================
+void drawRiversideScene(Shader& shader, Sphere& sphere, Cylinder& cylinder, unsigned int cubeVAO, float time,
+                        const glm::mat4& viewProj, const glm::vec3& eye)
+{
+    shader.setBool("isDeck", false);
+    shader.setBool("isSky", false);
+    shader.setBool("isWater", false);
+    shader.setFloat("uDitherFade", 0.0f);
+
+    Frustum frustum = Frustum::fromMatrix(viewProj);
+    gStats.waterNodes = gWater.select(eye, frustum, kWaterHeight);
+    if (gOceanOn != gOcean.ready()) {
+        if (gOceanOn) gOcean.create(gOceanResolution);
+        else gOcean.release();
+    }
+    if (gOceanOn) {
+        gOcean.update(time);
+        gStats.cpuOceanMs = gOcean.simulateMs;
     }
 
-    // ---------- Glass Walls (use canopyTexture) ----------
-    for (int p = 0; p < 3; ++p) {
-        glm::vec3 offset = frameCenters[p];
-        float fW = (p == 1) ? 6.5f : 9.0f;
-        float fD = (p == 1) ? 5.5f : 6.8f;
+    // ---------- ENTITIES ----------
+    // transform update -> culling -> draw list -> submit (opaque front to back, then glass back to front)
+    auto t0 = std::chrono::high_resolution_clock::now();
+    if (ecs::updateTransforms(gEntities, gScene, gScene.update()) > 0) gBvhRefit = true;
+    if (gBvhRebuild) {
+        if (!gHlodBuilt) buildHlod();
+        for (unsigned int& f : gEntities.flags) f &= ~ENT_VISIBLE;
+        gVisibleEntities.clear();
+        gBvh.build(gEntities.bounds.data(), gEntities.size());
+        for (int e = 0; e < gEntities.size(); ++e) gEntities.cell[e] = gCells.cellOf(gEntities.bounds[e]);
+        gBvhRebuild = gBvhRefit = false;
+        gSetBoundsDirty = true;
+    }
+    else if (gBvhRefit) {
+        gBvh.refit(gEntities.bounds.data());
+        gBvhRefit = false;
+        gSetBoundsDirty = true;
+    }
+    if (gLightmapOn && gLightmapDirty) bakeLightmap();
+
+    // projection[1][1] is the length of the second row of viewProj (view rows are unit length)
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    float pixelScale = (float)viewport[3] * glm::length(glm::vec3(viewProj[0][1], viewProj[1][1], viewProj[2][1]));
+
+    // Reflection first (the water samples it), outside the overdraw count
+    if (gReflectionOn && !gHeatmapOn) drawReflection(shader, sphere, cylinder, cubeVAO, eye, pixelScale);
+
+    // Occlusion queries share one target with the per-set queries (G)
+    bool countOverdraw = !gGpuOcclusionOn;
+    if (countOverdraw) gOverdraw.begin();
+    if (!gDepthOrderOn) drawSkyAndWater(shader, cubeVAO, time);
+
+    bool impostors = gImpostorsOn && gImpostors.baked;
+    gStats.hlodProxies = gHlod.select(gEntities, eye, pixelScale, gHlodOn && !impostors);
+
+    auto tImp = std::chrono::high_resolution_clock::now();
+    gStats.impostors = gImpostors.select(gEntities, eye, pixelScale, frustum, impostors);
+    gStats.cpuImpostorMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - tImp).count();
+    if (gStats.impostors > 0) {
+        gImpostorShader->use();
+        gImpostorShader->setMat4("projection", viewProj);
+        gImpostorShader->setMat4("view", glm::mat4(1.0f));
+        gImpostorShader->setFloat("uFrameScale", 1.0f / Impostors::kFrames);
+        gImpostorShader->setInt("uAtlas", 0);
+        gImpostorShader->setBool("uOverdrawPass", gHeatmapOn);
+        shader.use();
+    }
 
-        if (p == 1) {
-            drawCube(shader, cubeVAO, offset + glm::vec3(0.0f, 2.5f, -fD), glm::vec3(fW * 2.0f, 4.8f, 0.04f), glassColor, canopyTexture);
-            drawCube(shader, cubeVAO, offset + glm::vec3(-fW, 2.5f, 0.0f), glm::vec3(0.04f, 4.8f, fD * 2.0f), glassColor, canopyTexture);
-            drawCube(shader, cubeVAO, offset + glm::vec3( fW, 2.5f, 0.0f), glm::vec3(0.04f, 4.8f, fD * 2.0f), glassColor, canopyTexture);
+    int visible;
+    gPortalView.cameraCell = -1;
+    if (gUseBvh && gPortalsOn && !gCells.empty()) gCells.computeView(viewProj, eye, gPortalView);
+
+    if (gUseBvh && gPortalView.cameraCell >= 0) {
+        // full view for entities in no cell, a narrowed one per reachable cell
+        std::vector<Frustum> frusta{ frustum };
+        std::vector<int> frustumCell{ -1 };
+        for (int c = 0; c < (int)gCells.cells.size(); ++c) {
+            if (!gPortalView.sees(c)) continue;
+            frusta.push_back(Frustum::fromMatrixRect(viewProj, gPortalView.rect[c]));
+            frustumCell.push_back(c);
         }
-        else {
-            float xEdge = (p == 0) ? -fW : fW;
-            drawCube(shader, cubeVAO, offset + glm::vec3(xEdge, 2.5f, 0.0f), glm::vec3(0.04f, 4.8f, fD * 2.0f), glassColor, canopyTexture);
-            drawCube(shader, cubeVAO, offset + glm::vec3(0.0f, 2.5f, -fD), glm::vec3(fW * 2.0f, 4.8f, 0.04f), glassColor, canopyTexture);
-            drawCube(shader, cubeVAO, offset + glm::vec3(0.0f, 2.5f,  fD), glm::vec3(fW * 2.0f, 4.8f, 0.04f), glassColor, canopyTexture);
+        visible = ecs::cull(gEntities, gBvh, frusta.data(), frustumCell.data(), (int)frusta.size(), gVisibleEntities);
+        ecs::buildDrawList(gEntities, gVisibleEntities, gDrawList);
+    }
+    else if (gUseBvh) {
+        visible = ecs::cull(gEntities, gBvh, frustum, gVisibleEntities);
+        ecs::buildDrawList(gEntities, gVisibleEntities, gDrawList);
+    }
+    else {
+        gVisibleEntities.clear();   // flags are rewritten for every entity
+        visible = ecs::cull(gEntities, frustum);
+        ecs::buildDrawList(gEntities, gDrawList);
+    }
+
+    int occluded = 0;
+    auto tOcc = std::chrono::high_resolution_clock::now();
+    if (gOcclusionOn) {
+        gOcclusion.begin(viewProj);
+        for (int e : gDrawList.opaque)
+            if ((gEntities.flags[e] & ENT_OCCLUDER) && gEntities.mesh[e] == MESH_CUBE)
+                gOcclusion.addOccluderBox(gEntities.world[e]);
+        gOcclusion.rasterize();
+        occluded = ecs::occlusionCull(gEntities, gOcclusion, gDrawList);
+    }
+    gOitThisFrame = gOitOn && !gHeatmapOn && !gDrawList.transparent.empty()
+        && ((gOit.width == viewport[2] && gOit.height == viewport[3]) || gOit.create(viewport[2], viewport[3]));
+    gLowResThisFrame = gTransparentScale > 1 && !gOitThisFrame && !gHeatmapOn && !gDrawList.transparent.empty()
+        && (gLowRes.matches(viewport[2], viewport[3], gTransparentScale) || gLowRes.create(viewport[2], viewport[3], gTransparentScale));
+    if (gDepthOrderOn) ecs::sortDrawListByDepth(gEntities, gDrawList, eye, !gOitThisFrame);
+
+    bool lit = emissiveOn && !gHeatmapOn && !gLightEntities.empty();
+    if (lit) {
+        collectBulbLights(gLights.lights);
+        gLights.build(sceneMatrix(shader, "view"), sceneMatrix(shader, "projection"));
+        gStats.lights = (int)gLights.lights.size();
+        gStats.lightsPerCluster = (double)gLights.lightRefs / ClusteredLights::kClusters;
+        gStats.cpuClusterMs = gLights.buildMs;
+    }
+    auto t1 = std::chrono::high_resolution_clock::now();
+
+    if (lit) {
+        gLights.bind(shader, kClusterUnit);
+        shader.setV3("uEye", eye);
+    }
+    shader.setBool("uClustered", lit);
+    gLightmapThisFrame = gLightmapOn && gLightmap.baked && !gHeatmapOn;
+    if (gLightmapThisFrame) gLightmap.bind(shader, kLightmapUnit, emissiveOn);
+    shader.setBool("uLightmap", gLightmapThisFrame);
+    beginOpaquePass();
+    if (gGpuOcclusionOn) drawWithSetQueries(shader, sphere, cylinder, cubeVAO, eye, time);
+    else {
+        drawOpaqueEntities(shader, sphere, cylinder, cubeVAO);
+        if (gDepthOrderOn) drawSkyAndWater(shader, cubeVAO, time);
+        drawImpostors(shader);
+        beginTransparentPass(shader);
+        drawEntities(shader, gDrawList.transparent, sphere, cylinder, cubeVAO);
+        endTransparentPass(shader);
+    }
+    if (countOverdraw) gOverdraw.end();
+    shader.setBool("uClustered", false);
+    shader.setBool("uLightmap", false);
+    gLightmapThisFrame = false;
+    auto t2 = std::chrono::high_resolution_clock::now();
+
+    gStats.entities = gEntities.size();
+    gStats.visible = visible;
+    gStats.culled = gEntities.size() - visible;
+    gStats.occluded = occluded;
+    gStats.portalCells = gPortalView.cameraCell >= 0 ? gPortalView.reachable : 0;
+    gStats.overdraw = countOverdraw ? gOverdraw.lastPerPixel(viewport[2] * viewport[3]) : 0.0;
+    gStats.cpuOcclusionMs = std::chrono::duration<double, std::milli>(t1 - tOcc).count();
+    gStats.cpuUpdateMs = std::chrono::duration<double, std::milli>(t1 - t0).count() - gStats.cpuReflectionMs;
+    gStats.cpuSubmitMs = std::chrono::duration<double, std::milli>(t2 - t1).count();
+}
+
+// ======================================================
+// Overdraw Heatmap (H)
+// Same frame, same passes, but every fragment writes 1 with additive
+// blending into an R32F target. The counts are read back for the average
+// and maximum (a stall, fine for a debug view), then ramped to the window:
+// black = not drawn, blue = once ... white = kHeatmapMaxCount or more.
+// ======================================================
+const float kHeatmapMaxCount = 8.0f;
+
+void drawOverdrawHeatmap(Shader& shader, Sphere& sphere, Cylinder& cylinder, unsigned int cubeVAO, float time,
+                         const glm::mat4& viewProj, const glm::vec3& eye)
+{
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+    int width = viewport[2], height = viewport[3];
+    if (gHeatmapTarget.width != width || gHeatmapTarget.height != height) {
+        if (!gHeatmapTarget.create(width, height, GL_R32F, GL_RED, GL_FLOAT)) {
+            gHeatmapOn = false;
+            drawRiversideScene(shader, sphere, cylinder, cubeVAO, time, viewProj, eye);
+            return;
         }
     }
 
-    // Railings
-    glm::vec4 railGlass = glm::vec4(0.70f, 0.85f, 1.0f, 0.45f);
-    drawCube(shader, cubeVAO, glm::vec3(-1.55f, 1.2f, 12.5f), glm::vec3(0.02f, 1.0f, 19.0f), railGlass, canopyTexture);
-    drawCube(shader, cubeVAO, glm::vec3( 1.55f, 1.2f, 12.5f), glm::vec3(0.02f, 1.0f, 19.0f), railGlass, canopyTexture);
+    gHeatmapTarget.bind();
+    glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_ONE, GL_ONE);
+    shader.setBool("uOverdrawPass", true);
+    drawRiversideScene(shader, sphere, cylinder, cubeVAO, time, viewProj, eye);
+    shader.setBool("uOverdrawPass", false);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    gHeatmapCounts.resize((size_t)width * height);
+    glReadPixels(0, 0, width, height, GL_RED, GL_FLOAT, gHeatmapCounts.data());
+    double sum = 0.0;
+    float peak = 0.0f;
+    for (float n : gHeatmapCounts) {
+        sum += n;
+        peak = std::max(peak, n);
+    }
+    gStats.heatmapAvg = sum / (double)gHeatmapCounts.size();
+    gStats.heatmapMax = peak;
+
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glViewport(0, 0, width, height);
+    glDisable(GL_DEPTH_TEST);
+    glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+    gHeatmapShader->use();
+    gHeatmapShader->setInt("uCounts", 0);
+    gHeatmapShader->setFloat("uMaxCount", kHeatmapMaxCount);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, gHeatmapTarget.color);
+    glBindVertexArray(gFullscreenVAO);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    glBindVertexArray(0);
+    glPolygonMode(GL_FRONT_AND_BACK, isWireframe ? GL_LINE : GL_FILL);
+    glEnable(GL_DEPTH_TEST);
+    shader.use();
+}
+
+// ======================================================
+// Picking (E): which table set is the camera looking at
+// Ray from the eye along the view direction against the BVH; only table set
+// parts count, so glass and floors do not block it.
+// ======================================================
+void pickTableSet(const glm::mat4& view)
+{
+    glm::mat4 inv = glm::inverse(view);
+    glm::vec3 eye = glm::vec3(inv[3]);
+    glm::vec3 forward = -glm::normalize(glm::vec3(inv[2]));
+
+    RayHit hit = gBvh.raycast(eye, forward, 60.0f, [](int e) {
+        return gEntities.group[e] >= 0 && !(gEntities.flags[e] & ENT_HIDDEN);
+    });
 
-    glm::vec4 capColor = glm::vec4(0.92f, 0.93f, 0.91f, 1.0f);
-    drawCube(shader, cubeVAO, glm::vec3(-1.55f, 1.7f, 12.5f), glm::vec3(0.06f, 0.06f, 19.0f), capColor, 0);
-    drawCube(shader, cubeVAO, glm::vec3( 1.55f, 1.7f, 12.5f), glm::vec3(0.06f, 0.06f, 19.0f), capColor, 0);
+    gPickedGroup = hit.prim >= 0 ? gEntities.group[hit.prim] : -1;
+    if (gPickedGroup >= 0) std::cout << "Looking at table set " << gPickedGroup << " (" << hit.t << " m)\n";
+    else std::cout << "No table set in view\n";
+}
+
+// ======================================================
+// Headless Benchmark (--bench <out.csv> [--bench-frames K])
+// Hidden window, vsync off, scripted camera sweep from the walkway.
+// With --generate the layout is rebuilt at 1, 2, 4 ... N frames so one run
+// appends a whole scaling curve to the CSV.
+// ======================================================
+struct BenchOptions {
+    std::string csvPath;
+    int frames = 300;
+    std::string scenePath;
+    int genFrames = 0, genSets = 0;
+    uint32_t seed = 0;
+};
 
-    for (int i = 0; i < 6; ++i) {
-        float z = 3.0f + i * 3.84f;
-        drawCube(shader, cubeVAO, glm::vec3(-1.55f, 1.0f, z), glm::vec3(0.04f, 0.6f, 0.04f), capColor, 0);
-        drawCube(shader, cubeVAO, glm::vec3( 1.55f, 1.0f, z), glm::vec3(0.04f, 0.6f, 0.04f), capColor, 0);
+bool runBenchmark(GLFWwindow* window, Shader& shader, Sphere& sphere, Cylinder& cylinder, unsigned int cubeVAO, const BenchOptions& opt)
+{
+    // --table-model: measure the scene the viewer would show, so the import
+    // has to land before the first frame (the viewer polls it per frame)
+    if (gTableModelJob.valid()) {
+        gTableModelJob.wait();
+        pollModelImports();
+        if (!gTableModelReady) {
+            std::cout << "ERROR::BENCH::TABLE_MODEL: import failed, nothing measured" << std::endl;
+            return false;
+        }
     }
 
+    std::ofstream csv(opt.csvPath, std::ios::app);
+    if (!csv) {
+        std::cout << "ERROR::BENCH::CANNOT_WRITE: " << opt.csvPath << std::endl;
+        return false;
+    }
+    csv.seekp(0, std::ios::end);
+    if (csv.tellp() == 0)
+        csv << "scene,frames,sets_per_frame,seed,table_sets,entities,avg_visible,avg_culled,avg_draw_calls,avg_triangles,"
+               "cpu_frame_ms,cpu_cull_ms,cpu_submit_ms,gpu_ms,cpu_scene_kb,gpu_mesh_kb,avg_occluded,cpu_occlusion_ms,"
+               "avg_gpu_skipped_sets,avg_gpu_skipped_tris,avg_hlod_proxies,impostor_bake_ms,avg_impostors,cpu_impostor_ms,"
+               "depth_order,avg_overdraw,heatmap_avg,heatmap_max,depth_prepass,oit,transparent_scale,"
+               "avg_water_nodes,ocean_res,cpu_ocean_ms,reflection,reflection_draws,reflection_tris,cpu_reflection_ms,gpu_reflection_ms,"
+               "lights,lights_per_cluster,cpu_cluster_ms,lightmap,lightmap_bake_ms,lightmap_kb\n";
+
+    std::vector<int> steps;
+    if (opt.genFrames > 0) {
+        for (int n = 1; n < opt.genFrames; n *= 2) steps.push_back(n);
+        steps.push_back(opt.genFrames);
+    }
+    else steps.push_back(0);
+
+    GpuTimer gpuTimer;
+    gpuTimer.init();
+    glfwSwapInterval(0);
+
+    int width, height;
+    glfwGetFramebufferSize(window, &width, &height);
+    if (height == 0) height = 1;
+    glm::mat4 projection = glm::perspective(glm::radians(45.0f), (float)width / (float)height, 0.1f, 100.0f);
+    int warmup = std::min(10, opt.frames / 10);
+
+    for (int n : steps) {
+        resetScene();
+        CafeLayoutInfo info;
+        bool loaded = n > 0 ? loadGeneratedScene(n, opt.genSets, opt.seed, &info) : loadScene(opt.scenePath);
+        if (!loaded) continue;
+        if (gImpostorsOn) bakeImpostors(shader, sphere, cylinder, cubeVAO);
+        glViewport(0, 0, width, height);
+
+        int tableSets = 0;
+        for (int e = 0; e < gEntities.size(); ++e)
+            if (gEntities.mesh[e] == MESH_TABLE_MODEL) ++tableSets;
+
+        double frameMs = 0, cullMs = 0, submitMs = 0, gpuMs = 0, visible = 0, culled = 0, draws = 0, tris = 0;
+        double occluded = 0, occlusionMs = 0, skippedSets = 0, skippedTris = 0, hlodProxies = 0;
+        double impostors = 0, impostorMs = 0, overdraw = 0, heatmapAvg = 0, heatmapMax = 0, waterNodes = 0, oceanMs = 0;
+        double reflDraws = 0, reflTris = 0, reflCpuMs = 0, reflGpuMs = 0;
+        double lightsPerCluster = 0, clusterMs = 0;
+        int measured = 0;
+
+        for (int f = 0; f < opt.frames; ++f) {
+            auto start = std::chrono::high_resolution_clock::now();
+
+            // Look left and right across the cafe from the walkway
+            float a = glm::radians(60.0f) * sin(6.2831853f * (float)f / (float)opt.frames);
+            glm::vec3 eye = glm::vec3(0.0f, 2.0f, 10.0f);
+            glm::mat4 view = glm::lookAt(eye, eye + glm::vec3(sin(a), -0.1f, -cos(a)), glm::vec3(0, 1, 0));
+
+            glClearColor(0.55f, 0.75f, 0.95f, 1.0f);
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+            shader.use();
+            shader.setMat4("projection", projection);
+            shader.setMat4("view", view);
+
+            gStats.reset();
+            gpuTimer.begin();
+            if (gHeatmapOn) drawOverdrawHeatmap(shader, sphere, cylinder, cubeVAO, (float)f / 60.0f, projection * view, eye);
+            else drawRiversideScene(shader, sphere, cylinder, cubeVAO, (float)f / 60.0f, projection * view, eye);
+            gpuTimer.end();
+
+            glfwSwapBuffers(window);
+            glfwPollEvents();
+
+            double ms = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+            if (f < warmup) continue;
+
+            frameMs += ms;
+            cullMs += gStats.cpuUpdateMs;
+            submitMs += gStats.cpuSubmitMs;
+            gpuMs += gpuTimer.lastMs();
+            visible += gStats.visible;
+            culled += gStats.culled;
+            occluded += gStats.occluded;
+            occlusionMs += gStats.cpuOcclusionMs;
+            skippedSets += gStats.gpuSkippedSets;
+            skippedTris += (double)gStats.gpuSkippedTriangles;
+            hlodProxies += gStats.hlodProxies;
+            impostors += gStats.impostors;
+            impostorMs += gStats.cpuImpostorMs;
+            waterNodes += gStats.waterNodes;
+            oceanMs += gStats.cpuOceanMs;
+            reflDraws += gStats.reflectionDrawCalls;
+            reflTris += (double)gStats.reflectionTriangles;
+            reflCpuMs += gStats.cpuReflectionMs;
+            reflGpuMs += gStats.gpuReflectionMs;
+            lightsPerCluster += gStats.lightsPerCluster;
+            clusterMs += gStats.cpuClusterMs;
+            overdraw += gStats.overdraw;
+            heatmapAvg += gStats.heatmapAvg;
+            heatmapMax = std::max(heatmapMax, gStats.heatmapMax);
+            draws += gStats.drawCalls;
+            tris += (double)gStats.triangles;
+            ++measured;
+        }
+        if (measured == 0) continue;
+
+        double inv = 1.0 / measured;
+        size_t cpuKb = (gEntities.memoryBytes() + gScene.memoryBytes() + gBvh.memoryBytes()) / 1024;
+        size_t gpuKb = (gStaticBatchPool.memoryBytes() + gModelPool.memoryBytes()) / 1024;
+
+        std::ostringstream row;
+        row << (n > 0 ? "generated" : opt.scenePath) << "," << n << "," << opt.genSets << "," << opt.seed << ","
+            << tableSets << "," << gEntities.size() << "," << visible * inv << "," << culled * inv << ","
+            << draws * inv << "," << tris * inv << "," << frameMs * inv << "," << cullMs * inv << ","
+            << submitMs * inv << "," << gpuMs * inv << "," << cpuKb << "," << gpuKb << ","
+            << occluded * inv << "," << occlusionMs * inv << "," << skippedSets * inv << "," << skippedTris * inv << "," << hlodProxies * inv << ","
+            << (gImpostors.baked ? gImpostors.bakeMs : 0.0) << "," << impostors * inv << "," << impostorMs * inv << ","
+            << gDepthOrderOn << "," << overdraw * inv << "," << heatmapAvg * inv << "," << heatmapMax << ","
+            << (gDepthPrepassOn && !gGpuOcclusionOn) << "," << gOitOn << "," << (gOitOn ? 1 : gTransparentScale) << ","
+            << waterNodes * inv << "," << (gOceanOn ? gOcean.resolution : 0) << "," << oceanMs * inv << ","
+            << (gReflectionOn && !gHeatmapOn) << "," << reflDraws * inv << "," << reflTris * inv << "," << reflCpuMs * inv << "," << reflGpuMs * inv << ","
+            << gStats.lights << "," << lightsPerCluster * inv << "," << clusterMs * inv << ","
+            << gLightmap.baked << "," << (gLightmap.baked ? gLightmap.bakeMs : 0.0) << "," << gLightmap.gpuBytes / 1024 << "\n";
+        csv << row.str();
+        csv.flush();
+        std::cout << row.str();
+    }
+
+    gpuTimer.release();
+    return true;
 }
 
 // ======================================================
 // MAIN
 // ======================================================
-int main()
+int main(int argc, char** argv)
 {
+    // ------------------------------
+    // Command line
+    //   --bake-meshes <dir> : write built-in primitives as .cbm files and exit
+    //   --simplify <in> <dir> : LOD chains for a scene's static batches or a model, as .cbm files, and exit
+    //   --meshes <dir>      : upload built-in primitives from baked .cbm files
+    //   --table-model <f>   : draw every table set as an imported OBJ / glTF model, also for --bench
+    //   --scene <file>      : scene to load, text or compiled (default cafe.scene)
+    //   --compile-scene <in> <out> : compile a text scene to binary and exit
+    //   --generate <frames> <sets> <seed> : procedural layout instead of --scene
+    //   --bench <out.csv>   : headless benchmark, appends results and exits
+    //   --bench-frames <n>  : frames measured per benchmark run (default 300)
+    //   --impostors         : start with impostors on (I), also for --bench
+    //   --one-pass          : start with depth-ordered passes off (Y), also for --bench
+    //   --heatmap           : start in the overdraw heatmap (H), also for --bench
+    //   --stats             : start with the 2 s stats report on (X)
+    //   --depth-prepass     : start with the depth pre-pass on (Z), also for --bench
+    //   --oit               : start with order-independent transparency on (O), also for --bench
+    //   --transparent-res <n> : glass at 1/n resolution, n = 1, 2 or 4 (T), also for --bench
+    //   --ocean <n>         : start with the FFT water on (N) at n x n, n = 64..512, also for --bench
+    //   --no-reflection     : start with the water reflection off (Q), also for --bench
+    //   --no-lights         : start with the bulb lights off (4), also for --bench
+    //   --lightmap          : start with the baked lightmap on (K), also for --bench
+    // ------------------------------
+    std::string bakeDir, meshDir, tableModelPath, scenePath = "cafe.scene", compileIn, compileOut, simplifyIn, simplifyOut;
+    BenchOptions bench;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--bake-meshes" && i + 1 < argc) bakeDir = argv[++i];
+        else if (arg == "--scene" && i + 1 < argc) scenePath = argv[++i];
+        else if (arg == "--compile-scene" && i + 2 < argc) { compileIn = argv[++i]; compileOut = argv[++i]; }
+        else if (arg == "--simplify" && i + 2 < argc) { simplifyIn = argv[++i]; simplifyOut = argv[++i]; }
+        else if (arg == "--generate" && i + 3 < argc) {
+            bench.genFrames = atoi(argv[++i]);
+            bench.genSets = atoi(argv[++i]);
+            bench.seed = (uint32_t)strtoul(argv[++i], nullptr, 10);
+        }
+        else if (arg == "--bench" && i + 1 < argc) bench.csvPath = argv[++i];
+        else if (arg == "--bench-frames" && i + 1 < argc) bench.frames = std::max(1, atoi(argv[++i]));
+        else if (arg == "--meshes" && i + 1 < argc) meshDir = argv[++i];
+        else if (arg == "--table-model" && i + 1 < argc) tableModelPath = argv[++i];
+        else if (arg == "--impostors") gImpostorsOn = true;
+        else if (arg == "--one-pass") gDepthOrderOn = false;
+        else if (arg == "--heatmap") gHeatmapOn = true;
+        else if (arg == "--stats") gStatsReportOn = true;
+        else if (arg == "--depth-prepass") gDepthPrepassOn = true;
+        else if (arg == "--oit") gOitOn = true;
+        else if (arg == "--transparent-res" && i + 1 < argc) {
+            int n = atoi(argv[++i]);
+            gTransparentScale = n >= 4 ? 4 : n >= 2 ? 2 : 1;
+        }
+        else if (arg == "--no-reflection") gReflectionOn = false;
+        else if (arg == "--no-lights") emissiveOn = false;
+        else if (arg == "--lightmap") gLightmapOn = true;
+        else if (arg == "--ocean" && i + 1 < argc) {
+            gOceanOn = true;
+            gOceanResolution = Ocean::clampResolution(atoi(argv[++i]));
+        }
+        else std::cout << "Unknown option: " << arg << "\n";
+    }
+
+    if (!bakeDir.empty())
+        return bakeBuiltinMeshes(bakeDir) ? 0 : 1;
+    if (!compileIn.empty())
+        return compileScene(compileIn, compileOut) ? 0 : 1;
+    if (!simplifyIn.empty())
+        return simplifyToLods(simplifyIn, simplifyOut) ? 0 : 1;
+
+    // Start parsing right away so it overlaps window / GL setup
+    if (!tableModelPath.empty())
+        gTableModelJob = importModelAsync(tableModelPath);
+
     glfwInit();
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    if (!bench.csvPath.empty())
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
 
     GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "Cafe Beel Harina - 3D Riverside", NULL, NULL);
     if (!window) {
@@ -609,6 +1889,43 @@ int main()
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
     Shader ourShader("vertex_shader.vs", "fragment_shader.fs");
+    Shader impostorShader("impostor.vs", "impostor.fs");
+    gImpostorShader = &impostorShader;
+    gImpostors.initGL();
+    gOverdraw.init();
+    Shader heatmapShader("fullscreen.vs", "overdraw.fs");
+    gHeatmapShader = &heatmapShader;
+    Shader depthShader("depth.vs", "depth.fs");
+    gDepthShader = &depthShader;
+    Shader oitShader("fullscreen.vs", "oit.fs");
+    gOitShader = &oitShader;
+    Shader depthDownShader("fullscreen.vs", "depthdown.fs");
+    gDepthDownShader = &depthDownShader;
+    Shader upsampleShader("fullscreen.vs", "upsample.fs");
+    gUpsampleShader = &upsampleShader;
+    Shader waterShader("water.vs", "fragment_shader.fs");
+    gWaterShader = &waterShader;
+    gWater.initGL();
+    gReflectionTimer.init();
+    gLights.initGL();
+    for (Shader* s : { &ourShader, &waterShader }) {
+        s->use();
+        ClusteredLights::useUnits(*s, kClusterUnit);
+    }
+    glGenVertexArrays(1, &gFullscreenVAO);
+
+    // Built-in primitive data: constexpr tables, or a mapped .cbm file (--meshes <dir>).
+    // Baked blobs are uploaded straight from the mapping.
+    MeshFileView cubeFile, sphereFile, planterFile, coneFile;
+    bool useBaked = false;
+    if (!meshDir.empty()) {
+        useBaked = cubeFile.open(meshDir + "/cube.cbm") && sphereFile.open(meshDir + "/sphere.cbm")
+            && planterFile.open(meshDir + "/planter.cbm") && coneFile.open(meshDir + "/cone.cbm")
+            && cubeFile.hasStandardLayout() && sphereFile.hasStandardLayout()
+            && planterFile.hasStandardLayout() && coneFile.hasStandardLayout()
+            && cubeFile.lod(0).vertexCount == 36;
+        if (!useBaked) std::cout << "Baked meshes unavailable in " << meshDir << ", using built-in tables\n";
+    }
 
     // Cube VAO/VBO
     unsigned int VBO, cubeVAO;
@@ -617,20 +1934,42 @@ int main()
 
     glBindVertexArray(cubeVAO);
     glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(cubeVertices), cubeVertices, GL_STATIC_DRAW);
+    if (useBaked) glBufferData(GL_ARRAY_BUFFER, 36 * kVertexStrideBytes, cubeFile.lodVertices(0), GL_STATIC_DRAW);
+    else glBufferData(GL_ARRAY_BUFFER, sizeof(cubeVertices), cubeVertices, GL_STATIC_DRAW);
 
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, kVertexStrideBytes, (void*)0);
     glEnableVertexAttribArray(0);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, kVertexStrideBytes, (void*)(3 * sizeof(float)));
     glEnableVertexAttribArray(1);
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
+    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, kVertexStrideBytes, (void*)(6 * sizeof(float)));
     glEnableVertexAttribArray(2);
 
-    Sphere sphere(1.0f, 32, 16);
-    Cylinder planter(1.0f, 1.0f, 1.0f, 16, 1);
-
-    // Build cone
-    gCone.build(40);
+    // Curvy primitives: no mesh math at startup, only the GL upload (LOD 0 of baked files)
+    Sphere sphere = useBaked
+        ? Sphere(sphereFile.lodVertices(0), sphereFile.lod(0).vertexCount, sphereFile.lodIndices(0), sphereFile.lod(0).indexCount)
+        : Sphere(SphereMesh::vertices.data(), SphereMesh::kVertexCount, SphereMesh::indices.data(), SphereMesh::kIndexCount);
+    Cylinder planter = useBaked
+        ? Cylinder(planterFile.lodVertices(0), planterFile.lod(0).vertexCount, planterFile.lodIndices(0), planterFile.lod(0).indexCount)
+        : Cylinder(PlanterMesh::vertices.data(), PlanterMesh::kVertexCount, PlanterMesh::indices.data(), PlanterMesh::kIndexCount);
+
+    // Upload cone
+    if (useBaked) gCone.upload(coneFile.lodVertices(0), coneFile.lod(0).vertexCount);
+    else gCone.upload(ConeMesh::vertices.data(), ConeMesh::kVertexCount);
+
+    // Position-only copies for the depth pre-pass (Z)
+    gCubeDepth.create(VBO, 0, 36);
+    gSphereDepth.create(sphere.vbo, sphere.ebo, sphere.indexCount);
+    gCylinderDepth.create(planter.vbo, planter.ebo, planter.indexCount);
+    gConeDepth.create(gCone.VBO, 0, gCone.vertexCount);
+
+    // GL owns copies now, the mappings can go
+    cubeFile.close();
+    sphereFile.close();
+    planterFile.close();
+    coneFile.close();
+
+    if (gTableModelJob.valid())
+        gModelPool.init();
 
     // TEXTURES:
     // User conceptual mapping:
@@ -650,6 +1989,40 @@ int main()
     //       canopyTexture is used for glass/railings.
     //       waterTexture (emoji) is used for water and table items (mugs, buns, sphere, cone).
 
+    if (!bench.csvPath.empty()) {
+        bench.scenePath = scenePath;
+        bool measured = runBenchmark(window, ourShader, sphere, planter, cubeVAO, bench);
+        glDeleteVertexArrays(1, &cubeVAO);
+        glDeleteBuffers(1, &VBO);
+        gModelPool.release();
+        gStaticBatchPool.release();
+        gImpostors.release();
+        gOverdraw.release();
+        gHeatmapTarget.release();
+        glDeleteVertexArrays(1, &gFullscreenVAO);
+        gOit.release();
+        gLowRes.release();
+        gWater.release();
+        gOcean.release();
+        gReflectionTarget.release();
+        gReflectionTimer.release();
+        gLights.release();
+        gLightmap.release();
+        for (PositionStream* p : { &gCubeDepth, &gSphereDepth, &gCylinderDepth, &gConeDepth }) p->release();
+        glfwTerminate();
+        return measured ? 0 : 1;
+    }
+
+    // The loaders have printed why; an empty cafe is not worth opening
+    CafeLayoutInfo layout;
+    if (bench.genFrames > 0 ? !loadGeneratedScene(bench.genFrames, bench.genSets, bench.seed, &layout) : !loadScene(scenePath)) {
+        std::cout << "Failed to load the scene\n";
+        glfwTerminate();
+        return -1;
+    }
+    if (bench.genFrames > 0)
+        std::cout << "Generated " << layout.frames << " frames, " << layout.tableSets << " table sets\n";
+
     while (!glfwWindowShouldClose(window))
     {
         float currentFrame = (float)glfwGetTime();
@@ -657,6 +2030,7 @@ int main()
         lastFrame = currentFrame;
 
         processInput(window);
+        pollModelImports();
 
         glClearColor(0.55f, 0.75f, 0.95f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
@@ -668,6 +2042,11 @@ int main()
         glfwGetFramebufferSize(window, &width, &height);
         if (height == 0) height = 1;
 
+        if (gImpostorsOn && gImpostorsDirty) {
+            bakeImpostors(ourShader, sphere, planter, cubeVAO);
+            glViewport(0, 0, width, height);
+        }
+
         float aspect = (float)width / (float)height;
         glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom), aspect, 0.1f, 100.0f);
 
@@ -691,7 +2070,59 @@ int main()
         ourShader.setMat4("projection", projection);
         ourShader.setMat4("view", view);
 
-        drawRiversideScene(ourShader, sphere, planter, cubeVAO, (float)glfwGetTime());
+        if (gPickRequested) {
+            pickTableSet(view);
+            gPickRequested = false;
+        }
+
+        gStats.reset();
+        if (gHeatmapOn)
+            drawOverdrawHeatmap(ourShader, sphere, planter, cubeVAO, (float)glfwGetTime(), projection * view,
+                glm::vec3(glm::inverse(view)[3]));
+        else
+            drawRiversideScene(ourShader, sphere, planter, cubeVAO, (float)glfwGetTime(), projection * view,
+                glm::vec3(glm::inverse(view)[3]));
+
+        // Skipped sets arrive with the query results, so report a running sum
+        static int skippedSets = 0, overdrawFrames = 0, heatmapFrames = 0;
+        static int64_t skippedTris = 0;
+        static double overdraw = 0.0, heatmapAvg = 0.0, heatmapMax = 0.0;
+        static float nextReport = 0.0f;
+        skippedSets += gStats.gpuSkippedSets;
+        skippedTris += gStats.gpuSkippedTriangles;
+        if (gStats.overdraw > 0.0) {
+            overdraw += gStats.overdraw;
+            ++overdrawFrames;
+        }
+        if (gHeatmapOn) {
+            heatmapAvg += gStats.heatmapAvg;
+            heatmapMax = std::max(heatmapMax, gStats.heatmapMax);
+            ++heatmapFrames;
+        }
+        if (currentFrame >= nextReport) {
+            if (gStatsReportOn) {
+                if (gGpuOcclusionOn)
+                    std::cout << "GPU occlusion: skipped " << skippedSets << " table sets / " << skippedTris << " triangles in the last 2 s\n";
+                else if (overdrawFrames > 0)
+                    std::cout << "Overdraw: " << overdraw / overdrawFrames << " fragments shaded per pixel ("
+                              << (gDepthOrderOn ? "depth order" : "one blended pass")
+                              << (gTransparentScale > 1 && !gOitOn ? ", glass at 1/" + std::to_string(gTransparentScale) : std::string()) << ")\n";
+                if (gReflectionOn && !gHeatmapOn)
+                    std::cout << "Reflection: " << gStats.reflectionDrawCalls << " draws, " << gStats.reflectionTriangles << " triangles, "
+                              << gStats.cpuReflectionMs << " ms CPU, " << gStats.gpuReflectionMs << " ms GPU\n";
+                if (gStats.lights > 0)
+                    std::cout << "Bulb lights: " << gStats.lights << " in " << ClusteredLights::kClusters << " clusters, "
+                              << gStats.lightsPerCluster << " per cluster on average, " << gStats.cpuClusterMs << " ms assignment (CPU)\n";
+                if (gOceanOn)
+                    std::cout << "FFT water " << gOcean.resolution << "^2: " << gStats.cpuOceanMs << " ms simulation (CPU)\n";
+                if (heatmapFrames > 0)
+                    std::cout << "Overdraw heatmap: average " << heatmapAvg / heatmapFrames << ", max " << heatmapMax << " per pixel\n";
+            }
+            skippedSets = overdrawFrames = heatmapFrames = 0;
+            skippedTris = 0;
+            overdraw = heatmapAvg = heatmapMax = 0.0;
+            nextReport = currentFrame + 2.0f;
+        }
 
         glfwSwapBuffers(window);
         glfwPollEvents();
@@ -699,6 +2130,21 @@ int main()
 
     glDeleteVertexArrays(1, &cubeVAO);
     glDeleteBuffers(1, &VBO);
+    gModelPool.release();
+    gStaticBatchPool.release();
+    gImpostors.release();
+    gOverdraw.release();
+    gHeatmapTarget.release();
+    glDeleteVertexArrays(1, &gFullscreenVAO);
+    gOit.release();
+    gLowRes.release();
+    gWater.release();
+    gOcean.release();
+    gReflectionTarget.release();
+    gReflectionTimer.release();
+    gLights.release();
+    gLightmap.release();
+    for (PositionStream* p : { &gCubeDepth, &gSphereDepth, &gCylinderDepth, &gConeDepth }) p->release();
     glfwTerminate();
     return 0;
 }
@@ -722,9 +2168,90 @@ void processInput(GLFWwindow* window)
         else if (glfwGetKey(window, key) == GLFW_RELEASE) keys[key] = false;
     };
 
+    bool bulbsOn = emissiveOn;
     toggle(GLFW_KEY_4, emissiveOn);
+    if (bulbsOn != emissiveOn) std::cout << (emissiveOn ? "Bulb lights ON\n" : "Bulb lights OFF\n");
+
+    bool lightmapOn = gLightmapOn;
+    toggle(GLFW_KEY_K, gLightmapOn);
+    if (lightmapOn != gLightmapOn) std::cout << (gLightmapOn ? "Lightmap ON\n" : "Lightmap OFF\n");
     toggle(GLFW_KEY_P, isWireframe);
 
+    bool useBvh = gUseBvh;
+    toggle(GLFW_KEY_B, gUseBvh);
+    if (useBvh != gUseBvh) {
+        gBvhRebuild = true;     // resets every ENT_VISIBLE flag before the BVH path takes over
+        std::cout << (gUseBvh ? "Culling: BVH\n" : "Culling: linear\n");
+    }
+
+    bool occlusionOn = gOcclusionOn;
+    toggle(GLFW_KEY_U, gOcclusionOn);
+    if (occlusionOn != gOcclusionOn) std::cout << (gOcclusionOn ? "Occlusion culling ON\n" : "Occlusion culling OFF\n");
+
+    bool portalsOn = gPortalsOn;
+    toggle(GLFW_KEY_V, gPortalsOn);
+    if (portalsOn != gPortalsOn) std::cout << (gPortalsOn ? "Portal visibility ON\n" : "Portal visibility OFF\n");
+
+    bool hlodOn = gHlodOn;
+    toggle(GLFW_KEY_L, gHlodOn);
+    if (hlodOn != gHlodOn) std::cout << (gHlodOn ? "HLOD proxies ON\n" : "HLOD proxies OFF\n");
+
+    bool impostorsOn = gImpostorsOn;
+    toggle(GLFW_KEY_I, gImpostorsOn);
+    if (impostorsOn != gImpostorsOn) std::cout << (gImpostorsOn ? "Impostors ON (instead of HLOD)\n" : "Impostors OFF\n");
+
+    bool gpuOcclusionOn = gGpuOcclusionOn;
+    toggle(GLFW_KEY_G, gGpuOcclusionOn);
+    if (gpuOcclusionOn != gGpuOcclusionOn) std::cout << (gGpuOcclusionOn ? "GPU occlusion queries ON\n" : "GPU occlusion queries OFF\n");
+
+    bool depthOrderOn = gDepthOrderOn;
+    toggle(GLFW_KEY_Y, gDepthOrderOn);
+    if (depthOrderOn != gDepthOrderOn)
+        std::cout << (gDepthOrderOn ? "Draw order: opaque front to back, glass back to front\n" : "Draw order: one blended pass\n");
+
+    bool heatmapOn = gHeatmapOn;
+    toggle(GLFW_KEY_H, gHeatmapOn);
+    if (heatmapOn != gHeatmapOn) std::cout << (gHeatmapOn ? "Overdraw heatmap ON\n" : "Overdraw heatmap OFF\n");
+
+    bool statsReportOn = gStatsReportOn;
+    toggle(GLFW_KEY_X, gStatsReportOn);
+    if (statsReportOn != gStatsReportOn) std::cout << (gStatsReportOn ? "Stats report ON (every 2 s)\n" : "Stats report OFF\n");
+
+    bool depthPrepassOn = gDepthPrepassOn;
+    toggle(GLFW_KEY_Z, gDepthPrepassOn);
+    if (depthPrepassOn != gDepthPrepassOn) std::cout << (gDepthPrepassOn ? "Depth pre-pass ON\n" : "Depth pre-pass OFF\n");
+
+    bool oitOn = gOitOn;
+    toggle(GLFW_KEY_O, gOitOn);
+    if (oitOn != gOitOn) std::cout << (gOitOn ? "Order-independent transparency ON\n" : "Order-independent transparency OFF\n");
+
+    // transparent resolution (T): full, half, quarter
+    if (glfwGetKey(window, GLFW_KEY_T) == GLFW_PRESS && !keys[GLFW_KEY_T]) {
+        gTransparentScale = gTransparentScale >= 4 ? 1 : gTransparentScale * 2;
+        std::cout << "Transparent pass at 1/" << gTransparentScale << " resolution" << (gOitOn ? " (not with OIT)\n" : "\n");
+        keys[GLFW_KEY_T] = true;
+    }
+    else if (glfwGetKey(window, GLFW_KEY_T) == GLFW_RELEASE) keys[GLFW_KEY_T] = false;
+
+    bool oceanOn = gOceanOn;
+    toggle(GLFW_KEY_N, gOceanOn);
+    if (oceanOn != gOceanOn)
+        std::cout << (gOceanOn ? "FFT water ON (" + std::to_string(gOceanResolution) + "^2)\n" : std::string("FFT water OFF\n"));
+
+    bool reflectionOn = gReflectionOn;
+    toggle(GLFW_KEY_Q, gReflectionOn);
+    if (reflectionOn != gReflectionOn) std::cout << (gReflectionOn ? "Water reflection ON\n" : "Water reflection OFF\n");
+
+    // pick (E): resolved in the render loop, once the view matrix is known
+    if (glfwGetKey(window, GLFW_KEY_E) == GLFW_PRESS && !keys[GLFW_KEY_E]) {
+        gPickRequested = true;
+        keys[GLFW_KEY_E] = true;
+    }
+    else if (glfwGetKey(window, GLFW_KEY_E) == GLFW_RELEASE) keys[GLFW_KEY_E] = false;
+
+    // impostors capture the current texture look
+    TexFeatureMode texMode = gTexMode;
+
     // ---------------------------
     // ASSIGNMENT: Texture toggles
     // 0: texture OFF (baseColor only)
@@ -759,6 +2286,7 @@ void processInput(GLFWwindow* window)
         std::cout << "TEX_BLEND_FRAGMENT (computed on fragment)\n";
     }
     else if (glfwGetKey(window, GLFW_KEY_3) == GLFW_RELEASE) keys[GLFW_KEY_3] = false;
+    if (texMode != gTexMode) gImpostorsDirty = true;
 
     // Fullscreen Toggle (F)
     static bool isFullscreen = false;
@@ -0,0 +1,18 @@
+#version 330 core
+out vec4 FragColor;
+
+// Weighted blended OIT resolve (see Oit.h), blended with
+// (ONE_MINUS_SRC_ALPHA, SRC_ALPHA): alpha carries the revealage
+uniform sampler2D uAccum;       // rgb: sum of colour * alpha * weight, a: product of (1 - alpha)
+uniform sampler2D uWeight;      // r: sum of alpha * weight
+
+void main()
+{
+    ivec2 p = ivec2(gl_FragCoord.xy);
+    vec4 accum = texelFetch(uAccum, p, 0);
+    float revealage = accum.a;
+    if (revealage >= 1.0) discard;  // no glass here
+
+    float weight = texelFetch(uWeight, p, 0).r;
+    FragColor = vec4(accum.rgb / max(weight, 1e-5), revealage);
+}
@@ -0,0 +1,21 @@
+#version 330 core
+out vec4 FragColor;
+
+uniform sampler2D uCounts;      // fragments per pixel, same size as the window
+uniform float uMaxCount;        // shown as white
+
+// black (0) -> blue -> cyan -> green -> yellow -> red -> white (uMaxCount)
+vec3 ramp(float t)
+{
+    const vec3 stops[7] = vec3[7](vec3(0.0), vec3(0.0, 0.1, 0.9), vec3(0.0, 0.8, 0.9), vec3(0.1, 0.85, 0.1),
+                                  vec3(1.0, 0.9, 0.0), vec3(1.0, 0.1, 0.0), vec3(1.0));
+    float x = clamp(t, 0.0, 1.0) * 6.0;
+    int i = min(int(x), 5);
+    return mix(stops[i], stops[i + 1], x - float(i));
+}
+
+void main()
+{
+    float n = texelFetch(uCounts, ivec2(gl_FragCoord.xy), 0).r;
+    FragColor = vec4(ramp(n / uMaxCount), 1.0);
+}
@@ -0,0 +1,49 @@
+#version 330 core
+out vec4 FragColor;
+
+// Depth-aware upsample of the low-res transparent pass (LowResTransparency.h),
+// blended with (ONE, SRC_ALPHA): rgb is added, alpha is the transmittance
+uniform sampler2D uColor;       // low res: rgb glass over black, a transmittance
+uniform sampler2D uLowDepth;    // low-res depth the glass was tested against
+uniform sampler2D uFullDepth;   // frame depth
+uniform int uScale;
+uniform vec2 uNearFar;
+
+float linearDepth(float z)
+{
+    return uNearFar.x * uNearFar.y / (uNearFar.y - z * (uNearFar.y - uNearFar.x));
+}
+
+void main()
+{
+    ivec2 last = textureSize(uColor, 0) - 1;
+    float z = linearDepth(texelFetch(uFullDepth, ivec2(gl_FragCoord.xy), 0).r);
+
+    // Bilinear footprint in low-res texels, each tap weighted down by its
+    // relative depth difference to this pixel
+    vec2 lp = gl_FragCoord.xy / float(uScale) - 0.5;
+    ivec2 base = ivec2(floor(lp));
+    vec2 f = lp - vec2(base);
+
+    vec4 sum = vec4(0.0);
+    float weightSum = 0.0;
+    vec4 nearest = vec4(0.0, 0.0, 0.0, 1.0);
+    float nearestDiff = 1e30;
+    for (int j = 0; j < 2; ++j)
+        for (int i = 0; i < 2; ++i) {
+            ivec2 q = clamp(base + ivec2(i, j), ivec2(0), last);
+            float bilinear = (i == 0 ? 1.0 - f.x : f.x) * (j == 0 ? 1.0 - f.y : f.y);
+            float diff = abs(linearDepth(texelFetch(uLowDepth, q, 0).r) - z) / z;
+            vec4 c = texelFetch(uColor, q, 0);
+            float w = bilinear / (1e-3 + diff);
+            sum += c * w;
+            weightSum += w;
+            if (diff < nearestDiff) {
+                nearestDiff = diff;
+                nearest = c;
+            }
+        }
+
+    // No tap on this surface (a thin near object): the closest one in depth
+    FragColor = nearestDiff > 0.1 ? nearest : sum / weightSum;
+}
@@ -6,15 +6,14 @@ layout (location = 2) in vec2 aTexCoord;
 
 out vec2 TexCoord;
 out vec3 FragPos;
+out vec3 Normal;        // world, unnormalized (bulb lights)
+out vec2 LightmapUV;    // x < 0: no lightmap for this draw
 out vec4 VertexColor;   // ✅ REQUIRED (matches fragment shader)
 
 uniform mat4 model;
 uniform mat4 view;
 uniform mat4 projection;
 
-uniform bool isWater;
-uniform float time;
-
 // ✅ texture assignment controls
 uniform vec4 baseColor;
 uniform bool uUseTexture;
@@ -22,21 +21,34 @@ uniform bool uBlendWithColor;
 uniform int  uComputeMode;    // 0 = vertex compute, 1 = fragment compute
 uniform sampler2D uTex0;
 
+// lightmap (Lightmap.h): per face of the cube, first texel centre + span
+uniform bool uLightmap;
+uniform vec4 uLightmapRects[6];
+
+// must match depth.vs bit for bit (depth pre-pass, GL_EQUAL)
+invariant gl_Position;
+
 void main()
 {
-    vec3 pos = aPos;
+    vec4 worldPos = model * vec4(aPos, 1.0);
+    FragPos = worldPos.xyz;
+    TexCoord = aTexCoord;
 
-    // Water displacement
-    if (isWater)
+    // Cofactor of the model matrix: the inverse transpose up to a scale
+    mat3 m = mat3(model);
+    Normal = mat3(cross(m[1], m[2]), cross(m[2], m[0]), cross(m[0], m[1])) * aNormal;
+
+    // Box unwrap of the cube: face from the normal, position across it
+    LightmapUV = vec2(-1.0);
+    if (uLightmap && uLightmapRects[0].z > 0.0)
     {
-        pos.y += 0.05 * sin(2.0 * pos.x + 2.0 * time)
-              + 0.05 * sin(2.0 * pos.z + 1.5 * time);
+        vec3 an = abs(aNormal);
+        int axis = (an.x > an.y && an.x > an.z) ? 0 : (an.y > an.z ? 1 : 2);
+        vec2 uv = axis == 0 ? aPos.yz : (axis == 1 ? aPos.xz : aPos.xy);
+        vec4 rect = uLightmapRects[axis * 2 + (aNormal[axis] < 0.0 ? 1 : 0)];
+        LightmapUV = rect.xy + (uv + 0.5) * rect.zw;
     }
 
-    vec4 worldPos = model * vec4(pos, 1.0);
-    FragPos = worldPos.xyz;
-    TexCoord = aTexCoord;
-
     // Default
     VertexColor = baseColor;
 
@@ -0,0 +1,73 @@
+#version 330 core
+
+// CDLOD water patch (see WaterGrid.h), shaded by fragment_shader.fs
+layout (location = 0) in vec2 aGrid;            // 0..kPatchQuads
+layout (location = 1) in vec4 iNode;            // x, z of the corner, size, level
+
+out vec2 TexCoord;
+out vec3 FragPos;
+out vec3 Normal;        // not used for water
+out vec2 LightmapUV;
+out vec4 VertexColor;
+
+uniform mat4 view;
+uniform mat4 projection;
+uniform vec3 uEye;
+uniform float uHeight;
+uniform float uGridSize;        // quads per patch side
+uniform vec2 uMorph[8];         // per level: start, end distance
+uniform float time;
+uniform vec4 baseColor;
+
+// FFT water (Ocean.h): r = height, gba = normal, one period per uOceanTile metres
+uniform bool uOcean;
+uniform sampler2D uOceanMap;
+uniform float uOceanTile;
+uniform float uOceanTexel;      // metres per texel
+
+// Gerstner waves (Waves.h, same sums as WaveSet::sample)
+uniform int uWaveCount;
+uniform vec4 uWaveA[8];         // dir.xz, amplitude, steepness
+uniform vec4 uWaveB[8];         // k, w, phase, wavelength
+uniform vec2 uWaveFade;         // fade-out distance in wavelengths
+
+vec3 gerstner(vec2 p0)
+{
+    float dist = distance(p0, uEye.xz);
+    vec3 p = vec3(p0.x, 0.0, p0.y);
+    for (int i = 0; i < uWaveCount; ++i) {
+        float a = uWaveA[i].z * (1.0 - smoothstep(uWaveB[i].w * uWaveFade.x, uWaveB[i].w * uWaveFade.y, dist));
+        float theta = uWaveB[i].x * dot(uWaveA[i].xy, p0) + (uWaveB[i].y * time + uWaveB[i].z);
+        p.xz += uWaveA[i].w * a * cos(theta) * uWaveA[i].xy;
+        p.y += a * sin(theta);
+    }
+    return p;
+}
+
+void main()
+{
+    float cell = iNode.z / uGridSize;
+    vec2 xz = iNode.xy + aGrid * cell;
+
+    // Odd vertices slide onto the next level's grid towards the end of the range
+    vec2 m = uMorph[int(iNode.w)];
+    float k = clamp((distance(vec3(xz.x, uHeight, xz.y), uEye) - m.x) / (m.y - m.x), 0.0, 1.0);
+    xz -= fract(aGrid * 0.5) * 2.0 * cell * k;
+
+    vec3 surface;
+    if (uOcean) {
+        // Mip level from distance, not from the patch, so neighbours sample alike
+        float cellSize = distance(xz, uEye.xz) / 32.0;
+        surface = vec3(xz.x, textureLod(uOceanMap, xz / uOceanTile, log2(max(cellSize / uOceanTexel, 1.0))).r, xz.y);
+    }
+    else {
+        surface = gerstner(xz);
+    }
+
+    FragPos = surface + vec3(0.0, uHeight, 0.0);
+    Normal = vec3(0.0, 1.0, 0.0);
+    LightmapUV = vec2(-1.0);
+    TexCoord = xz;
+    VertexColor = baseColor;
+    gl_Position = projection * view * vec4(FragPos, 1.0);
+}